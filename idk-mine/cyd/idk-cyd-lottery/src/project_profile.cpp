@@ -15,29 +15,50 @@ static const char kDefaultConfigJson[] = R"json(
     "ltc": "ltc1qcl9h4kffh8w8nr77u8la5ykn4cg59ms2lteply"
   },
   "pool": {
-    "btc": {
-      "host": "public-pool.io",
-      "port": 3333,
-      "tls": false
-    },
-    "ltc": {
-      "host": "rx.unmineable.com",
-      "port": 3333,
-      "tls": false
-    }
+    "btc": [
+      {
+        "host": "public-pool.io",
+        "port": 3333,
+        "tls": false
+      },
+      {
+        "host": "public-pool.io",
+        "port": 4333,
+        "tls": true
+      }
+    ],
+    "ltc": [
+      {
+        "host": "rx.unmineable.com",
+        "port": 3333,
+        "tls": false
+      },
+      {
+        "host": "rx.unmineable.com",
+        "port": 13333,
+        "tls": false
+      }
+    ]
   },
   "timing": {
     "telemetry_ms": 1000,
+    "history_ms": 5000,
     "ui_ms": 200,
     "wifi_reconnect_ms": 5000,
     "pool_retry_ms": 4000,
+    "pool_probe_ms": 60000,
     "keepalive_ms": 30000
   },
   "miner": {
     "threads": 2,
     "batch_size": 1024,
+    "autotune": true,
     "lottery_target32": 65535,
     "mine_target32": 4095
+  },
+  "alerts": {
+    "stack_free_bytes": 512,
+    "heap_free_bytes": 16384
   }
 }
 )json";
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "config/runtime_config.h"
+#include "network/stratum_transport.h"
+
+// Fixtures shared by the bench and the native test suites.
+
+namespace idk_test {
+
+// The built-in defaults with both coins pointed at one plain-TCP pool, and
+// the settings host runs want: no autotune, no pool probes, and a connect
+// on the first StratumClient::loop() instead of after a retry interval.
+inline idk::RuntimeConfig makeHostConfig(const char* host = "scripted", uint16_t port = 3333) {
+  idk::RuntimeConfig cfg{};
+  char err[96];
+  idk::loadDefaultsFromJson(nullptr, cfg, err, sizeof(err));
+  strlcpy(cfg.projectName, "idk-native-test", sizeof(cfg.projectName));
+  strlcpy(cfg.minerName, "idk-native", sizeof(cfg.minerName));
+  strlcpy(cfg.workerName, "test", sizeof(cfg.workerName));
+  cfg.enableOTA = false;
+  for (idk::PoolListConfig* pools : {&cfg.btcPools, &cfg.ltcPools}) {
+    strlcpy(pools->endpoints[0].host, host, sizeof(pools->endpoints[0].host));
+    pools->endpoints[0].port = port;
+    pools->endpoints[0].tls = false;
+    pools->count = 1;
+  }
+  cfg.minerAutotune = false;
+  cfg.poolRetryMs = 0;
+  cfg.poolProbeMs = 0;
+  return cfg;
+}
+
+// An in-memory pool: answers mining.subscribe with `extranonce1` (4-byte
+// extranonce2), mining.authorize with true, difficulty 0.001 and then
+// `afterAuthorize`, and anything else with the mock pool's "unsupported"
+// error, or nothing once set silent. Subclasses can keep feeding lines after
+// authorize through moreLines(). Everything the client sends is kept.
+class ScriptedPoolTransport : public idk::StratumTransport {
+ public:
+  ScriptedPoolTransport(const char* extranonce1, const char* afterAuthorize)
+      : extranonce1_(extranonce1), afterAuthorize_(afterAuthorize) {}
+
+  bool connect(const idk::PoolEndpointConfig&, uint32_t) override {
+    connected_ = true;
+    return true;
+  }
+  void close() override { connected_ = false; }
+  bool connected() override { return connected_; }
+
+  int available() override {
+    refill();
+    return static_cast<int>(buffered());
+  }
+
+  int read(uint8_t* buf, size_t len) override {
+    refill();
+    const size_t n = std::min(len, buffered());
+    if (n == 0) {
+      return -1;
+    }
+    memcpy(buf, out_.data() + readPos_, n);
+    readPos_ += n;
+    return static_cast<int>(n);
+  }
+
+  size_t write(const uint8_t* buf, size_t len) override {
+    const std::string line(reinterpret_cast<const char*>(buf), len);
+    sent_.push_back(line);
+    unsigned long id = 0;
+    if (sscanf(line.c_str(), "{\"id\":%lu", &id) != 1) {
+      return len;
+    }
+    const std::string idField = "{\"id\":" + std::to_string(id);
+    if (line.find("mining.subscribe") != std::string::npos) {
+      out_ += idField + ",\"result\":[[[\"mining.set_difficulty\",\"1\"],[\"mining.notify\",\"1\"]],\"" +
+              extranonce1_ + "\",4],\"error\":null}\n";
+    } else if (line.find("mining.authorize") != std::string::npos) {
+      out_ += idField + ",\"result\":true,\"error\":null}\n";
+      out_ += "{\"id\":null,\"method\":\"mining.set_difficulty\",\"params\":[0.001]}\n";
+      out_ += afterAuthorize_;
+      authorized_ = true;
+    } else if (!silent_) {
+      out_ += idField + ",\"result\":null,\"error\":[20,\"unsupported\",null]}\n";
+    }
+    return len;
+  }
+
+  bool linkUp() override { return true; }
+  bool probe(const idk::PoolEndpointConfig&, uint32_t, uint32_t& connectMs) override {
+    connectMs = 1;
+    return true;
+  }
+
+  const std::vector<std::string>& sent() const { return sent_; }
+  void setSilent(bool silent) { silent_ = silent; }
+  size_t buffered() const { return out_.size() - readPos_; }
+
+ protected:
+  // Appends the next pool line to `line`; false when there is none.
+  virtual bool moreLines(std::string& line) {
+    (void)line;
+    return false;
+  }
+
+ private:
+  void refill() {
+    if (readPos_ == out_.size()) {
+      out_.clear();
+      readPos_ = 0;
+    }
+    std::string line;
+    while (authorized_ && buffered() < 8192 && moreLines(line)) {
+      out_ += line;
+      line.clear();
+    }
+  }
+
+  std::string extranonce1_;
+  std::string afterAuthorize_;
+  bool connected_ = false;
+  bool authorized_ = false;
+  bool silent_ = false;
+  std::string out_;
+  size_t readPos_ = 0;
+  std::vector<std::string> sent_;
+};
+
+}  // namespace idk_test
@@ -0,0 +1,5 @@
+#pragma once
+
+#include "app/project_profile.h"
+
+idk::ProjectProfile makeProjectProfile();
@@ -0,0 +1,71 @@
+#pragma once
+
+// Host stand-in for the Arduino-ESP32 core: only the API idk-mine-core uses,
+// mapped onto the C++ standard library so the core builds and runs natively.
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+
+#include "esp_system.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+using std::max;
+using std::min;
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// Milliseconds / microseconds since process start (monotonic).
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void yield();
+
+#if defined(__GLIBC__) && !__GLIBC_PREREQ(2, 38)
+size_t strlcpy(char* dst, const char* src, size_t size);
+#endif
+
+class String {
+ public:
+  String() = default;
+  String(const char* text) : value_((text == nullptr) ? "" : text) {}
+
+  void reserve(size_t size) { value_.reserve(size); }
+  String& operator+=(char c) {
+    value_ += c;
+    return *this;
+  }
+  String& operator+=(const char* text) {
+    value_ += text;
+    return *this;
+  }
+  const char* c_str() const { return value_.c_str(); }
+  size_t length() const { return value_.size(); }
+
+ private:
+  std::string value_;
+};
+
+// Writes to stdout; begin() only exists for source compatibility.
+class HardwareSerial {
+ public:
+  void begin(unsigned long baud);
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+  size_t print(const char* text);
+  size_t println(const char* text = "");
+  size_t write(uint8_t c);
+  size_t write(const uint8_t* buf, size_t len);
+  void flush();
+  // Input comes from stdin and never blocks.
+  int available();
+  int read();
+};
+
+extern HardwareSerial Serial;
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include <functional>
+
+typedef enum {
+  OTA_AUTH_ERROR,
+  OTA_BEGIN_ERROR,
+  OTA_CONNECT_ERROR,
+  OTA_RECEIVE_ERROR,
+  OTA_END_ERROR,
+} ota_error_t;
+
+// Never receives an update; handlers are accepted so callers build unchanged.
+class ArduinoOTAClass {
+ public:
+  typedef std::function<void()> THandlerFunction;
+  typedef std::function<void(ota_error_t)> THandlerFunction_Error;
+
+  ArduinoOTAClass& setHostname(const char*) { return *this; }
+  ArduinoOTAClass& onStart(THandlerFunction) { return *this; }
+  ArduinoOTAClass& onEnd(THandlerFunction) { return *this; }
+  ArduinoOTAClass& onError(THandlerFunction_Error) { return *this; }
+  void begin() {}
+  void handle() {}
+};
+
+extern ArduinoOTAClass ArduinoOTA;
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include <memory>
+#include <string>
+
+namespace fs {
+
+// Arduino fs::File over a stdio FILE*; copies share the handle.
+class File {
+ public:
+  File() = default;
+  explicit File(FILE* fp);
+
+  explicit operator bool() const { return fp_ != nullptr; }
+  size_t size() const;
+  int available();
+  int read();
+  size_t read(uint8_t* buf, size_t len);
+  size_t write(uint8_t c);
+  size_t write(const uint8_t* buf, size_t len);
+  void close();
+
+ private:
+  std::shared_ptr<FILE> fp_;
+};
+
+// Paths are resolved under a host directory instead of a flash partition.
+class FS {
+ public:
+  explicit FS(const char* root);
+
+  File open(const char* path, const char* mode = "r");
+  bool exists(const char* path);
+  bool remove(const char* path);
+
+ protected:
+  std::string hostPath(const char* path) const;
+
+  std::string root_;
+};
+
+}  // namespace fs
+
+using fs::File;
+using fs::FS;
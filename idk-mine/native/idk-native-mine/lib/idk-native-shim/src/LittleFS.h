@@ -0,0 +1,16 @@
+#pragma once
+
+#include "FS.h"
+
+// LittleFS rooted at $IDK_FS_ROOT, or ./data (the directory `pio run -t
+// uploadfs` would flash) when unset.
+class LittleFSFS : public fs::FS {
+ public:
+  LittleFSFS();
+
+  bool begin(bool formatOnFail = false, const char* basePath = "/littlefs", uint8_t maxOpenFiles = 10,
+             const char* partitionLabel = "spiffs");
+  void end() {}
+};
+
+extern LittleFSFS LittleFS;
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <Arduino.h>
+
+typedef enum {
+  WL_NO_SHIELD = 255,
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_SCAN_COMPLETED = 2,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6,
+} wl_status_t;
+
+typedef enum {
+  WIFI_OFF = 0,
+  WIFI_STA = 1,
+  WIFI_AP = 2,
+  WIFI_AP_STA = 3,
+} wifi_mode_t;
+
+class IPAddress {
+ public:
+  IPAddress() = default;
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : bytes_{a, b, c, d} {}
+
+  uint8_t operator[](int index) const { return bytes_[index]; }
+
+ private:
+  uint8_t bytes_[4] = {0, 0, 0, 0};
+};
+
+// The host network is always up: status() reports WL_CONNECTED with a fixed
+// strong signal, and the station calls are accepted and ignored.
+class WiFiClass {
+ public:
+  bool mode(wifi_mode_t) { return true; }
+  bool setAutoReconnect(bool) { return true; }
+  void persistent(bool) {}
+  wl_status_t begin(const char*, const char* = nullptr) { return WL_CONNECTED; }
+  bool disconnect(bool = false, bool = false) { return true; }
+  wl_status_t status() { return WL_CONNECTED; }
+  int8_t RSSI() { return -40; }
+  IPAddress localIP() { return IPAddress(127, 0, 0, 1); }
+};
+
+extern WiFiClass WiFi;
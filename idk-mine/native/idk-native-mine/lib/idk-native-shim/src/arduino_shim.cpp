@@ -0,0 +1,188 @@
+#include <Arduino.h>
+#include <ArduinoOTA.h>
+#include <WiFi.h>
+#include <esp_heap_caps.h>
+
+#include <stdarg.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <thread>
+
+HardwareSerial Serial;
+WiFiClass WiFi;
+ArduinoOTAClass ArduinoOTA;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const Clock::time_point gStart = Clock::now();
+
+std::mutex gSerialMutex;
+std::mutex gRandomMutex;
+std::mt19937 gRandom{std::random_device{}()};
+
+// Allocations carry their size in front so frees can credit the budget.
+constexpr size_t kHeapHeaderBytes = 16;
+std::atomic<size_t> gHeapUsed{0};
+std::atomic<size_t> gHeapHighWater{0};
+
+}  // namespace
+
+uint32_t millis() {
+  return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - gStart).count());
+}
+
+uint32_t micros() {
+  return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - gStart).count());
+}
+
+void delay(uint32_t ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void yield() {
+  std::this_thread::yield();
+}
+
+#if defined(__GLIBC__) && !__GLIBC_PREREQ(2, 38)
+size_t strlcpy(char* dst, const char* src, size_t size) {
+  const size_t len = strlen(src);
+  if (size > 0) {
+    const size_t n = (len < size - 1) ? len : size - 1;
+    memcpy(dst, src, n);
+    dst[n] = '\0';
+  }
+  return len;
+}
+#endif
+
+uint32_t esp_random() {
+  std::lock_guard<std::mutex> lock(gRandomMutex);
+  return static_cast<uint32_t>(gRandom());
+}
+
+void esp_fill_random(void* buf, size_t len) {
+  auto* out = static_cast<uint8_t*>(buf);
+  for (size_t i = 0; i < len; i += 4) {
+    const uint32_t r = esp_random();
+    const size_t n = (len - i < 4) ? len - i : 4;
+    memcpy(out + i, &r, n);
+  }
+}
+
+void* heap_caps_malloc(size_t size, uint32_t) {
+  const size_t used = gHeapUsed.fetch_add(size) + size;
+  if (used > IDK_NATIVE_HEAP_BYTES) {
+    gHeapUsed.fetch_sub(size);
+    return nullptr;
+  }
+
+  auto* block = static_cast<uint8_t*>(malloc(size + kHeapHeaderBytes));
+  if (block == nullptr) {
+    gHeapUsed.fetch_sub(size);
+    return nullptr;
+  }
+  memcpy(block, &size, sizeof(size));
+
+  size_t high = gHeapHighWater.load();
+  while (used > high && !gHeapHighWater.compare_exchange_weak(high, used)) {
+  }
+  return block + kHeapHeaderBytes;
+}
+
+void heap_caps_free(void* ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+  uint8_t* block = static_cast<uint8_t*>(ptr) - kHeapHeaderBytes;
+  size_t size = 0;
+  memcpy(&size, block, sizeof(size));
+  gHeapUsed.fetch_sub(size);
+  free(block);
+}
+
+size_t heap_caps_get_free_size(uint32_t) {
+  return IDK_NATIVE_HEAP_BYTES - gHeapUsed.load();
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps) {
+  return heap_caps_get_free_size(caps);
+}
+
+size_t heap_caps_get_minimum_free_size(uint32_t) {
+  return IDK_NATIVE_HEAP_BYTES - gHeapHighWater.load();
+}
+
+void HardwareSerial::begin(unsigned long) {}
+
+size_t HardwareSerial::printf(const char* format, ...) {
+  std::lock_guard<std::mutex> lock(gSerialMutex);
+  va_list args;
+  va_start(args, format);
+  const int n = vprintf(format, args);
+  va_end(args);
+  fflush(stdout);
+  return (n < 0) ? 0 : static_cast<size_t>(n);
+}
+
+size_t HardwareSerial::print(const char* text) {
+  return write(reinterpret_cast<const uint8_t*>(text), strlen(text));
+}
+
+size_t HardwareSerial::println(const char* text) {
+  std::lock_guard<std::mutex> lock(gSerialMutex);
+  const size_t n = fwrite(text, 1, strlen(text), stdout) + fwrite("\n", 1, 1, stdout);
+  fflush(stdout);
+  return n;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buf, size_t len) {
+  std::lock_guard<std::mutex> lock(gSerialMutex);
+  const size_t n = fwrite(buf, 1, len, stdout);
+  fflush(stdout);
+  return n;
+}
+
+void HardwareSerial::flush() {
+  std::lock_guard<std::mutex> lock(gSerialMutex);
+  fflush(stdout);
+}
+
+int HardwareSerial::available() {
+  // 0 at end of input as well, so a closed stdin never looks readable.
+  int pending = 0;
+  if (ioctl(STDIN_FILENO, FIONREAD, &pending) != 0) {
+    return 0;
+  }
+  return pending;
+}
+
+int HardwareSerial::read() {
+  uint8_t c = 0;
+  if (available() <= 0 || ::read(STDIN_FILENO, &c, 1) != 1) {
+    return -1;
+  }
+  return c;
+}
+
+// Arduino entry points: setup() once, then loop() forever on the main thread,
+// which stands in for the core-1 loop task.
+void setup();
+void loop();
+
+int main() {
+  setup();
+  while (true) {
+    loop();
+  }
+}
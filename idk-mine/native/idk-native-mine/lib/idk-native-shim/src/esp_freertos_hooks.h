@@ -0,0 +1,9 @@
+#pragma once
+
+#include "esp_system.h"
+#include "freertos/FreeRTOS.h"
+
+typedef bool (*esp_freertos_idle_cb_t)();
+
+// Hooks run from one host "IDLE" thread per core, once per tick.
+esp_err_t esp_register_freertos_idle_hook_for_cpu(esp_freertos_idle_cb_t cb, UBaseType_t cpuid);
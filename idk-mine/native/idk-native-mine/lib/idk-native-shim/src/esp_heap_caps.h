@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MALLOC_CAP_EXEC (1 << 0)
+#define MALLOC_CAP_32BIT (1 << 1)
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_DMA (1 << 3)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_DEFAULT (1 << 12)
+
+// Capability allocations draw from a fixed budget (IDK_NATIVE_HEAP_BYTES,
+// roughly a WROOM-32's free heap after Wi-Fi) so code that sizes itself to
+// the free heap, like the scrypt scratchpads, decides as it would on device.
+#ifndef IDK_NATIVE_HEAP_BYTES
+#define IDK_NATIVE_HEAP_BYTES (280 * 1024)
+#endif
+
+void* heap_caps_malloc(size_t size, uint32_t caps);
+void heap_caps_free(void* ptr);
+size_t heap_caps_get_free_size(uint32_t caps);
+size_t heap_caps_get_minimum_free_size(uint32_t caps);
+// The budget does not fragment: the largest block is everything free.
+size_t heap_caps_get_largest_free_block(uint32_t caps);
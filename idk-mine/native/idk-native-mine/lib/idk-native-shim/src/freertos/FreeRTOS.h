@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdFAIL pdFALSE
+#define pdPASS pdTRUE
+
+#define configTICK_RATE_HZ 1000
+#define portMAX_DELAY 0xFFFFFFFFu
+#define portTICK_PERIOD_MS (1000 / configTICK_RATE_HZ)
+#define portNUM_PROCESSORS 2
+#define pdMS_TO_TICKS(ms) ((TickType_t)(((TickType_t)(ms) * configTICK_RATE_HZ) / 1000))
+
+#define tskIDLE_PRIORITY 0
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+// Core the calling task was pinned to; unpinned tasks and the main thread
+// report core 1, where the Arduino loop task runs.
+BaseType_t xPortGetCoreID();
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+// Tasks are detached std::threads. Priorities and stack sizes are accepted
+// and ignored; the pin only decides what xPortGetCoreID() reports.
+typedef void (*TaskFunction_t)(void*);
+typedef struct IdkShimTask* TaskHandle_t;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth, void* arg,
+                                   UBaseType_t priority, TaskHandle_t* created, BaseType_t coreId);
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stackDepth, void* arg, UBaseType_t priority,
+                       TaskHandle_t* created);
+// nullptr (or the caller's own handle) ends the calling task. A host thread
+// cannot be killed from outside, so deleting another task only detaches its
+// handle; the task has to leave its loop on its own, as every core task does
+// once its owner's running flag drops.
+void vTaskDelete(TaskHandle_t task);
+// Host threads get megabytes of stack and their use is not measured, so this
+// reports the whole requested depth as never touched.
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount();
+void vPortYield();
+
+#define taskYIELD() vPortYield()
@@ -0,0 +1,179 @@
+#include <Arduino.h>
+#include <esp_freertos_hooks.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <string.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+struct IdkShimTask {
+  std::string name;
+  BaseType_t core;
+  uint32_t stackDepth;
+};
+
+struct IdkShimSemaphore {
+  std::mutex mutex;
+  std::condition_variable cv;
+  UBaseType_t count;
+  UBaseType_t maxCount;
+};
+
+namespace {
+
+constexpr UBaseType_t kMaxIdleHooks = 8;
+
+// Thrown by vTaskDelete(nullptr) and caught at the bottom of the task thread.
+struct TaskExit {};
+
+thread_local IdkShimTask* tCurrentTask = nullptr;
+thread_local BaseType_t tCoreId = 1;
+
+std::mutex gIdleMutex;
+esp_freertos_idle_cb_t gIdleHooks[portNUM_PROCESSORS][kMaxIdleHooks] = {};
+bool gIdleThreadStarted[portNUM_PROCESSORS] = {};
+
+void idleThread(BaseType_t core) {
+  tCoreId = core;
+  while (true) {
+    esp_freertos_idle_cb_t hooks[kMaxIdleHooks];
+    {
+      std::lock_guard<std::mutex> lock(gIdleMutex);
+      memcpy(hooks, gIdleHooks[core], sizeof(hooks));
+    }
+    for (esp_freertos_idle_cb_t hook : hooks) {
+      if (hook != nullptr) {
+        hook();
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(portTICK_PERIOD_MS));
+  }
+}
+
+}  // namespace
+
+BaseType_t xPortGetCoreID() {
+  return tCoreId;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth, void* arg, UBaseType_t,
+                                   TaskHandle_t* created, BaseType_t coreId) {
+  const BaseType_t core = (coreId >= 0 && coreId < portNUM_PROCESSORS) ? coreId : 1;
+  // Never freed: a handle must stay valid for vTaskDelete after the task ends.
+  auto* task = new IdkShimTask{(name == nullptr) ? "" : name, core, stackDepth};
+  // As in the kernel, the handle is out before the task can run.
+  if (created != nullptr) {
+    *created = task;
+  }
+  std::thread([fn, arg, task]() {
+    tCurrentTask = task;
+    tCoreId = task->core;
+    try {
+      fn(arg);
+    } catch (const TaskExit&) {
+    }
+  }).detach();
+  return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stackDepth, void* arg, UBaseType_t priority,
+                       TaskHandle_t* created) {
+  return xTaskCreatePinnedToCore(fn, name, stackDepth, arg, priority, created, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+  if ((task == nullptr || task == tCurrentTask) && tCurrentTask != nullptr) {
+    throw TaskExit();
+  }
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+  if (task == nullptr) {
+    task = tCurrentTask;
+  }
+  return (task == nullptr) ? 0 : task->stackDepth;
+}
+
+// Like the kernel, wakes on the tick boundary `ticks` from now, so a one-tick
+// delay lasts anywhere from zero to one tick period.
+void vTaskDelay(TickType_t ticks) {
+  const uint64_t nowUs = micros();
+  const uint64_t tickUs = portTICK_PERIOD_MS * 1000u;
+  const uint64_t wakeUs = (nowUs / tickUs + ticks) * tickUs;
+  std::this_thread::sleep_for(std::chrono::microseconds(wakeUs - nowUs));
+}
+
+TickType_t xTaskGetTickCount() {
+  return millis() / portTICK_PERIOD_MS;
+}
+
+void vPortYield() {
+  std::this_thread::yield();
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount) {
+  auto* semaphore = new IdkShimSemaphore();
+  semaphore->count = initialCount;
+  semaphore->maxCount = maxCount;
+  return semaphore;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+  return xSemaphoreCreateCounting(1, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+  return xSemaphoreCreateCounting(1, 0);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+  delete semaphore;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) {
+  std::unique_lock<std::mutex> lock(semaphore->mutex);
+  const auto ready = [semaphore]() { return semaphore->count > 0; };
+  if (ticks == portMAX_DELAY) {
+    semaphore->cv.wait(lock, ready);
+  } else if (!semaphore->cv.wait_for(lock, std::chrono::milliseconds(ticks * portTICK_PERIOD_MS), ready)) {
+    return pdFALSE;
+  }
+  semaphore->count--;
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+  {
+    std::lock_guard<std::mutex> lock(semaphore->mutex);
+    if (semaphore->count >= semaphore->maxCount) {
+      return pdFALSE;
+    }
+    semaphore->count++;
+  }
+  semaphore->cv.notify_one();
+  return pdTRUE;
+}
+
+esp_err_t esp_register_freertos_idle_hook_for_cpu(esp_freertos_idle_cb_t cb, UBaseType_t cpuid) {
+  if (cpuid >= portNUM_PROCESSORS) {
+    return ESP_FAIL;
+  }
+
+  std::lock_guard<std::mutex> lock(gIdleMutex);
+  for (esp_freertos_idle_cb_t& slot : gIdleHooks[cpuid]) {
+    if (slot == nullptr) {
+      slot = cb;
+      if (!gIdleThreadStarted[cpuid]) {
+        gIdleThreadStarted[cpuid] = true;
+        std::thread(idleThread, static_cast<BaseType_t>(cpuid)).detach();
+      }
+      return ESP_OK;
+    }
+  }
+  return ESP_FAIL;
+}
@@ -0,0 +1,85 @@
+#include "FS.h"
+#include "LittleFS.h"
+
+#include <sys/stat.h>
+
+LittleFSFS LittleFS;
+
+namespace fs {
+
+File::File(FILE* fp) : fp_(fp, [](FILE* f) { fclose(f); }) {}
+
+size_t File::size() const {
+  if (!fp_) {
+    return 0;
+  }
+  struct stat st {};
+  return (fstat(fileno(fp_.get()), &st) == 0) ? static_cast<size_t>(st.st_size) : 0;
+}
+
+int File::available() {
+  if (!fp_) {
+    return 0;
+  }
+  const long pos = ftell(fp_.get());
+  const size_t total = size();
+  return (pos < 0 || static_cast<size_t>(pos) >= total) ? 0 : static_cast<int>(total - static_cast<size_t>(pos));
+}
+
+int File::read() {
+  return fp_ ? fgetc(fp_.get()) : -1;
+}
+
+size_t File::read(uint8_t* buf, size_t len) {
+  return fp_ ? fread(buf, 1, len, fp_.get()) : 0;
+}
+
+size_t File::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t File::write(const uint8_t* buf, size_t len) {
+  return fp_ ? fwrite(buf, 1, len, fp_.get()) : 0;
+}
+
+void File::close() {
+  fp_.reset();
+}
+
+FS::FS(const char* root) : root_(root) {}
+
+File FS::open(const char* path, const char* mode) {
+  const char* hostMode = (mode[0] == 'w') ? "wb" : (mode[0] == 'a') ? "ab" : "rb";
+  FILE* fp = fopen(hostPath(path).c_str(), hostMode);
+  return (fp == nullptr) ? File() : File(fp);
+}
+
+bool FS::exists(const char* path) {
+  struct stat st {};
+  return stat(hostPath(path).c_str(), &st) == 0;
+}
+
+bool FS::remove(const char* path) {
+  return ::remove(hostPath(path).c_str()) == 0;
+}
+
+std::string FS::hostPath(const char* path) const {
+  return root_ + ((path[0] == '/') ? "" : "/") + path;
+}
+
+}  // namespace fs
+
+LittleFSFS::LittleFSFS() : fs::FS("data") {
+  const char* root = getenv("IDK_FS_ROOT");
+  if (root != nullptr && root[0] != '\0') {
+    root_ = root;
+  }
+}
+
+bool LittleFSFS::begin(bool formatOnFail, const char*, uint8_t, const char*) {
+  struct stat st {};
+  if (stat(root_.c_str(), &st) == 0) {
+    return S_ISDIR(st.st_mode);
+  }
+  return formatOnFail && mkdir(root_.c_str(), 0755) == 0;
+}
@@ -0,0 +1,250 @@
+#include <Arduino.h>
+
+#include "config/miner_tuning.h"
+#include "config/runtime_config.h"
+#include "miner/hash_kernel.h"
+#include "miner/miner_engine.h"
+#include "network/json_pull.h"
+#include "network/stratum_client.h"
+
+#include <string>
+
+#include "host_fixtures.h"
+
+// Host throughput numbers for idk-mine-core: raw kernel hash rates, the full
+// two-worker MinerEngine, the runtime config parser, the stratum line
+// tokenizer and end-to-end mining.notify ingestion through StratumClient.
+
+namespace {
+
+constexpr uint32_t kRunMs = 2000;
+constexpr uint32_t kEngineRunMs = 3000;
+constexpr uint32_t kNotifyLines = 20000;
+
+// A public-pool.io sized notify: 12 merkle branches, ~1.2 KB on the wire.
+std::string makeNotifyLine(uint32_t jobId) {
+  std::string line = "{\"id\":null,\"method\":\"mining.notify\",\"params\":[\"";
+  line += std::to_string(jobId);
+  line += "\",\"4d16b6f85af6e2198f44ae2a6de67f78487ae5611b77c6c0440b921e00000000\",";
+  line += "\"01000000010000000000000000000000000000000000000000000000000000000000000000ffffffff2503a1bb0c04";
+  line += "\",\"0a2f69646b2d6d696e652fffffffff0200f2052a010000001976a914";
+  line += std::string(40, 'a');
+  line += "88ac0000000000000000266a24aa21a9ed";
+  line += std::string(64, 'e');
+  line += "00000000\",[";
+  for (int i = 0; i < 12; ++i) {
+    line += (i == 0) ? "\"" : ",\"";
+    line += std::string(64, static_cast<char>('0' + (i % 10)));
+    line += "\"";
+  }
+  line += "],\"20000000\",\"1703a30c\",\"6553f1b0\",false]}\n";
+  return line;
+}
+
+// Serves subscribe/authorize replies and then a stream of notify lines from
+// memory, so the client's framing, tokenizer and job builder are timed
+// without a socket.
+class NotifyStreamTransport : public idk_test::ScriptedPoolTransport {
+ public:
+  explicit NotifyStreamTransport(uint32_t notifyLines)
+      : ScriptedPoolTransport("f000000f", ""), notifyLeft_(notifyLines) {}
+
+  bool drained() const { return notifyLeft_ == 0 && buffered() == 0; }
+  uint64_t bytesServed() const { return bytesServed_; }
+
+ protected:
+  bool moreLines(std::string& line) override {
+    if (notifyLeft_ == 0) {
+      return false;
+    }
+    line = makeNotifyLine(notifyLeft_--);
+    bytesServed_ += line.size();
+    return true;
+  }
+
+ private:
+  uint32_t notifyLeft_;
+  uint64_t bytesServed_ = 0;
+};
+
+template <typename Kernel>
+void benchKernel(const char* name, typename Kernel::Context& context) {
+  uint8_t header[80];
+  esp_fill_random(header, sizeof(header));
+  typename Kernel::Job job;
+  Kernel::prepare(header, job);
+
+  uint32_t nonces[Kernel::kLanes];
+  uint32_t top32[Kernel::kLanes];
+  uint32_t sink = 0;
+  uint64_t hashes = 0;
+  const uint32_t startUs = micros();
+  uint32_t elapsedUs = 0;
+  do {
+    for (uint16_t i = 0; i < Kernel::kMaxBatch; i += Kernel::kLanes) {
+      for (uint8_t lane = 0; lane < Kernel::kLanes; ++lane) {
+        nonces[lane] = static_cast<uint32_t>(hashes) + i + lane;
+      }
+      Kernel::hashLanes(job, context, nonces, top32);
+      sink ^= top32[0];
+    }
+    hashes += Kernel::kMaxBatch;
+    elapsedUs = micros() - startUs;
+  } while (elapsedUs < kRunMs * 1000u);
+
+  Serial.printf("[bench] %s kernel: %.2f H/s (1 thread, %u lanes, sink %08x)\n", name,
+                static_cast<double>(hashes) * 1e6 / elapsedUs, static_cast<unsigned>(Kernel::kLanes),
+                static_cast<unsigned>(sink));
+}
+
+void benchEngine(idk::CoinType coin) {
+  // Workers outlive stop() briefly on the host, so the engine is never freed.
+  static idk::MinerEngine engines[2];
+  idk::MinerEngine& engine = engines[static_cast<uint8_t>(coin)];
+  idk::RuntimeConfig cfg = idk_test::makeHostConfig();
+  cfg.defaultCoin = coin;
+  idk::MinerTuning tuning{};
+  engine.begin(cfg, idk::MinerMode::Mine, tuning);
+
+  engine.sampleCounters(millis());
+  const uint64_t startHashes = engine.totalHashes();
+  const uint32_t startMs = millis();
+  delay(kEngineRunMs);
+  engine.sampleCounters(millis());
+  const uint32_t elapsedMs = millis() - startMs;
+  const uint64_t hashes = engine.totalHashes() - startHashes;
+  engine.stop();
+
+  Serial.printf("[bench] %s engine: %.2f H/s (%u workers, batch %u)\n", idk::coinToString(coin),
+                static_cast<double>(hashes) * 1000.0 / elapsedMs, static_cast<unsigned>(engine.workerCount()),
+                static_cast<unsigned>(engine.batchSize()));
+}
+
+void benchConfigParse(const char* json) {
+  const size_t bytes = strlen(json);
+  idk::RuntimeConfig cfg{};
+  char err[96] = {0};
+  uint32_t parses = 0;
+  bool ok = true;
+  const uint32_t startUs = micros();
+  uint32_t elapsedUs = 0;
+  do {
+    ok = idk::loadDefaultsFromJson(json, cfg, err, sizeof(err)) && ok;
+    parses++;
+    elapsedUs = micros() - startUs;
+  } while (elapsedUs < kRunMs * 1000u);
+
+  Serial.printf("[bench] config parse: %.0f/s, %.2f MB/s (%u bytes%s%s)\n", parses * 1e6 / elapsedUs,
+                static_cast<double>(parses) * bytes / elapsedUs, static_cast<unsigned>(bytes), ok ? "" : ", error: ",
+                ok ? "" : err);
+}
+
+void benchJsonPull() {
+  const std::string line = makeNotifyLine(1);
+  std::string scratch;
+  idk::JsonPull json;
+  uint32_t lines = 0;
+  bool ok = true;
+  const uint32_t startUs = micros();
+  uint32_t elapsedUs = 0;
+  do {
+    // The tokenizer unescapes in place, so each pass starts from a fresh copy.
+    scratch = line;
+    ok = json.parse(&scratch[0], scratch.size() - 1) && ok;
+    lines++;
+    elapsedUs = micros() - startUs;
+  } while (elapsedUs < kRunMs * 1000u);
+
+  Serial.printf("[bench] json tokenize: %.0f lines/s, %.2f MB/s (%u-byte notify%s)\n", lines * 1e6 / elapsedUs,
+                static_cast<double>(lines) * line.size() / elapsedUs, static_cast<unsigned>(line.size()),
+                ok ? "" : ", parse errors");
+}
+
+void benchStratumIngest() {
+  static const idk::RuntimeConfig cfg = idk_test::makeHostConfig();
+  NotifyStreamTransport transport(kNotifyLines);
+  idk::StratumClient client;
+  client.begin(&cfg, &transport);
+  client.setCoin(cfg.defaultCoin);
+  client.setIdentity(cfg.btcWallet, cfg.workerName, cfg.minerName, cfg.poolPassword);
+
+  idk::StratumJob job;
+  uint32_t jobs = 0;
+  const uint32_t startMs = millis();
+  const uint32_t startUs = micros();
+  client.sampleRx(startMs);
+  while (!transport.drained() && millis() - startMs < 60000) {
+    client.loop(millis(), true);
+    if (client.takeLatestJob(job)) {
+      jobs++;
+    }
+  }
+  const uint32_t elapsedUs = micros() - startUs;
+  client.sampleRx(millis());
+
+  Serial.printf("[bench] stratum ingest: %.0f notify/s, %.2f MB/s, %u jobs built, line_parse=%uus max=%uus\n",
+                kNotifyLines * 1e6 / elapsedUs, static_cast<double>(transport.bytesServed()) / elapsedUs,
+                static_cast<unsigned>(jobs), static_cast<unsigned>(client.lineParseUs()),
+                static_cast<unsigned>(client.maxLineParseUs()));
+}
+
+const char kConfigJson[] = R"json(
+{
+  "project_name": "idk-native-bench",
+  "miner_name": "idk-native",
+  "worker_name": "bench",
+  "default_coin": "BTC",
+  "enable_ota": false,
+  "pool_password": "x",
+  "wallets": {
+    "btc": "bc1qul2pvt0l5deykfznzkzhfjf3yj3cla2cssd54e",
+    "ltc": "ltc1qcl9h4kffh8w8nr77u8la5ykn4cg59ms2lteply"
+  },
+  "pool": {
+    "btc": [
+      {"host": "public-pool.io", "port": 4333, "tls": true},
+      {"host": "public-pool.io", "port": 3333, "tls": false}
+    ],
+    "ltc": [
+      {"host": "rx.unmineable.com", "port": 443, "tls": true},
+      {"host": "rx.unmineable.com", "port": 3333, "tls": false}
+    ]
+  },
+  "timing": {"telemetry_ms": 1000, "ui_ms": 200, "wifi_reconnect_ms": 5000, "pool_retry_ms": 4000,
+             "pool_probe_ms": 60000, "keepalive_ms": 30000},
+  "miner": {"threads": 2, "batch_size": 1024, "autotune": true, "lottery_target32": 65535, "mine_target32": 4095}
+}
+)json";
+
+}  // namespace
+
+void setup() {
+  Serial.println("=== idk-mine native bench ===");
+
+#if IDK_MINER_SHA256D
+  idk::Sha256dKernel::Context sha256dContext;
+  benchKernel<idk::Sha256dKernel>("sha256d", sha256dContext);
+  benchEngine(idk::CoinType::BTC);
+#endif
+#if IDK_MINER_SCRYPT
+  idk::ScryptScratchpad scratchpad{};
+  for (uint32_t*& segment : scratchpad.segments) {
+    segment = static_cast<uint32_t*>(malloc(idk::kScryptSegmentBytes));
+  }
+  benchKernel<idk::ScryptKernel>("scrypt", scratchpad);
+  for (uint32_t* segment : scratchpad.segments) {
+    free(segment);
+  }
+  benchEngine(idk::CoinType::LTC);
+#endif
+
+  benchConfigParse(kConfigJson);
+  benchJsonPull();
+  benchStratumIngest();
+
+  // Skip static destructors: stopped workers may still be finishing a batch.
+  fflush(stdout);
+  _Exit(0);
+}
+
+void loop() {}
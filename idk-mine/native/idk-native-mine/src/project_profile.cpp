@@ -0,0 +1,71 @@
+#include "project_profile_factory.h"
+
+namespace {
+
+// Both coins point at a local mock pool (scripts/mock_stratum_server.py);
+// data/runtime_config.json overrides this like LittleFS does on device.
+static const char kDefaultConfigJson[] = R"json(
+{
+  "project_name": "idk-native-mine",
+  "miner_name": "idk-native",
+  "worker_name": "native-mine",
+  "default_coin": "BTC",
+  "enable_ota": false,
+  "pool_password": "x",
+  "wallets": {
+    "btc": "bc1qul2pvt0l5deykfznzkzhfjf3yj3cla2cssd54e",
+    "ltc": "ltc1qcl9h4kffh8w8nr77u8la5ykn4cg59ms2lteply"
+  },
+  "pool": {
+    "btc": [
+      {
+        "host": "127.0.0.1",
+        "port": 3333,
+        "tls": false
+      }
+    ],
+    "ltc": [
+      {
+        "host": "127.0.0.1",
+        "port": 3333,
+        "tls": false
+      }
+    ]
+  },
+  "timing": {
+    "telemetry_ms": 1000,
+    "history_ms": 5000,
+    "ui_ms": 200,
+    "wifi_reconnect_ms": 5000,
+    "pool_retry_ms": 1000,
+    "pool_probe_ms": 10000,
+    "keepalive_ms": 30000
+  },
+  "miner": {
+    "threads": 2,
+    "batch_size": 1024,
+    "autotune": true,
+    "lottery_target32": 65535,
+    "mine_target32": 4095
+  },
+  "alerts": {
+    "stack_free_bytes": 512,
+    "heap_free_bytes": 16384
+  }
+}
+)json";
+
+}  // namespace
+
+idk::ProjectProfile makeProjectProfile() {
+  idk::ProjectProfile profile{};
+  profile.projectName = "idk-native-mine";
+  profile.minerName = "idk-native";
+  profile.wifiSsid = "host";
+  profile.wifiPassword = "";
+  profile.defaultConfigJson = kDefaultConfigJson;
+  profile.device = idk::DeviceKind::HEADLESS;
+  profile.variant = idk::VariantKind::Mine;
+  profile.enableOtaByDefault = false;
+  return profile;
+}
@@ -0,0 +1,294 @@
+#include <Arduino.h>
+#include <unity.h>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "network/json_pull.h"
+
+// Robustness of the stratum tokenizer: recorded pool lines, every truncation
+// of them and seeded random mutations, each parsed with its last byte right
+// before a PROT_NONE page so any read past `len` faults. Successful parses
+// are walked through every accessor. IDK_FUZZ_ITERATIONS raises the number
+// of mutations for longer runs.
+
+namespace {
+
+// Recorded from scripts/mock_stratum_server.py, plus the error and escape
+// shapes real pools send.
+const char* const kRecordedLines[] = {
+    R"({"id":1,"result":[[["mining.set_difficulty","1"],["mining.notify","1"]],"c75fd489",4],"error":null})",
+    R"({"id":2,"result":true,"error":null})",
+    R"({"id":null,"method":"mining.set_difficulty","params":[0.001]})",
+    R"({"id":null,"method":"mining.notify","params":["1","24d3e087bfe0c15f606db97836449852a44414f98f425301fb08affb3d64c11c",)"
+    R"("01000000010000000000000000000000000000000000000000000000000000000000000000ffffffff20d7cf75fc1429c3ed",)"
+    R"("ffffffff0100f2052a010000001976a914000000000000000000000000000000000000000088ac00000000",)"
+    R"(["ec281a3fd6059c526ee46c08f741390a4ad3f4d68197989527a93fb3aa507b9f",)"
+    R"("c1467dc3a5518ea6089192101a1186d0209d0bfd060af53ad0453637d1374267"],"20000000","1d00ffff","6ad1eb15",true]})",
+    R"({"id":5,"result":null,"error":[23,"Low difficulty share",null]})",
+    R"({"id":null,"method":"mining.set_extranonce","params":["f000000f",4]})",
+    R"({"id":7,"result":false,"error":{"code":21,"message":"Job not found \"stale\" é😀"}})",
+    R"({"id":null,"method":"client.show_message","params":["tab\tnewline\nslash\/back\\"]})",
+    R"([1e3,-0.5,2E-2,0,-0,12345678901234567890])",
+    "4294967295",
+};
+
+const char* const kKeys[] = {"id", "method", "params", "result", "error", "code", "message"};
+
+// Bytes the mutator splices in: structure, escapes and number syntax.
+const char kInteresting[] = "{}[]\":,\\u0123456789eE+-.tfn \t\n\xff";
+
+// Inputs sit at the end of a read-write region with a PROT_NONE page after.
+constexpr size_t kRegionPages = 2;
+size_t gPageSize = 0;
+uint8_t* gRegion = nullptr;
+
+uint32_t gRng = 0x12345678u;
+
+uint32_t nextRandom() {
+  gRng ^= gRng << 13;
+  gRng ^= gRng >> 17;
+  gRng ^= gRng << 5;
+  return gRng;
+}
+
+bool mapRegion() {
+  gPageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  void* p = mmap(nullptr, gPageSize * (kRegionPages + 1), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (p == MAP_FAILED) {
+    return false;
+  }
+  gRegion = static_cast<uint8_t*>(p);
+  return mprotect(gRegion + (gPageSize * kRegionPages), gPageSize, PROT_NONE) == 0;
+}
+
+// Copies `data` so its last byte is the last readable one.
+char* placeAtGuard(const std::string& data) {
+  TEST_ASSERT_TRUE(data.size() <= gPageSize * kRegionPages);
+  char* text = reinterpret_cast<char*>(gRegion + (gPageSize * kRegionPages) - data.size());
+  memcpy(text, data.data(), data.size());
+  return text;
+}
+
+void walk(const idk::JsonPull& json, int16_t value, uint8_t depth) {
+  TEST_ASSERT_TRUE(depth <= idk::JsonPull::kMaxDepth);
+  const idk::JsonType type = json.type(value);
+  TEST_ASSERT_TRUE(type != idk::JsonType::Invalid);
+
+  double number = 0.0;
+  uint32_t u32 = 0;
+  bool flag = false;
+  const char* text = json.string(value);
+  TEST_ASSERT_TRUE((text != nullptr) == (type == idk::JsonType::String));
+  if (text != nullptr) {
+    (void)strlen(text);
+  }
+  // A number may still be refused (too long to convert); nothing else converts.
+  (void)json.toDouble(value, number);
+  (void)json.toUint32(value, u32);
+  if (type != idk::JsonType::Number) {
+    TEST_ASSERT_FALSE(json.toDouble(value, number));
+  }
+  TEST_ASSERT_TRUE(json.toBool(value, flag) == (type == idk::JsonType::Bool));
+
+  if (type == idk::JsonType::Array) {
+    uint16_t seen = 0;
+    for (int16_t child = json.firstChild(value); child >= 0; child = json.nextSibling(child)) {
+      TEST_ASSERT_TRUE(child > value);
+      walk(json, child, static_cast<uint8_t>(depth + 1));
+      seen++;
+    }
+    TEST_ASSERT_EQUAL_UINT16(json.size(value), seen);
+    TEST_ASSERT_EQUAL_INT16(-1, json.element(value, seen));
+  } else if (type == idk::JsonType::Object) {
+    for (const char* key : kKeys) {
+      const int16_t member = json.member(value, key);
+      if (member >= 0) {
+        TEST_ASSERT_TRUE(member > value);
+        walk(json, member, static_cast<uint8_t>(depth + 1));
+      }
+    }
+  }
+}
+
+// Parses `data` against the guard page and checks the result is either a
+// walkable tree or a failure with a message.
+bool parseAndCheck(idk::JsonPull& json, const std::string& data) {
+  char* text = placeAtGuard(data);
+  if (!json.parse(text, data.size())) {
+    TEST_ASSERT_TRUE(json.error()[0] != '\0');
+    TEST_ASSERT_EQUAL_INT16(-1, json.root());
+    TEST_ASSERT_TRUE(json.type(json.root()) == idk::JsonType::Invalid);
+    return false;
+  }
+  TEST_ASSERT_EQUAL_INT16(0, json.root());
+  walk(json, json.root(), 1);
+  // Out-of-range indices are answered, not dereferenced.
+  for (int16_t i = -2; i < static_cast<int16_t>(idk::JsonPull::kMaxTokens + 2); ++i) {
+    double number = 0.0;
+    (void)json.type(i);
+    (void)json.size(i);
+    (void)json.string(i);
+    (void)json.toDouble(i, number);
+    (void)json.nextSibling(i);
+  }
+  return true;
+}
+
+std::string mutate(const std::string& base) {
+  std::string out = base;
+  const uint32_t edits = 1 + (nextRandom() % 4);
+  for (uint32_t e = 0; e < edits && !out.empty(); ++e) {
+    const size_t at = nextRandom() % out.size();
+    switch (nextRandom() % 5) {
+      case 0:
+        out[at] = static_cast<char>(out[at] ^ (1u << (nextRandom() % 8)));
+        break;
+      case 1:
+        out[at] = kInteresting[nextRandom() % (sizeof(kInteresting) - 1)];
+        break;
+      case 2:
+        out.insert(at, 1, kInteresting[nextRandom() % (sizeof(kInteresting) - 1)]);
+        break;
+      case 3:
+        out.erase(at, 1 + (nextRandom() % 8));
+        break;
+      default:
+        out.insert(at, out.substr(nextRandom() % out.size(), 1 + (nextRandom() % 16)));
+        break;
+    }
+  }
+  return out;
+}
+
+uint32_t fuzzIterations() {
+  const char* env = getenv("IDK_FUZZ_ITERATIONS");
+  const unsigned long n = (env != nullptr) ? strtoul(env, nullptr, 10) : 0;
+  return (n > 0) ? static_cast<uint32_t>(n) : 20000u;
+}
+
+idk::JsonPull gJson;
+
+}  // namespace
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_recorded_lines_parse() {
+  for (const char* line : kRecordedLines) {
+    TEST_ASSERT_TRUE_MESSAGE(parseAndCheck(gJson, line), gJson.error());
+  }
+
+  // The notify's fields come out as the client reads them.
+  TEST_ASSERT_TRUE(parseAndCheck(gJson, kRecordedLines[3]));
+  const int16_t params = gJson.member(gJson.root(), "params");
+  TEST_ASSERT_EQUAL_UINT16(9, gJson.size(params));
+  TEST_ASSERT_EQUAL_STRING("6ad1eb15", gJson.string(gJson.element(params, 7)));
+  bool clean = false;
+  TEST_ASSERT_TRUE(gJson.toBool(gJson.element(params, 8), clean));
+  TEST_ASSERT_TRUE(clean);
+
+  TEST_ASSERT_TRUE(parseAndCheck(gJson, kRecordedLines[6]));
+  const int16_t error = gJson.member(gJson.root(), "error");
+  TEST_ASSERT_EQUAL_STRING("Job not found \"stale\" \xc3\xa9\xf0\x9f\x98\x80",
+                           gJson.string(gJson.member(error, "message")));
+}
+
+void test_number_at_end_of_buffer() {
+  // Nothing terminates the number but the guard page.
+  double number = 0.0;
+  uint32_t u32 = 0;
+  TEST_ASSERT_TRUE(parseAndCheck(gJson, "4294967295"));
+  TEST_ASSERT_TRUE(gJson.toUint32(gJson.root(), u32));
+  TEST_ASSERT_EQUAL_UINT32(4294967295u, u32);
+  TEST_ASSERT_TRUE(parseAndCheck(gJson, "0.001"));
+  TEST_ASSERT_TRUE(gJson.toDouble(gJson.root(), number));
+  TEST_ASSERT_TRUE(number > 0.00099 && number < 0.00101);
+  TEST_ASSERT_TRUE(parseAndCheck(gJson, "-2e3"));
+  TEST_ASSERT_TRUE(gJson.toDouble(gJson.root(), number));
+  TEST_ASSERT_TRUE(number == -2000.0);
+  TEST_ASSERT_FALSE(gJson.toUint32(gJson.root(), u32));
+}
+
+void test_token_limit() {
+  // An array of N numbers is N + 1 tokens.
+  std::string fits = "[";
+  for (uint16_t i = 0; i + 1 < idk::JsonPull::kMaxTokens; ++i) {
+    fits += (i == 0) ? "1" : ",1";
+  }
+  fits += "]";
+  TEST_ASSERT_TRUE_MESSAGE(parseAndCheck(gJson, fits), gJson.error());
+  TEST_ASSERT_EQUAL_UINT16(idk::JsonPull::kMaxTokens - 1, gJson.size(gJson.root()));
+
+  std::string over = fits;
+  over.insert(over.size() - 1, ",1");
+  TEST_ASSERT_FALSE(parseAndCheck(gJson, over));
+  TEST_ASSERT_EQUAL_STRING("too many tokens", gJson.error());
+}
+
+void test_depth_limit() {
+  const std::string fits = std::string(idk::JsonPull::kMaxDepth, '[') + std::string(idk::JsonPull::kMaxDepth, ']');
+  TEST_ASSERT_TRUE_MESSAGE(parseAndCheck(gJson, fits), gJson.error());
+
+  const std::string over =
+      std::string(idk::JsonPull::kMaxDepth + 1, '[') + std::string(idk::JsonPull::kMaxDepth + 1, ']');
+  TEST_ASSERT_FALSE(parseAndCheck(gJson, over));
+  TEST_ASSERT_EQUAL_STRING("too deep", gJson.error());
+
+  TEST_ASSERT_FALSE(parseAndCheck(gJson, std::string(300, '{')));
+  TEST_ASSERT_EQUAL_STRING("expected key", gJson.error());
+  TEST_ASSERT_FALSE(parseAndCheck(gJson, std::string(300, '[')));
+  TEST_ASSERT_EQUAL_STRING("too deep", gJson.error());
+}
+
+void test_every_truncation_fails_cleanly() {
+  for (const char* line : kRecordedLines) {
+    const std::string full = line;
+    for (size_t len = 1; len < full.size(); ++len) {
+      // A prefix of a lone number is itself a number; everything else is cut
+      // mid-structure and must fail.
+      const bool ok = parseAndCheck(gJson, full.substr(0, len));
+      if (full[0] == '{' || full[0] == '[') {
+        TEST_ASSERT_FALSE(ok);
+      }
+    }
+  }
+}
+
+void test_random_mutations() {
+  const uint32_t iterations = fuzzIterations();
+  uint32_t parsed = 0;
+  for (uint32_t i = 0; i < iterations; ++i) {
+    const char* base = kRecordedLines[nextRandom() % (sizeof(kRecordedLines) / sizeof(kRecordedLines[0]))];
+    if (parseAndCheck(gJson, mutate(base))) {
+      parsed++;
+    }
+  }
+  char message[96];
+  snprintf(message, sizeof(message), "%lu of %lu mutated lines still parsed", static_cast<unsigned long>(parsed),
+           static_cast<unsigned long>(iterations));
+  TEST_MESSAGE(message);
+}
+
+void setup() {
+  UNITY_BEGIN();
+  if (!mapRegion()) {
+    TEST_MESSAGE("mmap guard page unavailable");
+    fflush(stdout);
+    _Exit(UNITY_END() + 1);
+  }
+  RUN_TEST(test_recorded_lines_parse);
+  RUN_TEST(test_number_at_end_of_buffer);
+  RUN_TEST(test_token_limit);
+  RUN_TEST(test_depth_limit);
+  RUN_TEST(test_every_truncation_fails_cleanly);
+  RUN_TEST(test_random_mutations);
+  const int failures = UNITY_END();
+  fflush(stdout);
+  _Exit(failures);
+}
+
+void loop() {}
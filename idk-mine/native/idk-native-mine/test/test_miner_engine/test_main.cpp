@@ -0,0 +1,190 @@
+#include <Arduino.h>
+#include <unity.h>
+
+#include <set>
+#include <utility>
+
+#include "miner/batch_tuner.h"
+#include "miner/miner_engine.h"
+#include "miner/nonce_range.h"
+#include "miner/sha256.h"
+
+#include "host_fixtures.h"
+
+// MinerEngine on the host shim: publish a job, claim nonces, and check every
+// share it queues against a plain sha256d of the header it claims to be from.
+
+namespace {
+
+constexpr uint32_t kTarget32 = 0x0000FFFFu;
+constexpr uint32_t kRunMs = 400;
+
+// Workers outlive stop() on the host (their threads are detached), so the
+// engine must too.
+idk::MinerEngine gEngine;
+
+idk::StratumJob makeJob(uint32_t workId) {
+  idk::StratumJob job{};
+  snprintf(job.jobId, sizeof(job.jobId), "job-%lu", static_cast<unsigned long>(workId));
+  job.workId = workId;
+  job.target32 = kTarget32;
+  for (size_t i = 0; i < sizeof(job.header); ++i) {
+    job.header[i] = static_cast<uint8_t>(i * 7 + workId);
+  }
+  memset(job.header + 76, 0, 4);
+  return job;
+}
+
+uint32_t referenceTop32(const uint8_t header[80], uint32_t nonce) {
+  uint8_t block[80];
+  memcpy(block, header, sizeof(block));
+  block[76] = static_cast<uint8_t>(nonce);
+  block[77] = static_cast<uint8_t>(nonce >> 8);
+  block[78] = static_cast<uint8_t>(nonce >> 16);
+  block[79] = static_cast<uint8_t>(nonce >> 24);
+  uint8_t digest[32];
+  idk::sha256d(block, sizeof(block), digest);
+  return static_cast<uint32_t>(digest[28]) | (static_cast<uint32_t>(digest[29]) << 8) |
+         (static_cast<uint32_t>(digest[30]) << 16) | (static_cast<uint32_t>(digest[31]) << 24);
+}
+
+// Drains the share queue for `ms`, checking each candidate against the job it
+// names (and, when `expectWorkId` is set, that it is that job). Returns how
+// many were checked.
+size_t drainAndVerify(const idk::StratumJob* jobs, size_t jobCount, uint32_t ms, uint32_t expectWorkId,
+                      std::set<std::pair<uint32_t, uint32_t>>& seen) {
+  size_t checked = 0;
+  const uint32_t start = millis();
+  idk::ShareCandidate shares[idk::ShareQueue::kCapacity];
+  while (millis() - start < ms) {
+    const size_t n = gEngine.takeShareCandidates(shares, idk::ShareQueue::kCapacity);
+    for (size_t i = 0; i < n; ++i) {
+      const idk::StratumJob* job = nullptr;
+      for (size_t j = 0; j < jobCount; ++j) {
+        if (jobs[j].workId == shares[i].workId) {
+          job = &jobs[j];
+        }
+      }
+      TEST_ASSERT_NOT_NULL_MESSAGE(job, "share names a work id that was never published");
+      if (expectWorkId != 0) {
+        TEST_ASSERT_EQUAL_UINT32(expectWorkId, shares[i].workId);
+      }
+      TEST_ASSERT_EQUAL_HEX32(referenceTop32(job->header, shares[i].nonce), shares[i].hash32);
+      TEST_ASSERT_TRUE(shares[i].hash32 <= kTarget32);
+      TEST_ASSERT_TRUE_MESSAGE(seen.insert({shares[i].workId, shares[i].nonce}).second, "nonce hashed twice");
+      ++checked;
+    }
+    delay(5);
+  }
+  return checked;
+}
+
+}  // namespace
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_allocator_hands_out_disjoint_slices() {
+  idk::NonceRangeAllocator allocator;
+  allocator.reset(4);
+
+  uint32_t start = 0;
+  uint32_t claimed = 0;
+  TEST_ASSERT_TRUE(allocator.claim(4, 1024, start, claimed));
+  TEST_ASSERT_EQUAL_UINT32(0, start);
+  TEST_ASSERT_EQUAL_UINT32(1024, claimed);
+  TEST_ASSERT_TRUE(allocator.claim(4, 256, start, claimed));
+  TEST_ASSERT_EQUAL_UINT32(1024, start);
+  TEST_ASSERT_EQUAL_UINT32(256, claimed);
+  TEST_ASSERT_FALSE(allocator.exhausted());
+  TEST_ASSERT_TRUE(allocator.coverage() > 0.0f);
+}
+
+void test_allocator_rejects_the_previous_tenant() {
+  // Generations 4 and 6 share a slot; a worker that loaded 4 must not take
+  // nonces once the slot was reset for 6.
+  idk::NonceRangeAllocator allocator;
+  allocator.reset(4);
+  allocator.reset(6);
+
+  uint32_t start = 0;
+  uint32_t claimed = 0;
+  TEST_ASSERT_FALSE(allocator.claim(4, 1024, start, claimed));
+  TEST_ASSERT_TRUE(allocator.claim(6, 1024, start, claimed));
+  TEST_ASSERT_EQUAL_UINT32(0, start);
+}
+
+void test_engine_shares_match_reference_hash() {
+  idk::RuntimeConfig cfg = idk_test::makeHostConfig();
+  cfg.minerBatchSize = 256;
+  cfg.mineTarget32 = kTarget32;
+  gEngine.begin(cfg, idk::MinerMode::Mine, idk::MinerTuning{});
+  TEST_ASSERT_EQUAL_UINT8(2, gEngine.workerCount());
+
+  idk::StratumJob jobs[2] = {makeJob(1), makeJob(2)};
+  std::set<std::pair<uint32_t, uint32_t>> seen;
+
+  gEngine.updateJob(jobs[0], kTarget32);
+  const size_t first = drainAndVerify(jobs, 2, kRunMs, 1, seen);
+  TEST_ASSERT_TRUE_MESSAGE(first > 0, "no shares on the first job");
+
+  gEngine.sampleCounters(millis());
+  TEST_ASSERT_TRUE(gEngine.totalHashes() > 0);
+  TEST_ASSERT_TRUE(gEngine.nonceCoverage() > 0.0f);
+
+  // After the switch, drain once to flush shares found on the old job, then
+  // only the new work id may appear.
+  gEngine.updateJob(jobs[1], kTarget32);
+  drainAndVerify(jobs, 2, 50, 0, seen);
+  const size_t second = drainAndVerify(jobs, 2, kRunMs, 2, seen);
+  TEST_ASSERT_TRUE_MESSAGE(second > 0, "no shares on the second job");
+  gEngine.sampleCounters(millis());
+  TEST_ASSERT_TRUE(gEngine.jobSwitchLatencyUs() > 0);
+
+  gEngine.stop();
+}
+
+void test_scrypt_batch_is_tunable() {
+  // Scrypt starts from its shortest batch whatever miner.batch_size says
+  // (that field is sized for SHA-256d), with or without the tuner.
+  idk::RuntimeConfig cfg = idk_test::makeHostConfig();
+  cfg.defaultCoin = idk::CoinType::LTC;
+  cfg.minerBatchSize = 1024;
+  gEngine.begin(cfg, idk::MinerMode::Mine, idk::MinerTuning{});
+  TEST_ASSERT_EQUAL_UINT16(idk::ScryptKernel::kMinBatch, gEngine.batchSize());
+  cfg.minerAutotune = true;
+  gEngine.begin(cfg, idk::MinerMode::Mine, idk::MinerTuning{});
+  TEST_ASSERT_EQUAL_UINT16(idk::ScryptKernel::kMinBatch, gEngine.batchSize());
+  gEngine.stop();
+
+  // The range has room to move: a rate that keeps rising with the batch walks
+  // the search to the top, and an IDLE gap past 16 holds it there.
+  idk::BatchTuner tuner;
+  tuner.begin(idk::ScryptKernel::kMinBatch, idk::ScryptKernel::kMaxBatch, idk::ScryptKernel::kMinBatch, 8, true);
+  for (int i = 0; i < 200 && !tuner.settled(); ++i) {
+    tuner.onSample(100.0f + tuner.batchSize(), 10);
+  }
+  TEST_ASSERT_TRUE(tuner.settled());
+  TEST_ASSERT_EQUAL_UINT16(64, tuner.batchSize());
+
+  tuner.begin(idk::ScryptKernel::kMinBatch, idk::ScryptKernel::kMaxBatch, idk::ScryptKernel::kMinBatch, 8, true);
+  for (int i = 0; i < 200 && !tuner.settled(); ++i) {
+    tuner.onSample(100.0f + tuner.batchSize(), tuner.batchSize() > 16 ? 500 : 10);
+  }
+  TEST_ASSERT_TRUE(tuner.settled());
+  TEST_ASSERT_EQUAL_UINT16(16, tuner.batchSize());
+}
+
+void setup() {
+  UNITY_BEGIN();
+  RUN_TEST(test_allocator_hands_out_disjoint_slices);
+  RUN_TEST(test_allocator_rejects_the_previous_tenant);
+  RUN_TEST(test_engine_shares_match_reference_hash);
+  RUN_TEST(test_scrypt_batch_is_tunable);
+  const int failures = UNITY_END();
+  fflush(stdout);
+  _Exit(failures);
+}
+
+void loop() {}
@@ -0,0 +1,256 @@
+#include <Arduino.h>
+#include <unity.h>
+
+#include <netinet/in.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "miner/miner_engine.h"
+#include "network/posix_transport.h"
+#include "network/stratum_client.h"
+
+#include "host_fixtures.h"
+
+// End to end against scripts/mock_stratum_server.py: StratumClient and a
+// two-worker MinerEngine wired like the network task, through a refused first
+// connection and a drop storm. Reports job-switch latency, share-accept
+// latency and reconnects, and checks the client's counters against the mock's
+// own summary. Ignored when python3 or the script is not there;
+// IDK_MOCK_POOL_SCRIPT overrides the path (relative to the project dir).
+
+namespace {
+
+constexpr char kDefaultScript[] = "../../scripts/mock_stratum_server.py";
+constexpr uint32_t kRunMs = 9000;
+constexpr uint32_t kStartTimeoutMs = 5000;
+
+// Workers outlive stop() on the host, so the engine must too.
+idk::MinerEngine gEngine;
+idk::StratumClient gClient;
+idk::PosixStratumTransport gTransport;
+idk::RuntimeConfig gConfig{};
+
+struct PoolSummary {
+  unsigned connections;
+  unsigned dropped;
+  unsigned jobs;
+  unsigned submits;
+  unsigned accepted;
+  unsigned rejected;
+  unsigned stale;
+  unsigned lowDiff;
+};
+
+uint16_t pickFreePort() {
+  const int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t len = sizeof(addr);
+  uint16_t port = 0;
+  if (fd >= 0 && bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0 &&
+      getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len) == 0) {
+    port = ntohs(addr.sin_port);
+  }
+  if (fd >= 0) {
+    ::close(fd);
+  }
+  return port;
+}
+
+std::string readFile(const char* path) {
+  std::string text;
+  FILE* fp = fopen(path, "rb");
+  if (fp == nullptr) {
+    return text;
+  }
+  char buf[512];
+  size_t n = 0;
+  while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) {
+    text.append(buf, n);
+  }
+  fclose(fp);
+  return text;
+}
+
+// Starts the mock with stdout and stderr in `logPath`. Returns its pid once it
+// is listening, or -1 (child reaped) if it never came up.
+pid_t startMockPool(const char* script, uint16_t port, const char* logPath) {
+  char portText[8];
+  snprintf(portText, sizeof(portText), "%u", static_cast<unsigned>(port));
+
+  const pid_t pid = fork();
+  if (pid == 0) {
+    FILE* log = freopen(logPath, "wb", stdout);
+    if (log != nullptr) {
+      dup2(fileno(log), STDERR_FILENO);
+    }
+    // A few shares a second at host hash rates, jobs every 2 s (every other one
+    // clean), every connection dropped every 3 s, and the very first one
+    // refused outright.
+    execlp("python3", "python3", script, "--port", portText, "--difficulty", "0.0001", "--job-interval", "2",
+           "--clean-every", "2", "--drop-every", "3", "--refuse-first", "1", "--seed", "7",
+           static_cast<char*>(nullptr));
+    _exit(127);
+  }
+  if (pid < 0) {
+    return -1;
+  }
+
+  const uint32_t start = millis();
+  while (millis() - start < kStartTimeoutMs) {
+    if (readFile(logPath).find("listening on") != std::string::npos) {
+      return pid;
+    }
+    int status = 0;
+    if (waitpid(pid, &status, WNOHANG) == pid) {
+      return -1;
+    }
+    delay(50);
+  }
+  kill(pid, SIGKILL);
+  waitpid(pid, nullptr, 0);
+  return -1;
+}
+
+bool stopMockPool(pid_t pid, const char* logPath, PoolSummary& out) {
+  kill(pid, SIGINT);
+  waitpid(pid, nullptr, 0);
+  const std::string log = readFile(logPath);
+  const size_t at = log.rfind("connections=");
+  return at != std::string::npos &&
+         sscanf(log.c_str() + at,
+                "connections=%u dropped=%u jobs=%u submits=%u accepted=%u rejected=%u stale=%u low_diff=%u",
+                &out.connections, &out.dropped, &out.jobs, &out.submits, &out.accepted, &out.rejected, &out.stale,
+                &out.lowDiff) == 8;
+}
+
+}  // namespace
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_mock_pool_end_to_end() {
+  const char* script = getenv("IDK_MOCK_POOL_SCRIPT");
+  if (script == nullptr) {
+    script = kDefaultScript;
+  }
+  if (access(script, R_OK) != 0) {
+    TEST_IGNORE_MESSAGE("mock_stratum_server.py not found; set IDK_MOCK_POOL_SCRIPT");
+  }
+
+  const uint16_t port = pickFreePort();
+  TEST_ASSERT_TRUE(port != 0);
+  char logPath[] = "/tmp/idk-mock-pool-XXXXXX";
+  const int logFd = mkstemp(logPath);
+  TEST_ASSERT_TRUE(logFd >= 0);
+  ::close(logFd);
+
+  const pid_t pid = startMockPool(script, port, logPath);
+  if (pid < 0) {
+    unlink(logPath);
+    TEST_IGNORE_MESSAGE("mock pool did not start (is python3 installed?)");
+  }
+
+  gConfig = idk_test::makeHostConfig("127.0.0.1", port);
+  strlcpy(gConfig.workerName, "e2e", sizeof(gConfig.workerName));
+  gConfig.minerBatchSize = 256;
+  gConfig.poolRetryMs = 250;
+  gClient.begin(&gConfig, &gTransport);
+  gClient.setCoin(idk::CoinType::BTC);
+  gClient.setIdentity(gConfig.btcWallet, gConfig.workerName, gConfig.minerName, gConfig.poolPassword);
+  gEngine.begin(gConfig, idk::MinerMode::Mine, idk::MinerTuning{});
+
+  // The network task's loop, minus telemetry.
+  uint32_t jobs = 0;
+  uint32_t lastSampleMs = 0;
+  const uint32_t start = millis();
+  while (millis() - start < kRunMs) {
+    const uint32_t now = millis();
+    gClient.loop(now, true);
+    if (gEngine.takeNonceSpaceExhausted()) {
+      gClient.rollJob();
+    }
+    idk::StratumJob job;
+    if (gClient.takeLatestJob(job)) {
+      gEngine.updateJob(job, gConfig.mineTarget32);
+      ++jobs;
+    }
+    idk::ShareCandidate shares[8];
+    const size_t count = gEngine.takeShareCandidates(shares, 8);
+    for (size_t i = 0; i < count; ++i) {
+      gClient.submitShare(shares[i].workId, shares[i].nonce);
+    }
+    if (now - lastSampleMs >= gConfig.telemetryIntervalMs) {
+      gEngine.sampleCounters(now);
+      lastSampleMs = now;
+    }
+    delay(2);
+  }
+  gEngine.sampleCounters(millis());
+  gEngine.stop();
+
+  PoolSummary pool{};
+  const bool summarized = stopMockPool(pid, logPath, pool);
+  if (!summarized) {
+    printf("%s\n", readFile(logPath).c_str());
+  }
+  unlink(logPath);
+
+  char report[256];
+  snprintf(report, sizeof(report),
+           "%.0f H/s; job switch: last %lu us, max %lu us over %lu jobs; share accept: avg %lu ms, max %lu ms "
+           "over %lu accepted",
+           static_cast<double>(gEngine.averageHashrate(idk::HashrateWindow::TenSeconds)),
+           static_cast<unsigned long>(gEngine.jobSwitchLatencyUs()),
+           static_cast<unsigned long>(gEngine.maxJobSwitchLatencyUs()), static_cast<unsigned long>(jobs),
+           static_cast<unsigned long>(gClient.averageShareLatencyMs()),
+           static_cast<unsigned long>(gClient.maxShareLatencyMs()),
+           static_cast<unsigned long>(gClient.acceptedShares()));
+  TEST_MESSAGE(report);
+  snprintf(report, sizeof(report),
+           "reconnects: %lu (pool saw %u connections, %u dropped); submitted %lu, rejected %lu, stale %lu, "
+           "timed out %lu",
+           static_cast<unsigned long>(gClient.reconnectCount()), pool.connections, pool.dropped,
+           static_cast<unsigned long>(gClient.submittedShares()),
+           static_cast<unsigned long>(gClient.rejectedShares()), static_cast<unsigned long>(gClient.staleShares()),
+           static_cast<unsigned long>(gClient.timedOutShares()));
+  TEST_MESSAGE(report);
+
+  TEST_ASSERT_TRUE_MESSAGE(summarized, "no stats summary from the mock pool");
+
+  // The refused connection and the storm each forced a reconnect, and the
+  // client came back with work every time.
+  TEST_ASSERT_TRUE(pool.dropped >= 1);
+  TEST_ASSERT_TRUE(pool.connections >= 3);
+  TEST_ASSERT_TRUE(gClient.reconnectCount() >= 2);
+  TEST_ASSERT_TRUE(jobs >= 3);
+
+  // Shares flowed, and the pool's tally agrees with the client's: it may have
+  // answered a few the client never heard back about (the drops), never the
+  // other way round. The mock rebuilds every submitted header and hashes it,
+  // so each share really met the difficulty it was sent for; stale job ids
+  // only race a clean job switch or drop.
+  TEST_ASSERT_TRUE(gClient.acceptedShares() > 0);
+  TEST_ASSERT_TRUE(pool.accepted >= gClient.acceptedShares());
+  TEST_ASSERT_TRUE(pool.rejected >= gClient.rejectedShares());
+  TEST_ASSERT_EQUAL_UINT(0, pool.lowDiff);
+  TEST_ASSERT_TRUE(pool.submits <= gClient.submittedShares());
+  TEST_ASSERT_TRUE(gClient.rejectedShares() * 4 <= gClient.acceptedShares());
+  TEST_ASSERT_TRUE(gEngine.maxJobSwitchLatencyUs() > 0);
+}
+
+void setup() {
+  UNITY_BEGIN();
+  RUN_TEST(test_mock_pool_end_to_end);
+  const int failures = UNITY_END();
+  fflush(stdout);
+  _Exit(failures);
+}
+
+void loop() {}
@@ -0,0 +1,250 @@
+#include <Arduino.h>
+#include <FS.h>
+#include <unity.h>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "config/runtime_config.h"
+
+// Runtime config parsing: built-in defaults, the compiled-in default JSON,
+// a runtime override merged on top of it, and the LittleFS file path.
+
+namespace {
+
+const char kDefaultsJson[] = R"json(
+{
+  "project_name": "idk-test",
+  "miner_name": "idk-native",
+  "worker_name": "unit",
+  "default_coin": "LTC",
+  "enable_ota": false,
+  "pool_password": "d=1",
+  "wallets": {"btc": "bc1qtestwallet", "ltc": "ltc1qtestwallet"},
+  "pool": {
+    "btc": [
+      {"host": "primary.example", "port": 4333, "tls": true},
+      {"host": "backup.example", "tls": false}
+    ],
+    "ltc": {"host": "ltc.example", "port": 3256}
+  },
+  "timing": {"telemetry_ms": 2000, "history_ms": 10000, "ui_ms": 250, "wifi_reconnect_ms": 7000,
+             "pool_retry_ms": 3000, "pool_probe_ms": 0, "keepalive_ms": 45000},
+  "miner": {"threads": 1, "batch_size": 512, "autotune": false, "lottery_target32": 4095, "mine_target32": 255},
+  "alerts": {"stack_free_bytes": 768, "heap_free_bytes": 20000}
+}
+)json";
+
+std::string gFsRoot;
+
+void writeFile(const char* name, const char* text) {
+  const std::string path = gFsRoot + name;
+  FILE* fp = fopen(path.c_str(), "wb");
+  TEST_ASSERT_NOT_NULL(fp);
+  fputs(text, fp);
+  fclose(fp);
+}
+
+}  // namespace
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_builtin_defaults_without_json() {
+  idk::RuntimeConfig cfg;
+  char err[96] = {0};
+  TEST_ASSERT_TRUE(idk::loadDefaultsFromJson(nullptr, cfg, err, sizeof(err)));
+
+  TEST_ASSERT_EQUAL_STRING("idk-mine", cfg.projectName);
+  TEST_ASSERT_TRUE(cfg.defaultCoin == idk::CoinType::BTC);
+  TEST_ASSERT_TRUE(cfg.enableOTA);
+  TEST_ASSERT_EQUAL_UINT8(1, cfg.btcPools.count);
+  TEST_ASSERT_EQUAL_STRING("public-pool.io", cfg.btcPools.endpoints[0].host);
+  TEST_ASSERT_EQUAL_UINT16(3333, cfg.btcPools.endpoints[0].port);
+  TEST_ASSERT_EQUAL_UINT8(2, cfg.minerThreads);
+  TEST_ASSERT_EQUAL_UINT16(1024, cfg.minerBatchSize);
+  TEST_ASSERT_EQUAL_UINT32(1000, cfg.telemetryIntervalMs);
+  TEST_ASSERT_EQUAL_UINT32(5000, cfg.historyIntervalMs);
+  TEST_ASSERT_EQUAL_UINT32(512, cfg.stackAlertBytes);
+  TEST_ASSERT_EQUAL_STRING("x", cfg.poolPassword);
+}
+
+void test_default_json_fills_every_section() {
+  idk::RuntimeConfig cfg;
+  char err[96] = {0};
+  TEST_ASSERT_TRUE_MESSAGE(idk::loadDefaultsFromJson(kDefaultsJson, cfg, err, sizeof(err)), err);
+
+  TEST_ASSERT_EQUAL_STRING("idk-test", cfg.projectName);
+  TEST_ASSERT_EQUAL_STRING("unit", cfg.workerName);
+  TEST_ASSERT_TRUE(cfg.defaultCoin == idk::CoinType::LTC);
+  TEST_ASSERT_FALSE(cfg.enableOTA);
+  TEST_ASSERT_EQUAL_STRING("d=1", cfg.poolPassword);
+  TEST_ASSERT_EQUAL_STRING("ltc1qtestwallet", idk::walletForCoin(cfg, idk::CoinType::LTC));
+
+  // An array replaces the list in order; a missing port means 3333.
+  TEST_ASSERT_EQUAL_UINT8(2, cfg.btcPools.count);
+  TEST_ASSERT_EQUAL_STRING("primary.example", cfg.btcPools.endpoints[0].host);
+  TEST_ASSERT_EQUAL_UINT16(4333, cfg.btcPools.endpoints[0].port);
+  TEST_ASSERT_TRUE(cfg.btcPools.endpoints[0].tls);
+  TEST_ASSERT_EQUAL_STRING("backup.example", cfg.btcPools.endpoints[1].host);
+  TEST_ASSERT_EQUAL_UINT16(3333, cfg.btcPools.endpoints[1].port);
+  TEST_ASSERT_FALSE(cfg.btcPools.endpoints[1].tls);
+
+  // An object overrides the primary endpoint only.
+  const idk::PoolListConfig& ltc = idk::poolsForCoin(cfg, idk::CoinType::LTC);
+  TEST_ASSERT_EQUAL_UINT8(1, ltc.count);
+  TEST_ASSERT_EQUAL_STRING("ltc.example", ltc.endpoints[0].host);
+  TEST_ASSERT_EQUAL_UINT16(3256, ltc.endpoints[0].port);
+
+  TEST_ASSERT_EQUAL_UINT32(2000, cfg.telemetryIntervalMs);
+  TEST_ASSERT_EQUAL_UINT32(10000, cfg.historyIntervalMs);
+  TEST_ASSERT_EQUAL_UINT32(250, cfg.uiUpdateMs);
+  TEST_ASSERT_EQUAL_UINT32(7000, cfg.wifiReconnectMs);
+  TEST_ASSERT_EQUAL_UINT32(3000, cfg.poolRetryMs);
+  TEST_ASSERT_EQUAL_UINT32(0, cfg.poolProbeMs);
+  TEST_ASSERT_EQUAL_UINT32(45000, cfg.keepAliveMs);
+  TEST_ASSERT_EQUAL_UINT8(1, cfg.minerThreads);
+  TEST_ASSERT_EQUAL_UINT16(512, cfg.minerBatchSize);
+  TEST_ASSERT_FALSE(cfg.minerAutotune);
+  TEST_ASSERT_EQUAL_UINT32(4095, cfg.lotteryTarget32);
+  TEST_ASSERT_EQUAL_UINT32(255, cfg.mineTarget32);
+  TEST_ASSERT_EQUAL_UINT32(768, cfg.stackAlertBytes);
+  TEST_ASSERT_EQUAL_UINT32(20000, cfg.heapAlertBytes);
+}
+
+void test_runtime_override_only_touches_its_keys() {
+  idk::RuntimeConfig cfg;
+  char err[96] = {0};
+  TEST_ASSERT_TRUE(idk::loadDefaultsFromJson(kDefaultsJson, cfg, err, sizeof(err)));
+
+  const char overrideJson[] = R"json(
+{
+  "worker_name": "rig-2",
+  "pool": {"btc": {"host": "override.example"}},
+  "timing": {"ui_ms": 500},
+  "miner": {"autotune": true}
+}
+)json";
+  TEST_ASSERT_TRUE_MESSAGE(idk::mergeFromJson(overrideJson, cfg, err, sizeof(err)), err);
+
+  TEST_ASSERT_EQUAL_STRING("rig-2", cfg.workerName);
+  TEST_ASSERT_EQUAL_STRING("idk-test", cfg.projectName);
+  // The primary host changes, its port and TLS flag and the backup stay.
+  TEST_ASSERT_EQUAL_UINT8(2, cfg.btcPools.count);
+  TEST_ASSERT_EQUAL_STRING("override.example", cfg.btcPools.endpoints[0].host);
+  TEST_ASSERT_EQUAL_UINT16(4333, cfg.btcPools.endpoints[0].port);
+  TEST_ASSERT_TRUE(cfg.btcPools.endpoints[0].tls);
+  TEST_ASSERT_EQUAL_STRING("backup.example", cfg.btcPools.endpoints[1].host);
+  TEST_ASSERT_EQUAL_UINT32(500, cfg.uiUpdateMs);
+  TEST_ASSERT_EQUAL_UINT32(2000, cfg.telemetryIntervalMs);
+  TEST_ASSERT_TRUE(cfg.minerAutotune);
+  TEST_ASSERT_EQUAL_UINT16(512, cfg.minerBatchSize);
+}
+
+void test_pool_list_is_capped_and_skips_hostless_entries() {
+  idk::RuntimeConfig cfg;
+  char err[96] = {0};
+  const char json[] = R"json(
+{"pool": {"btc": [{"host": "a"}, {"port": 1}, {"host": "b"}, {"host": "c"}, {"host": "d"}, {"host": "e"}]}}
+)json";
+  TEST_ASSERT_TRUE_MESSAGE(idk::loadDefaultsFromJson(json, cfg, err, sizeof(err)), err);
+
+  TEST_ASSERT_EQUAL_UINT8(idk::kMaxPoolEndpoints, cfg.btcPools.count);
+  TEST_ASSERT_EQUAL_STRING("a", cfg.btcPools.endpoints[0].host);
+  TEST_ASSERT_EQUAL_STRING("b", cfg.btcPools.endpoints[1].host);
+  TEST_ASSERT_EQUAL_STRING("d", cfg.btcPools.endpoints[3].host);
+}
+
+void test_pin_sha256_accepts_colons_and_rejects_short_pins() {
+  idk::RuntimeConfig cfg;
+  char err[96] = {0};
+  const char pinned[] = R"json(
+{"pool": {"btc": {"host": "tls.example", "tls": true,
+  "pin_sha256": "00:11:22:33:44:55:66:77:88:99:aa:bb:cc:dd:ee:ff:00:11:22:33:44:55:66:77:88:99:AA:BB:CC:DD:EE:FF"}}}
+)json";
+  TEST_ASSERT_TRUE_MESSAGE(idk::loadDefaultsFromJson(pinned, cfg, err, sizeof(err)), err);
+
+  const idk::PoolEndpointConfig& endpoint = cfg.btcPools.endpoints[0];
+  TEST_ASSERT_TRUE(endpoint.pinned);
+  TEST_ASSERT_EQUAL_HEX8(0x00, endpoint.pinSha256[0]);
+  TEST_ASSERT_EQUAL_HEX8(0x11, endpoint.pinSha256[1]);
+  TEST_ASSERT_EQUAL_HEX8(0xAA, endpoint.pinSha256[26]);
+  TEST_ASSERT_EQUAL_HEX8(0xFF, endpoint.pinSha256[31]);
+
+  const char shortPin[] = R"json({"pool": {"btc": {"host": "tls.example", "pin_sha256": "0011"}}})json";
+  TEST_ASSERT_FALSE(idk::loadDefaultsFromJson(shortPin, cfg, err, sizeof(err)));
+  TEST_ASSERT_NOT_NULL(strstr(err, "pin_sha256"));
+}
+
+void test_invalid_input_is_reported() {
+  idk::RuntimeConfig cfg;
+  char err[96] = {0};
+  TEST_ASSERT_FALSE(idk::loadDefaultsFromJson(R"json({"default_coin": "DOGE"})json", cfg, err, sizeof(err)));
+  TEST_ASSERT_NOT_NULL(strstr(err, "default_coin"));
+
+  err[0] = '\0';
+  TEST_ASSERT_FALSE(idk::mergeFromJson("{\"worker_name\": ", cfg, err, sizeof(err)));
+  TEST_ASSERT_NOT_NULL(strstr(err, "json parse failed"));
+}
+
+void test_miner_values_are_clamped() {
+  idk::RuntimeConfig cfg;
+  char err[96] = {0};
+  TEST_ASSERT_TRUE(idk::loadDefaultsFromJson(R"json({"miner": {"threads": 9, "batch_size": 8}})json", cfg, err,
+                                             sizeof(err)));
+  TEST_ASSERT_EQUAL_UINT8(2, cfg.minerThreads);
+  TEST_ASSERT_EQUAL_UINT16(32, cfg.minerBatchSize);
+
+  TEST_ASSERT_TRUE(idk::mergeFromJson(R"json({"miner": {"batch_size": 60000}})json", cfg, err, sizeof(err)));
+  TEST_ASSERT_EQUAL_UINT16(4096, cfg.minerBatchSize);
+}
+
+void test_merge_from_file() {
+  fs::FS files(gFsRoot.c_str());
+  idk::RuntimeConfig cfg;
+  char err[96] = {0};
+  TEST_ASSERT_TRUE(idk::loadDefaultsFromJson(kDefaultsJson, cfg, err, sizeof(err)));
+
+  TEST_ASSERT_FALSE(idk::mergeFromFile(files, "/missing.json", cfg, err, sizeof(err)));
+  TEST_ASSERT_NOT_NULL(strstr(err, "not found"));
+
+  writeFile("/runtime_config.json", R"json({"default_coin": "BTC", "wallets": {"btc": "bc1qfromfile"}})json");
+  TEST_ASSERT_TRUE_MESSAGE(idk::mergeFromFile(files, "/runtime_config.json", cfg, err, sizeof(err)), err);
+  TEST_ASSERT_TRUE(cfg.defaultCoin == idk::CoinType::BTC);
+  TEST_ASSERT_EQUAL_STRING("bc1qfromfile", cfg.btcWallet);
+  TEST_ASSERT_EQUAL_STRING("ltc1qtestwallet", cfg.ltcWallet);
+
+  writeFile("/empty.json", "");
+  TEST_ASSERT_FALSE(idk::mergeFromFile(files, "/empty.json", cfg, err, sizeof(err)));
+  TEST_ASSERT_NOT_NULL(strstr(err, "invalid config size"));
+}
+
+void setup() {
+  char root[] = "/tmp/idk-config-test-XXXXXX";
+  if (mkdtemp(root) != nullptr) {
+    gFsRoot = root;
+  }
+
+  UNITY_BEGIN();
+  RUN_TEST(test_builtin_defaults_without_json);
+  RUN_TEST(test_default_json_fills_every_section);
+  RUN_TEST(test_runtime_override_only_touches_its_keys);
+  RUN_TEST(test_pool_list_is_capped_and_skips_hostless_entries);
+  RUN_TEST(test_pin_sha256_accepts_colons_and_rejects_short_pins);
+  RUN_TEST(test_invalid_input_is_reported);
+  RUN_TEST(test_miner_values_are_clamped);
+  RUN_TEST(test_merge_from_file);
+  const int failures = UNITY_END();
+
+  for (const char* name : {"/runtime_config.json", "/empty.json"}) {
+    unlink((gFsRoot + name).c_str());
+  }
+  rmdir(gFsRoot.c_str());
+  fflush(stdout);
+  _Exit(failures);
+}
+
+void loop() {}
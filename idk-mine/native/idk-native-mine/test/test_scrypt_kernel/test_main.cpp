@@ -0,0 +1,189 @@
+#include <Arduino.h>
+#include <unity.h>
+
+#include "miner/hash_kernel.h"
+#include "miner/scrypt.h"
+
+// scrypt(N=1024, r=1, p=1) over 80-byte headers against vectors computed
+// with hashlib.scrypt(header, salt=header, n=1024, r=1, p=1, dklen=32),
+// anchored on the Litecoin genesis block, and a V array split across
+// scattered segments against the same array in one piece.
+
+namespace {
+
+// Litecoin genesis block header fields; hashes are in the byte order block
+// explorers show (reversed from the digest).
+constexpr uint32_t kGenesisVersion = 1;
+constexpr char kGenesisMerkleRoot[] = "97ddfbbae6be97fd6cdf3e7ca13232a3afff2353e29badfab7f73011edd4ced9";
+constexpr uint32_t kGenesisTime = 1317972665u;
+constexpr uint32_t kGenesisBits = 0x1E0FFFF0u;
+constexpr uint32_t kGenesisNonce = 2084524493u;
+constexpr char kGenesisPowHash[] = "0000050c34a64b415b6b15b37f2216634b5b1669cb9a2e38d76f7213b0671e00";
+// The same header one nonce later, in digest byte order.
+constexpr char kGenesisNextNonceDigest[] = "f9781b539c408602b33bc5bd0f1e400166d1e36261ec664d0409107e78c82301";
+
+constexpr size_t kSegmentWords = idk::kScryptSegmentBytes / sizeof(uint32_t);
+
+// One 128 KiB V array, and the same size as four separate blocks.
+uint32_t gContiguous[idk::kScryptSegmentCount * kSegmentWords];
+uint32_t gSegments[idk::kScryptSegmentCount][kSegmentWords];
+
+void putLe32(uint8_t* out, uint32_t v) {
+  out[0] = static_cast<uint8_t>(v);
+  out[1] = static_cast<uint8_t>(v >> 8);
+  out[2] = static_cast<uint8_t>(v >> 16);
+  out[3] = static_cast<uint8_t>(v >> 24);
+}
+
+uint32_t getLe32(const uint8_t* in) {
+  return static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8) | (static_cast<uint32_t>(in[2]) << 16) |
+         (static_cast<uint32_t>(in[3]) << 24);
+}
+
+void hexToBytes(const char* hex, uint8_t out[32]) {
+  for (size_t i = 0; i < 32; ++i) {
+    unsigned byte = 0;
+    sscanf(hex + (i * 2), "%2x", &byte);
+    out[i] = static_cast<uint8_t>(byte);
+  }
+}
+
+// Hex in display order into internal (reversed) byte order.
+void displayHexToBytes(const char* hex, uint8_t out[32]) {
+  uint8_t bytes[32];
+  hexToBytes(hex, bytes);
+  for (size_t i = 0; i < 32; ++i) {
+    out[31 - i] = bytes[i];
+  }
+}
+
+void makeGenesisHeader(uint8_t header[80]) {
+  memset(header, 0, 80);
+  putLe32(header, kGenesisVersion);
+  displayHexToBytes(kGenesisMerkleRoot, header + 36);
+  putLe32(header + 68, kGenesisTime);
+  putLe32(header + 72, kGenesisBits);
+  putLe32(header + 76, kGenesisNonce);
+}
+
+// A header with no structure, so every message word is exercised.
+void makeNoiseHeader(uint8_t header[80], uint32_t seed) {
+  uint32_t x = seed * 2654435761u + 1;
+  for (size_t i = 0; i < 80; ++i) {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    header[i] = static_cast<uint8_t>(x);
+  }
+}
+
+idk::ScryptScratchpad contiguousScratchpad() {
+  idk::ScryptScratchpad scratchpad{};
+  for (uint8_t s = 0; s < idk::kScryptSegmentCount; ++s) {
+    scratchpad.segments[s] = gContiguous + (s * kSegmentWords);
+  }
+  return scratchpad;
+}
+
+// Segments in reverse address order, so nothing can lean on one segment
+// following another in memory.
+idk::ScryptScratchpad scatteredScratchpad() {
+  idk::ScryptScratchpad scratchpad{};
+  for (uint8_t s = 0; s < idk::kScryptSegmentCount; ++s) {
+    scratchpad.segments[s] = gSegments[idk::kScryptSegmentCount - 1 - s];
+  }
+  return scratchpad;
+}
+
+}  // namespace
+
+void setUp() {
+  // Leftovers from the previous hash must not matter.
+  memset(gContiguous, 0xA5, sizeof(gContiguous));
+  memset(gSegments, 0x5A, sizeof(gSegments));
+}
+
+void tearDown() {}
+
+void test_litecoin_genesis_pow_hash() {
+  uint8_t header[80];
+  makeGenesisHeader(header);
+  uint8_t expected[32];
+  displayHexToBytes(kGenesisPowHash, expected);
+
+  idk::ScryptHeaderJob job;
+  idk::scryptPrepareHeader(header, job);
+  const idk::ScryptScratchpad scratchpad = contiguousScratchpad();
+  uint8_t digest[32];
+  idk::scryptHashHeader(job, kGenesisNonce, scratchpad, digest);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, digest, 32);
+  TEST_ASSERT_EQUAL_HEX32(0x0000050Cu, idk::scryptHeaderTop32(job, kGenesisNonce, scratchpad));
+}
+
+void test_nonce_replaces_the_header_nonce() {
+  uint8_t header[80];
+  makeGenesisHeader(header);
+  uint8_t expected[32];
+  hexToBytes(kGenesisNextNonceDigest, expected);
+
+  idk::ScryptHeaderJob job;
+  idk::scryptPrepareHeader(header, job);
+  uint8_t digest[32];
+  idk::scryptHashHeader(job, kGenesisNonce + 1, contiguousScratchpad(), digest);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, digest, 32);
+}
+
+void test_segmented_matches_contiguous() {
+  const idk::ScryptScratchpad contiguous = contiguousScratchpad();
+  const idk::ScryptScratchpad scattered = scatteredScratchpad();
+  const uint32_t nonces[4] = {0, 1, 0x80000000u, 0xFFFFFFFFu};
+
+  for (uint32_t seed = 1; seed <= 4; ++seed) {
+    uint8_t header[80];
+    makeNoiseHeader(header, seed);
+    idk::ScryptHeaderJob job;
+    idk::scryptPrepareHeader(header, job);
+
+    for (uint32_t nonce : nonces) {
+      uint8_t expected[32];
+      uint8_t digest[32];
+      idk::scryptHashHeader(job, nonce, contiguous, expected);
+      idk::scryptHashHeader(job, nonce, scattered, digest);
+      TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, digest, 32);
+      TEST_ASSERT_EQUAL_HEX32(getLe32(expected + 28), idk::scryptHeaderTop32(job, nonce, scattered));
+    }
+  }
+}
+
+void test_kernel_matches_scrypt() {
+  uint8_t header[80];
+  makeGenesisHeader(header);
+
+  idk::ScryptKernel::Job job;
+  idk::ScryptKernel::Context context = scatteredScratchpad();
+  idk::ScryptKernel::prepare(header, job);
+
+  const uint32_t nonce = kGenesisNonce;
+  uint32_t top32 = 0;
+  idk::ScryptKernel::hashLanes(job, context, &nonce, &top32);
+  TEST_ASSERT_EQUAL_HEX32(0x0000050Cu, top32);
+
+  uint8_t expected[32];
+  displayHexToBytes(kGenesisPowHash, expected);
+  uint8_t digest[32];
+  idk::ScryptKernel::hashDigest(job, context, nonce, digest);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, digest, 32);
+}
+
+void setup() {
+  UNITY_BEGIN();
+  RUN_TEST(test_litecoin_genesis_pow_hash);
+  RUN_TEST(test_nonce_replaces_the_header_nonce);
+  RUN_TEST(test_segmented_matches_contiguous);
+  RUN_TEST(test_kernel_matches_scrypt);
+  const int failures = UNITY_END();
+  fflush(stdout);
+  _Exit(failures);
+}
+
+void loop() {}
@@ -0,0 +1,195 @@
+#include <Arduino.h>
+#include <unity.h>
+
+#include "miner/hash_kernel.h"
+#include "miner/sha256.h"
+
+// The SHA-256d kernel at 1, 2 and 4 lanes against a plain sha256d of the
+// whole header: the top-word early exit (last outer rounds skipped) and the
+// full digest used for target ties, anchored on the Bitcoin genesis block.
+
+namespace {
+
+// Genesis block header fields; hashes are in the byte order block explorers
+// show (reversed from the digest).
+constexpr uint32_t kGenesisVersion = 1;
+constexpr char kGenesisMerkleRoot[] = "4a5e1e4baab89f3a32518a88c31bc87f618f76673e2cc77ab2127b7afdeda33b";
+constexpr uint32_t kGenesisTime = 0x495FAB29u;
+constexpr uint32_t kGenesisBits = 0x1D00FFFFu;
+constexpr uint32_t kGenesisNonce = 2083236893u;
+constexpr char kGenesisHash[] = "000000000019d6689c085ae165831e934ff763ae46a2a6c172b3f1b60a8ce26f";
+
+void putLe32(uint8_t* out, uint32_t v) {
+  out[0] = static_cast<uint8_t>(v);
+  out[1] = static_cast<uint8_t>(v >> 8);
+  out[2] = static_cast<uint8_t>(v >> 16);
+  out[3] = static_cast<uint8_t>(v >> 24);
+}
+
+uint32_t getLe32(const uint8_t* in) {
+  return static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8) | (static_cast<uint32_t>(in[2]) << 16) |
+         (static_cast<uint32_t>(in[3]) << 24);
+}
+
+// Hex in display order into internal (reversed) byte order.
+void displayHexToBytes(const char* hex, uint8_t out[32]) {
+  for (size_t i = 0; i < 32; ++i) {
+    unsigned byte = 0;
+    sscanf(hex + (i * 2), "%2x", &byte);
+    out[31 - i] = static_cast<uint8_t>(byte);
+  }
+}
+
+void makeGenesisHeader(uint8_t header[80]) {
+  memset(header, 0, 80);
+  putLe32(header, kGenesisVersion);
+  displayHexToBytes(kGenesisMerkleRoot, header + 36);
+  putLe32(header + 68, kGenesisTime);
+  putLe32(header + 72, kGenesisBits);
+  putLe32(header + 76, kGenesisNonce);
+}
+
+// A header with no structure, so every message word is exercised.
+void makeNoiseHeader(uint8_t header[80], uint32_t seed) {
+  uint32_t x = seed * 2654435761u + 1;
+  for (size_t i = 0; i < 80; ++i) {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    header[i] = static_cast<uint8_t>(x);
+  }
+}
+
+void referenceDigest(const uint8_t header[80], uint32_t nonce, uint8_t digest[32]) {
+  uint8_t block[80];
+  memcpy(block, header, sizeof(block));
+  putLe32(block + 76, nonce);
+  idk::sha256d(block, sizeof(block), digest);
+}
+
+// Hashes `count` nonces from `nonces` through the kernel `Lanes` at a time
+// and checks the top word and full digest of each against the reference.
+template <uint8_t Lanes>
+void checkKernel(const uint8_t header[80], const uint32_t* nonces, size_t count) {
+  using Kernel = idk::Sha256dLanesKernel<Lanes>;
+  typename Kernel::Job job;
+  typename Kernel::Context context;
+  Kernel::prepare(header, job);
+
+  for (size_t i = 0; i + Lanes <= count; i += Lanes) {
+    uint32_t top32[Lanes];
+    Kernel::hashLanes(job, context, nonces + i, top32);
+    for (uint8_t l = 0; l < Lanes; ++l) {
+      uint8_t expected[32];
+      referenceDigest(header, nonces[i + l], expected);
+      TEST_ASSERT_EQUAL_HEX32(getLe32(expected + 28), top32[l]);
+
+      uint8_t digest[32];
+      Kernel::hashDigest(job, context, nonces[i + l], digest);
+      TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, digest, 32);
+    }
+  }
+}
+
+template <uint8_t Lanes>
+void checkKernelOnNoise() {
+  // Lanes get unrelated nonces, including the ends of the range, so no lane
+  // can lean on its neighbour's value.
+  uint32_t nonces[64];
+  uint32_t x = 0x9E3779B9u;
+  for (size_t i = 0; i < 64; ++i) {
+    x = x * 1664525u + 1013904223u;
+    nonces[i] = x;
+  }
+  nonces[0] = 0;
+  nonces[1] = 0xFFFFFFFFu;
+  nonces[2] = 0x80000000u;
+  nonces[3] = 1;
+
+  for (uint32_t seed = 1; seed <= 8; ++seed) {
+    uint8_t header[80];
+    makeNoiseHeader(header, seed);
+    checkKernel<Lanes>(header, nonces, 64);
+  }
+}
+
+}  // namespace
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_sha256_known_answer() {
+  uint8_t digest[32];
+  idk::sha256(reinterpret_cast<const uint8_t*>("abc"), 3, digest);
+  const uint8_t expected[32] = {0xBA, 0x78, 0x16, 0xBF, 0x8F, 0x01, 0xCF, 0xEA, 0x41, 0x41, 0x40,
+                                0xDE, 0x5D, 0xAE, 0x22, 0x23, 0xB0, 0x03, 0x61, 0xA3, 0x96, 0x17,
+                                0x7A, 0x9C, 0xB4, 0x10, 0xFF, 0x61, 0xF2, 0x00, 0x15, 0xAD};
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, digest, 32);
+}
+
+void test_genesis_header_hash() {
+  uint8_t header[80];
+  makeGenesisHeader(header);
+  uint8_t expected[32];
+  displayHexToBytes(kGenesisHash, expected);
+
+  uint8_t digest[32];
+  idk::sha256d(header, sizeof(header), digest);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, digest, 32);
+
+  idk::Sha256dHeaderJob job;
+  idk::sha256dPrepareHeader(header, job);
+  idk::sha256dHashHeader(job, kGenesisNonce, digest);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, digest, 32);
+  // The block hash starts with 32 zero bits, so its top word is zero.
+  TEST_ASSERT_EQUAL_HEX32(0, idk::sha256dHeaderTop32(job, kGenesisNonce));
+  TEST_ASSERT_NOT_EQUAL(0, idk::sha256dHeaderTop32(job, kGenesisNonce + 1));
+}
+
+void test_genesis_through_each_lane() {
+  uint8_t header[80];
+  makeGenesisHeader(header);
+
+  // The winning nonce in every lane position, next to its neighbours.
+  const uint32_t nonces[8] = {kGenesisNonce,     kGenesisNonce - 1, kGenesisNonce + 1, kGenesisNonce,
+                              kGenesisNonce - 2, kGenesisNonce,     kGenesisNonce + 2, kGenesisNonce};
+  checkKernel<1>(header, nonces, 8);
+  checkKernel<2>(header, nonces, 8);
+  checkKernel<4>(header, nonces, 8);
+
+  idk::Sha256dLanesKernel<4>::Job job;
+  idk::Sha256dLanesKernel<4>::Context context;
+  idk::Sha256dLanesKernel<4>::prepare(header, job);
+  uint32_t top32[4];
+  idk::Sha256dLanesKernel<4>::hashLanes(job, context, nonces, top32);
+  TEST_ASSERT_EQUAL_HEX32(0, top32[0]);
+  TEST_ASSERT_EQUAL_HEX32(0, top32[3]);
+}
+
+void test_one_lane_matches_reference() {
+  checkKernelOnNoise<1>();
+}
+
+void test_two_lanes_match_reference() {
+  checkKernelOnNoise<2>();
+}
+
+void test_four_lanes_match_reference() {
+  checkKernelOnNoise<4>();
+}
+
+void setup() {
+  UNITY_BEGIN();
+  RUN_TEST(test_sha256_known_answer);
+  RUN_TEST(test_genesis_header_hash);
+  RUN_TEST(test_genesis_through_each_lane);
+  RUN_TEST(test_one_lane_matches_reference);
+  RUN_TEST(test_two_lanes_match_reference);
+  RUN_TEST(test_four_lanes_match_reference);
+  const int failures = UNITY_END();
+  fflush(stdout);
+  _Exit(failures);
+}
+
+void loop() {}
@@ -0,0 +1,297 @@
+#include <Arduino.h>
+#include <unity.h>
+
+#include <string>
+
+#include "miner/sha256.h"
+#include "network/stratum_client.h"
+#include "network/stratum_job.h"
+
+#include "host_fixtures.h"
+
+// Job building from mining.notify: the genesis block's coinbase split the way
+// a pool would send it, and a subscribe/notify pair captured from
+// scripts/mock_stratum_server.py (--seed 7 --branches 3) replayed through
+// StratumClient. Expected hashes were computed independently with Python's
+// hashlib.
+
+namespace {
+
+// Genesis coinbase split around a zero extranonce1 and extranonce2 (4 bytes
+// each).
+constexpr char kGenesisCoinb1[] = "010000000100000000000000000000000000000000";
+constexpr char kGenesisCoinb2[] =
+    "0000000000000000ffffffff4d04ffff001d0104455468652054696d65732030332f4a616e2f32303039204368616e63656c6c6f72206f"
+    "6e206272696e6b206f66207365636f6e64206261696c6f757420666f722062616e6b73ffffffff0100f2052a0100000043410467"
+    "8afdb0fe5548271967f1a67130b7105cd6a828e03909a67962e0ea1f61deb649f6bc3f4cef38c4f35504e51ec112de5c384df7ba0b"
+    "8d578a4c702b6bf11d5fac00000000";
+constexpr char kGenesisPrevHash[] = "0000000000000000000000000000000000000000000000000000000000000000";
+constexpr char kGenesisTxid[] = "4a5e1e4baab89f3a32518a88c31bc87f618f76673e2cc77ab2127b7afdeda33b";
+constexpr uint32_t kGenesisNonce = 2083236893u;
+constexpr char kGenesisHash[] = "000000000019d6689c085ae165831e934ff763ae46a2a6c172b3f1b60a8ce26f";
+
+// Captured from the mock pool.
+constexpr char kCapturedExtranonce1[] = "c75fd489";
+constexpr char kCapturedNotify[] =
+    "{\"id\":null,\"method\":\"mining.notify\",\"params\":[\"1\","
+    "\"24d3e087bfe0c15f606db97836449852a44414f98f425301fb08affb3d64c11c\","
+    "\"01000000010000000000000000000000000000000000000000000000000000000000000000ffffffff20d7cf75fc1429c3ed\","
+    "\"ffffffff0100f2052a010000001976a914000000000000000000000000000000000000000088ac00000000\","
+    "[\"ec281a3fd6059c526ee46c08f741390a4ad3f4d68197989527a93fb3aa507b9f\","
+    "\"c1467dc3a5518ea6089192101a1186d0209d0bfd060af53ad0453637d1374267\","
+    "\"ffc18537e977c1b0f5adb0f4421efa76baa1c4081837494a98349592b8fb948c\"],"
+    "\"20000000\",\"1d00ffff\",\"6ad1eb15\",true]}\n";
+
+// Coinbase hash and merkle root in digest byte order, and the nonce-zero
+// header, for extranonce2 0 and 1.
+constexpr char kCapturedCoinbaseHash[2][65] = {
+    "42f5eac1d6d254ce2e56eec9620daa10ebbb51e51eacba3d5814b1a3ae30db9e",
+    "146f2f6b989fbd5b7e5f2e7b2d8f2498f73bdb94302da409f08d5f41049d7a61",
+};
+constexpr char kCapturedMerkleRoot[2][65] = {
+    "ee45930d217d51024fbf08c85f42e2d0a10c00fcf43ba66d04e02489e5f6a590",
+    "b199da58dc2985d88a644b16a9429243ce5e50506092ea0b94b04e88327d7406",
+};
+constexpr char kCapturedHeader[2][161] = {
+    "0000002087e0d3245fc1e0bf78b96d6052984436f91444a40153428ffbaf08fb1cc1643dee45930d217d51024fbf08c85f42e2d0a10c00fc"
+    "f43ba66d04e02489e5f6a59015ebd16affff001d00000000",
+    "0000002087e0d3245fc1e0bf78b96d6052984436f91444a40153428ffbaf08fb1cc1643db199da58dc2985d88a644b16a9429243ce5e5050"
+    "6092ea0b94b04e88327d740615ebd16affff001d00000000",
+};
+
+void hexToBytes(const char* hex, uint8_t* out, size_t len) {
+  for (size_t i = 0; i < len; ++i) {
+    unsigned byte = 0;
+    sscanf(hex + (i * 2), "%2x", &byte);
+    out[i] = static_cast<uint8_t>(byte);
+  }
+}
+
+void reversed(const uint8_t in[32], uint8_t out[32]) {
+  for (size_t i = 0; i < 32; ++i) {
+    out[i] = in[31 - i];
+  }
+}
+
+idk::StratumNotify makeCapturedNotify() {
+  idk::StratumNotify notify{};
+  notify.jobId = "1";
+  notify.prevHash = "24d3e087bfe0c15f606db97836449852a44414f98f425301fb08affb3d64c11c";
+  notify.coinb1 = "01000000010000000000000000000000000000000000000000000000000000000000000000ffffffff20d7cf75fc1429c3ed";
+  notify.coinb2 = "ffffffff0100f2052a010000001976a914000000000000000000000000000000000000000088ac00000000";
+  notify.merkleBranches[0] = "ec281a3fd6059c526ee46c08f741390a4ad3f4d68197989527a93fb3aa507b9f";
+  notify.merkleBranches[1] = "c1467dc3a5518ea6089192101a1186d0209d0bfd060af53ad0453637d1374267";
+  notify.merkleBranches[2] = "ffc18537e977c1b0f5adb0f4421efa76baa1c4081837494a98349592b8fb948c";
+  notify.merkleBranchCount = 3;
+  notify.version = "20000000";
+  notify.nbits = "1d00ffff";
+  notify.ntime = "6ad1eb15";
+  notify.cleanJobs = true;
+  return notify;
+}
+
+idk::RuntimeConfig makeCapturedConfig() {
+  idk::RuntimeConfig cfg = idk_test::makeHostConfig("captured");
+  strlcpy(cfg.btcWallet, "bc1qtestwallet", sizeof(cfg.btcWallet));
+  return cfg;
+}
+
+}  // namespace
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_extranonce1_parse() {
+  idk::StratumSession session{};
+  TEST_ASSERT_TRUE(idk::parseStratumExtranonce1(kCapturedExtranonce1, session));
+  TEST_ASSERT_EQUAL_UINT8(4, session.extranonce1Size);
+  TEST_ASSERT_EQUAL_HEX8(0xC7, session.extranonce1[0]);
+  TEST_ASSERT_EQUAL_HEX8(0x89, session.extranonce1[3]);
+  TEST_ASSERT_FALSE(idk::parseStratumExtranonce1("c75fd48", session));
+  TEST_ASSERT_FALSE(idk::parseStratumExtranonce1("00112233445566778899", session));
+}
+
+void test_genesis_job_rebuilds_the_genesis_block() {
+  idk::StratumNotify notify{};
+  notify.jobId = "genesis";
+  notify.prevHash = kGenesisPrevHash;
+  notify.coinb1 = kGenesisCoinb1;
+  notify.coinb2 = kGenesisCoinb2;
+  notify.merkleBranchCount = 0;
+  notify.version = "00000001";
+  notify.nbits = "1d00ffff";
+  notify.ntime = "495fab29";
+  notify.cleanJobs = true;
+
+  idk::StratumSession session{};
+  TEST_ASSERT_TRUE(idk::parseStratumExtranonce1("00000000", session));
+  session.extranonce2Size = 4;
+
+  static idk::StratumJobTemplate tmpl;
+  char err[64] = {0};
+  TEST_ASSERT_TRUE_MESSAGE(idk::buildStratumJobTemplate(notify, session, tmpl, err, sizeof(err)), err);
+  TEST_ASSERT_EQUAL_UINT16(204, tmpl.coinbaseLen);
+  TEST_ASSERT_EQUAL_UINT16(25, tmpl.extranonce2Offset);
+
+  uint8_t header[80];
+  idk::buildStratumHeader(tmpl, 0, header);
+
+  // No branches: the merkle root is the coinbase txid.
+  uint8_t txid[32];
+  uint8_t expected[32];
+  idk::sha256d(tmpl.coinbase, tmpl.coinbaseLen, txid);
+  hexToBytes(kGenesisTxid, expected, 32);
+  uint8_t display[32];
+  reversed(txid, display);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, display, 32);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(txid, header + 36, 32);
+
+  header[76] = static_cast<uint8_t>(kGenesisNonce);
+  header[77] = static_cast<uint8_t>(kGenesisNonce >> 8);
+  header[78] = static_cast<uint8_t>(kGenesisNonce >> 16);
+  header[79] = static_cast<uint8_t>(kGenesisNonce >> 24);
+  uint8_t hash[32];
+  idk::sha256d(header, sizeof(header), hash);
+  reversed(hash, display);
+  hexToBytes(kGenesisHash, expected, 32);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, display, 32);
+}
+
+void test_captured_notify_template() {
+  idk::StratumSession session{};
+  TEST_ASSERT_TRUE(idk::parseStratumExtranonce1(kCapturedExtranonce1, session));
+  session.extranonce2Size = 4;
+
+  static idk::StratumJobTemplate tmpl;
+  char err[64] = {0};
+  TEST_ASSERT_TRUE_MESSAGE(idk::buildStratumJobTemplate(makeCapturedNotify(), session, tmpl, err, sizeof(err)), err);
+  TEST_ASSERT_EQUAL_UINT16(101, tmpl.coinbaseLen);
+  TEST_ASSERT_EQUAL_UINT8(3, tmpl.merkleBranchCount);
+
+  for (uint64_t extranonce2 = 0; extranonce2 < 2; ++extranonce2) {
+    uint8_t header[80];
+    idk::buildStratumHeader(tmpl, extranonce2, header);
+
+    uint8_t coinbaseHash[32];
+    uint8_t expected[80];
+    idk::sha256d(tmpl.coinbase, tmpl.coinbaseLen, coinbaseHash);
+    hexToBytes(kCapturedCoinbaseHash[extranonce2], expected, 32);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, coinbaseHash, 32);
+
+    hexToBytes(kCapturedMerkleRoot[extranonce2], expected, 32);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, header + 36, 32);
+
+    hexToBytes(kCapturedHeader[extranonce2], expected, 80);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, header, 80);
+  }
+
+  char formatted[17];
+  idk::formatStratumExtranonce2(1, 4, formatted, sizeof(formatted));
+  TEST_ASSERT_EQUAL_STRING("00000001", formatted);
+}
+
+void test_client_replays_captured_session() {
+  static idk::RuntimeConfig cfg = makeCapturedConfig();
+  // The pool side of the captured session: its extranonce1 in the subscribe
+  // result, its notify once the client has authorized.
+  static idk_test::ScriptedPoolTransport transport(kCapturedExtranonce1, kCapturedNotify);
+  static idk::StratumClient client;
+  client.begin(&cfg, &transport);
+  client.setCoin(idk::CoinType::BTC);
+  client.setIdentity(cfg.btcWallet, "unit", "idk-native", cfg.poolPassword);
+
+  static idk::StratumJob job;
+  bool gotJob = false;
+  for (int i = 0; i < 20 && !gotJob; ++i) {
+    client.loop(millis(), true);
+    gotJob = client.takeLatestJob(job);
+  }
+  TEST_ASSERT_TRUE_MESSAGE(gotJob, client.statusText());
+  TEST_ASSERT_TRUE(client.authorized());
+
+  uint8_t expected[80];
+  TEST_ASSERT_EQUAL_STRING("1", job.jobId);
+  hexToBytes(kCapturedHeader[0], expected, 80);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, job.header, 80);
+  TEST_ASSERT_TRUE(job.hasTarget);
+  TEST_ASSERT_TRUE(job.difficulty > 0.0009 && job.difficulty < 0.0011);
+
+  // Rolling moves to extranonce2 1, and a share on it is submitted with the
+  // matching job id, extranonce2 and ntime.
+  const uint32_t firstWorkId = job.workId;
+  TEST_ASSERT_TRUE(client.rollJob());
+  TEST_ASSERT_TRUE(client.takeLatestJob(job));
+  TEST_ASSERT_TRUE(job.workId != firstWorkId);
+  hexToBytes(kCapturedHeader[1], expected, 80);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, job.header, 80);
+
+  client.submitShare(job.workId, 0x01020304u);
+  TEST_ASSERT_EQUAL_UINT32(1, client.submittedShares());
+  const std::string& submit = transport.sent().back();
+  TEST_ASSERT_TRUE_MESSAGE(
+      submit.find("\"params\":[\"bc1qtestwallet.unit\",\"1\",\"00000001\",\"6ad1eb15\",\"01020304\"]") !=
+          std::string::npos,
+      submit.c_str());
+}
+
+void test_client_drops_a_silent_pool() {
+  static idk::RuntimeConfig cfg = makeCapturedConfig();
+  cfg.poolRetryMs = 2000;
+  static idk_test::ScriptedPoolTransport transport(kCapturedExtranonce1, kCapturedNotify);
+  static idk::StratumClient client;
+  client.begin(&cfg, &transport);
+  client.setCoin(idk::CoinType::BTC);
+  client.setIdentity(cfg.btcWallet, "unit", "idk-native", cfg.poolPassword);
+
+  // Time is synthetic from here on, starting past the first retry interval.
+  uint32_t now = 10000;
+  static idk::StratumJob job;
+  for (int i = 0; i < 20 && !client.takeLatestJob(job); ++i) {
+    client.loop(now++, true);
+  }
+  TEST_ASSERT_TRUE_MESSAGE(client.authorized(), client.statusText());
+  const uint32_t lastRx = now;
+
+  // Quiet for less than keepAliveMs: nothing is sent.
+  const size_t sentBefore = transport.sent().size();
+  client.loop(lastRx + cfg.keepAliveMs - 100, true);
+  TEST_ASSERT_EQUAL_UINT32(sentBefore, transport.sent().size());
+
+  // Quiet for keepAliveMs: one probe, answered (with an error) by a pool
+  // that is still there, which keeps the connection.
+  now = lastRx + cfg.keepAliveMs;
+  client.loop(now, true);
+  TEST_ASSERT_EQUAL_UINT32(sentBefore + 1, transport.sent().size());
+  TEST_ASSERT_TRUE(transport.sent().back().find("mining.extranonce.subscribe") != std::string::npos);
+  client.loop(now + 1, true);
+  client.loop(now + cfg.poolRetryMs + 10, true);
+  TEST_ASSERT_TRUE_MESSAGE(client.authorized(), client.statusText());
+  TEST_ASSERT_EQUAL_UINT32(sentBefore + 1, transport.sent().size());
+
+  // The same again with the pool gone quiet: the unanswered probe drops it
+  // within a retry interval instead of the 30 s request timeout.
+  transport.setSilent(true);
+  now += cfg.keepAliveMs + 1;
+  client.loop(now, true);
+  TEST_ASSERT_EQUAL_UINT32(sentBefore + 2, transport.sent().size());
+  client.loop(now + cfg.poolRetryMs - 1, true);
+  TEST_ASSERT_TRUE(client.connected());
+  client.loop(now + cfg.poolRetryMs, true);
+  TEST_ASSERT_FALSE(client.connected());
+  TEST_ASSERT_EQUAL_STRING("pool:silent", client.statusText());
+}
+
+void setup() {
+  UNITY_BEGIN();
+  RUN_TEST(test_extranonce1_parse);
+  RUN_TEST(test_genesis_job_rebuilds_the_genesis_block);
+  RUN_TEST(test_captured_notify_template);
+  RUN_TEST(test_client_replays_captured_session);
+  RUN_TEST(test_client_drops_a_silent_pool);
+  const int failures = UNITY_END();
+  fflush(stdout);
+  _Exit(failures);
+}
+
+void loop() {}
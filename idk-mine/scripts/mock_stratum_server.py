@@ -0,0 +1,457 @@
+#!/usr/bin/env python3
+"""Scripted local Stratum V1 pool for host-side runs of the idk-mine stratum client.
+
+Default mode behaves like a small pool: it answers subscribe/authorize/submit,
+rebuilds and hashes every submitted header against the difficulty its job was
+sent with, sends a difficulty and a fresh job every --job-interval seconds,
+and reports submit counts and latencies. --drop-every simulates reconnect storms,
+--script drives a connection step by step and --replay feeds captured
+pool-to-miner lines back in order.
+"""
+
+from __future__ import annotations
+
+import argparse
+import asyncio
+import hashlib
+import json
+import os
+import random
+import signal
+import struct
+import time
+from dataclasses import dataclass, field
+from pathlib import Path
+from typing import Any, Dict, List, Optional, Tuple
+
+EXTRANONCE2_SIZE = 4
+# Version, nbits and a genesis-era previous hash: the client only needs
+# well-formed hex to build headers, not a real chain tip.
+VERSION_HEX = "20000000"
+NBITS_HEX = "1d00ffff"
+# Difficulty-1 targets as the client computes them (miner/share_target.h).
+DIFF1_TARGET = {"sha256d": 0xFFFF << 208, "scrypt": 0xFFFF << 224}
+
+
+def now_ms() -> float:
+    return time.monotonic() * 1000.0
+
+
+@dataclass
+class Stats:
+    connections: int = 0
+    dropped: int = 0
+    jobs_sent: int = 0
+    submits: int = 0
+    accepted: int = 0
+    rejected: int = 0
+    stale: int = 0
+    low_diff: int = 0
+    reply_ms: List[float] = field(default_factory=list)
+    first_job_ms: List[float] = field(default_factory=list)
+
+    def summary(self) -> str:
+        def avg(values: List[float]) -> str:
+            return f"{sum(values) / len(values):.1f}" if values else "-"
+
+        return (
+            f"connections={self.connections} dropped={self.dropped} jobs={self.jobs_sent} "
+            f"submits={self.submits} accepted={self.accepted} rejected={self.rejected} stale={self.stale} "
+            f"low_diff={self.low_diff} reply_ms_avg={avg(self.reply_ms)} connect_to_job_ms_avg={avg(self.first_job_ms)}"
+        )
+
+
+@dataclass
+class Job:
+    job_id: str
+    notify: Dict[str, Any]
+    sent_ms: float
+
+
+def sha256d(data: bytes) -> bytes:
+    return hashlib.sha256(hashlib.sha256(data).digest()).digest()
+
+
+def share_header(notify: Dict[str, Any], extranonce1: str, extranonce2: str, ntime: str, nonce: str) -> bytes:
+    """The 80-byte header a submit claims, built the way the miner must have:
+    coinbase from coinb1 + extranonce1 + extranonce2 + coinb2, merkle root
+    up the branch, and prevhash with its 32-bit words swapped back."""
+    _, prevhash, coinb1, coinb2, branch, version, nbits = notify["params"][:7]
+    root = sha256d(bytes.fromhex(coinb1 + extranonce1 + extranonce2 + coinb2))
+    for step in branch:
+        root = sha256d(root + bytes.fromhex(step))
+    prev = bytes.fromhex(prevhash)
+    prev = b"".join(prev[i : i + 4][::-1] for i in range(0, 32, 4))
+    return (
+        struct.pack("<I", int(version, 16))
+        + prev
+        + root
+        + struct.pack("<III", int(ntime, 16), int(nbits, 16), int(nonce, 16))
+    )
+
+
+def pow_hash(algo: str, header: bytes) -> int:
+    if algo == "scrypt":
+        digest = hashlib.scrypt(header, salt=header, n=1024, r=1, p=1, dklen=32)
+    else:
+        digest = sha256d(header)
+    return int.from_bytes(digest, "little")
+
+
+def share_target(algo: str, difficulty: float) -> int:
+    return int(DIFF1_TARGET[algo] / difficulty) if difficulty > 0 else (1 << 256) - 1
+
+
+class MockPool:
+    def __init__(self, args: argparse.Namespace) -> None:
+        self.args = args
+        self.stats = Stats()
+        self.clients: List["Session"] = []
+        self.job_seq = 0
+        self.rng = random.Random(args.seed)
+        self.script = load_script(args.script) if args.script else None
+        self.replay = load_replay(args.replay) if args.replay else None
+
+    def make_job(self, clean: bool) -> Job:
+        self.job_seq += 1
+        job_id = f"{self.job_seq:x}"
+        prevhash = hashlib.sha256(f"prev-{self.job_seq}".encode()).hexdigest()
+        coinb1 = "01000000010000000000000000000000000000000000000000000000000000000000000000ffffffff20" + os.urandom(
+            8
+        ).hex()
+        coinb2 = "ffffffff0100f2052a010000001976a914" + "00" * 20 + "88ac00000000"
+        branch = [hashlib.sha256(f"tx-{self.job_seq}-{i}".encode()).hexdigest() for i in range(self.args.branches)]
+        ntime = f"{int(time.time()):08x}"
+        notify = {
+            "id": None,
+            "method": "mining.notify",
+            "params": [job_id, prevhash, coinb1, coinb2, branch, VERSION_HEX, NBITS_HEX, ntime, clean],
+        }
+        return Job(job_id, notify, now_ms())
+
+    async def broadcast_jobs(self) -> None:
+        tick = 0
+        while True:
+            await asyncio.sleep(self.args.job_interval)
+            tick += 1
+            clean = self.args.clean_every > 0 and tick % self.args.clean_every == 0
+            job = self.make_job(clean)
+            for client in list(self.clients):
+                if client.authorized and not client.scripted:
+                    try:
+                        await client.send_job(job)
+                    except ConnectionError:
+                        client.close()
+
+    async def drop_storm(self) -> None:
+        while True:
+            await asyncio.sleep(self.args.drop_every)
+            victims = list(self.clients)
+            for client in victims:
+                client.close()
+            self.stats.dropped += len(victims)
+            log(f"storm: dropped {len(victims)} connection(s)")
+
+    async def handle(self, reader: asyncio.StreamReader, writer: asyncio.StreamWriter) -> None:
+        self.stats.connections += 1
+        if self.stats.connections <= self.args.refuse_first:
+            log(f"refusing connection #{self.stats.connections}")
+            writer.close()
+            return
+
+        session = Session(self, reader, writer)
+        self.clients.append(session)
+        try:
+            await session.run()
+        except (ConnectionError, asyncio.IncompleteReadError):
+            pass
+        finally:
+            self.clients.remove(session)
+            session.close()
+            log(f"{session.peer}: closed")
+
+
+class Session:
+    def __init__(self, pool: MockPool, reader: asyncio.StreamReader, writer: asyncio.StreamWriter) -> None:
+        self.pool = pool
+        self.reader = reader
+        self.writer = writer
+        self.peer = "%s:%s" % writer.get_extra_info("peername")[:2]
+        self.opened_ms = now_ms()
+        self.authorized = False
+        self.scripted = pool.script is not None
+        self.sent_job = False
+        self.jobs: Dict[str, Job] = {}
+        # mining.set_difficulty applies from the next notify, so each job
+        # keeps the target that was in force when it went out.
+        self.difficulty = 1.0
+        self.job_targets: Dict[str, int] = {}
+        self.extranonce1 = os.urandom(4).hex()
+        self.inbox: "asyncio.Queue[Dict[str, Any]]" = asyncio.Queue()
+        self.background: Optional[asyncio.Task] = None
+
+    async def run(self) -> None:
+        log(f"{self.peer}: connected")
+        if self.scripted:
+            self.background = asyncio.create_task(self.guarded(self.run_script(self.pool.script or [])))
+        await self.read_loop()
+
+    async def read_loop(self) -> None:
+        while True:
+            raw = await self.reader.readline()
+            if not raw:
+                return
+            try:
+                msg = json.loads(raw)
+            except ValueError:
+                log(f"{self.peer}: unparsable line {raw[:80]!r}")
+                continue
+            if self.scripted:
+                await self.inbox.put(msg)
+            else:
+                await self.reply(msg)
+
+    async def reply(self, msg: Dict[str, Any], override: Any = None) -> None:
+        method = msg.get("method", "")
+        req_id = msg.get("id")
+        args = self.pool.args
+
+        if override is not None:
+            await self.send({"id": req_id, **override})
+            return
+
+        if method == "mining.subscribe":
+            result = [[["mining.set_difficulty", "1"], ["mining.notify", "1"]], self.extranonce1, EXTRANONCE2_SIZE]
+            await self.send({"id": req_id, "result": result, "error": None})
+        elif method == "mining.authorize":
+            await self.send({"id": req_id, "result": True, "error": None})
+            self.authorized = True
+            if not self.scripted:
+                await self.send({"id": None, "method": "mining.set_difficulty", "params": [args.difficulty]})
+                if self.pool.replay is not None:
+                    self.background = asyncio.create_task(self.guarded(self.run_replay(self.pool.replay)))
+                else:
+                    await self.send_job(self.pool.make_job(True))
+        elif method == "mining.submit":
+            await self.answer_submit(msg)
+        else:
+            await self.send({"id": req_id, "result": None, "error": [20, f"unsupported {method}", None]})
+
+    async def answer_submit(self, msg: Dict[str, Any]) -> None:
+        args = self.pool.args
+        stats = self.pool.stats
+        received_ms = now_ms()
+        params = msg.get("params") or []
+        job_id = params[1] if len(params) > 1 else ""
+        stats.submits += 1
+
+        if args.submit_delay_ms > 0:
+            await asyncio.sleep(args.submit_delay_ms / 1000.0)
+
+        # Jobs stay valid until a clean notify clears them, as on a real pool.
+        job = self.jobs.get(job_id)
+        hash_value: Optional[int] = None
+        if job is not None:
+            try:
+                header = share_header(job.notify, self.extranonce1, params[2], params[3], params[4])
+                hash_value = pow_hash(args.algo, header)
+            except (IndexError, TypeError, ValueError, struct.error):
+                hash_value = None
+
+        if job is None:
+            stats.stale += 1
+            stats.rejected += 1
+            await self.send({"id": msg.get("id"), "result": None, "error": [21, "Job not found (=stale)", None]})
+        elif hash_value is None or len(params[2]) != EXTRANONCE2_SIZE * 2:
+            stats.rejected += 1
+            await self.send({"id": msg.get("id"), "result": None, "error": [20, "Malformed submit", None]})
+        elif hash_value > self.job_targets[job_id]:
+            stats.low_diff += 1
+            stats.rejected += 1
+            await self.send({"id": msg.get("id"), "result": None, "error": [23, "Low difficulty share", None]})
+        elif self.pool.rng.random() < args.reject_ratio:
+            stats.rejected += 1
+            await self.send({"id": msg.get("id"), "result": None, "error": [23, "Low difficulty share", None]})
+        else:
+            stats.accepted += 1
+            await self.send({"id": msg.get("id"), "result": True, "error": None})
+        stats.reply_ms.append(now_ms() - received_ms)
+
+        since_notify = f"{received_ms - job.sent_ms:.0f}ms" if job else "?"
+        log(f"{self.peer}: submit job={job_id} {since_notify} after its notify")
+
+    async def send_job(self, job: Job) -> None:
+        clean = bool(job.notify["params"][-1])
+        if clean:
+            self.jobs.clear()
+            self.job_targets.clear()
+        self.jobs[job.job_id] = job
+        self.job_targets[job.job_id] = share_target(self.pool.args.algo, self.difficulty)
+        if not self.sent_job:
+            self.sent_job = True
+            self.pool.stats.first_job_ms.append(now_ms() - self.opened_ms)
+        self.pool.stats.jobs_sent += 1
+        await self.send(job.notify)
+
+    async def guarded(self, coro: Any) -> None:
+        """Runs a sender alongside read_loop; a dead socket just ends the session."""
+        try:
+            await coro
+        except ConnectionError:
+            self.close()
+
+    async def run_replay(self, lines: List[Tuple[float, Dict[str, Any]]]) -> None:
+        gap_s = self.pool.args.replay_gap_ms / 1000.0
+        prev_ms: Optional[float] = None
+        for at_ms, msg in lines:
+            delay_s = gap_s if prev_ms is None or at_ms < 0 else max(0.0, (at_ms - prev_ms) / 1000.0)
+            prev_ms = at_ms if at_ms >= 0 else prev_ms
+            await asyncio.sleep(delay_s)
+            if msg.get("method") == "mining.notify":
+                params = msg.get("params") or []
+                if params:
+                    await self.send_job(Job(str(params[0]), msg, now_ms()))
+                    continue
+            await self.send(msg)
+        log(f"{self.peer}: replay finished ({len(lines)} line(s))")
+
+    async def run_script(self, steps: List[Dict[str, Any]]) -> None:
+        """Steps: {"send": obj}, {"job": {"clean": bool}}, {"sleep_ms": n},
+        {"expect": method, "reply": obj?}, {"disconnect": true}. Requests that
+        arrive while no "expect" is waiting get the default reply."""
+        for step in steps:
+            if "sleep_ms" in step:
+                await self.sleep_answering(step["sleep_ms"] / 1000.0)
+            elif "send" in step:
+                await self.send(step["send"])
+            elif "job" in step:
+                await self.send_job(self.pool.make_job(bool(step["job"].get("clean", True))))
+            elif "expect" in step:
+                while True:
+                    msg = await self.inbox.get()
+                    if msg.get("method") == step["expect"]:
+                        await self.reply(msg, step.get("reply"))
+                        break
+                    await self.reply(msg)
+            elif step.get("disconnect"):
+                self.close()
+                return
+        while True:
+            await self.reply(await self.inbox.get())
+
+    async def sleep_answering(self, seconds: float) -> None:
+        deadline = time.monotonic() + seconds
+        while True:
+            remaining = deadline - time.monotonic()
+            if remaining <= 0:
+                return
+            try:
+                msg = await asyncio.wait_for(self.inbox.get(), remaining)
+            except asyncio.TimeoutError:
+                return
+            await self.reply(msg)
+
+    async def send(self, msg: Dict[str, Any]) -> None:
+        if msg.get("method") == "mining.set_difficulty" and msg.get("params"):
+            self.difficulty = float(msg["params"][0])
+        self.writer.write((json.dumps(msg, separators=(",", ":")) + "\n").encode())
+        await self.writer.drain()
+
+    def close(self) -> None:
+        if self.background is not None:
+            self.background.cancel()
+        if not self.writer.is_closing():
+            self.writer.close()
+
+
+def load_script(path: Path) -> List[Dict[str, Any]]:
+    steps = json.loads(path.read_text())
+    if not isinstance(steps, list):
+        raise SystemExit(f"{path}: script must be a JSON array of steps")
+    return steps
+
+
+def load_replay(path: Path) -> List[Tuple[float, Dict[str, Any]]]:
+    """Pool-to-miner lines, either bare JSON or "<ms> <json>" with a capture
+    timestamp. Anything else (serial telemetry, boot noise, miner-to-pool
+    requests) is skipped, so a raw monitor log can be fed in directly."""
+    lines: List[Tuple[float, Dict[str, Any]]] = []
+    skipped = 0
+    for raw in path.read_text(errors="replace").splitlines():
+        text = raw.strip()
+        at_ms = -1.0
+        head, _, rest = text.partition(" ")
+        if rest.startswith("{"):
+            try:
+                at_ms = float(head)
+                text = rest
+            except ValueError:
+                pass
+        start = text.find("{")
+        msg: Any = None
+        if start >= 0:
+            try:
+                msg = json.loads(text[start:])
+            except ValueError:
+                msg = None
+        if not isinstance(msg, dict) or ("method" in msg and msg["method"] in ("mining.subscribe",
+                                                                              "mining.authorize",
+                                                                              "mining.submit")):
+            skipped += 1
+            continue
+        lines.append((at_ms, msg))
+    log(f"replay: {len(lines)} pool line(s) loaded from {path}, {skipped} skipped")
+    return lines
+
+
+def log(text: str) -> None:
+    print(f"[mock-pool {time.strftime('%H:%M:%S')}] {text}", flush=True)
+
+
+def parse_args() -> argparse.Namespace:
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=3333)
+    parser.add_argument("--difficulty", type=float, default=0.001, help="mining.set_difficulty value")
+    parser.add_argument("--algo", choices=sorted(DIFF1_TARGET), default="sha256d", help="proof of work for submits")
+    parser.add_argument("--job-interval", type=float, default=30.0, help="seconds between mining.notify")
+    parser.add_argument("--clean-every", type=int, default=4, help="every Nth job sets clean_jobs (0: never)")
+    parser.add_argument("--branches", type=int, default=6, help="merkle branch length per job")
+    parser.add_argument("--reject-ratio", type=float, default=0.0, help="fraction of valid submits rejected")
+    parser.add_argument("--submit-delay-ms", type=float, default=0.0, help="delay before answering a submit")
+    parser.add_argument("--drop-every", type=float, default=0.0, help="close every connection each N seconds")
+    parser.add_argument("--refuse-first", type=int, default=0, help="close the first N connections at once")
+    parser.add_argument("--script", type=Path, help="JSON array of steps run per connection")
+    parser.add_argument("--replay", type=Path, help="captured pool lines sent after authorize")
+    parser.add_argument("--replay-gap-ms", type=float, default=100.0, help="spacing of untimed replay lines")
+    parser.add_argument("--seed", type=int, default=1)
+    return parser.parse_args()
+
+
+async def serve(args: argparse.Namespace) -> None:
+    pool = MockPool(args)
+    server = await asyncio.start_server(pool.handle, args.host, args.port)
+    log(f"listening on {args.host}:{args.port}")
+
+    tasks = [asyncio.create_task(pool.broadcast_jobs())]
+    if args.drop_every > 0:
+        tasks.append(asyncio.create_task(pool.drop_storm()))
+
+    stop = asyncio.Event()
+    loop = asyncio.get_running_loop()
+    for sig in (signal.SIGINT, signal.SIGTERM):
+        loop.add_signal_handler(sig, stop.set)
+
+    async with server:
+        await stop.wait()
+    for task in tasks:
+        task.cancel()
+    log(pool.stats.summary())
+
+
+def main() -> None:
+    asyncio.run(serve(parse_args()))
+
+
+if __name__ == "__main__":
+    main()
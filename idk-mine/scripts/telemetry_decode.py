@@ -0,0 +1,237 @@
+#!/usr/bin/env python3
+"""Decode idk-mine binary telemetry frames from a serial port, a capture file or stdin.
+
+The firmware answers "history bin" with its whole sample ring and
+"stream bin" with one frame per new sample (see
+shared/idk-mine-core/src/telemetry/telemetry_export.h). Frames share the
+port with the text logs; everything between frames is skipped, or echoed to
+stderr with --echo-text.
+"""
+
+from __future__ import annotations
+
+import argparse
+import json
+import os
+import struct
+import sys
+import time
+from dataclasses import asdict, dataclass
+from typing import BinaryIO, Iterator, Optional, Union
+
+SYNC = b"\xa5\x5a"
+FRAME_SAMPLE = 1
+FRAME_DUMP_BEGIN = 2
+FRAME_DUMP_END = 3
+
+SAMPLE = struct.Struct("<IIfIIIbI")
+DUMP_BEGIN = struct.Struct("<IHI")
+DUMP_END = struct.Struct("<I")
+
+CSV_FIELDS = ("seq", "uptime_ms", "hashrate", "accepted", "rejected", "free_heap", "rssi", "job_age_ms")
+
+
+@dataclass
+class Sample:
+    seq: int
+    uptime_ms: int
+    hashrate: float
+    accepted: int
+    rejected: int
+    free_heap: int
+    rssi: int
+    job_age_ms: int
+
+
+@dataclass
+class DumpBegin:
+    first_seq: int
+    count: int
+    interval_ms: int
+
+
+@dataclass
+class DumpEnd:
+    next_seq: int
+
+
+Frame = Union[Sample, DumpBegin, DumpEnd]
+
+
+def crc16_ccitt(data: bytes) -> int:
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def parse_payload(kind: int, payload: bytes) -> Optional[Frame]:
+    if kind == FRAME_SAMPLE and len(payload) == SAMPLE.size:
+        return Sample(*SAMPLE.unpack(payload))
+    if kind == FRAME_DUMP_BEGIN and len(payload) == DUMP_BEGIN.size:
+        return DumpBegin(*DUMP_BEGIN.unpack(payload))
+    if kind == FRAME_DUMP_END and len(payload) == DUMP_END.size:
+        return DumpEnd(*DUMP_END.unpack(payload))
+    return None
+
+
+class FrameDecoder:
+    """Incremental decoder: feed() raw bytes, get frames and the text around them."""
+
+    def __init__(self) -> None:
+        self.buf = bytearray()
+        self.text = bytearray()
+        self.bad_crc = 0
+
+    def feed(self, data: bytes) -> Iterator[Frame]:
+        self.buf += data
+        while True:
+            start = self.buf.find(SYNC)
+            if start < 0:
+                # Keep a trailing 0xA5 in case its partner is in the next read.
+                keep = 1 if self.buf.endswith(SYNC[:1]) else 0
+                self.text += self.buf[: len(self.buf) - keep]
+                del self.buf[: len(self.buf) - keep]
+                return
+            self.text += self.buf[:start]
+            del self.buf[:start]
+            if len(self.buf) < 4:
+                return
+            kind, length = self.buf[2], self.buf[3]
+            total = 4 + length + 2
+            if len(self.buf) < total:
+                return
+            body = bytes(self.buf[2 : 4 + length])
+            (crc,) = struct.unpack_from("<H", self.buf, 4 + length)
+            frame = parse_payload(kind, body[2:]) if crc == crc16_ccitt(body) else None
+            if frame is None:
+                # Not a frame after all (or corrupted): resync one byte on.
+                self.bad_crc += 1
+                self.text += self.buf[:1]
+                del self.buf[:1]
+                continue
+            del self.buf[:total]
+            yield frame
+
+    def take_text(self) -> bytes:
+        out = bytes(self.text)
+        self.text.clear()
+        return out
+
+
+def open_serial(path: str, baud: int) -> int:
+    import termios
+    import tty
+
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+    tty.setraw(fd)
+    attrs = termios.tcgetattr(fd)
+    speed = getattr(termios, f"B{baud}")
+    attrs[4] = attrs[5] = speed
+    termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    return fd
+
+
+def read_chunks(source: Union[int, BinaryIO], idle_timeout: float) -> Iterator[bytes]:
+    if isinstance(source, int):
+        import select
+
+        while True:
+            ready, _, _ = select.select([source], [], [], idle_timeout if idle_timeout > 0 else None)
+            if not ready:
+                return
+            chunk = os.read(source, 4096)
+            if not chunk:
+                return
+            yield chunk
+    else:
+        while True:
+            chunk = source.read1(4096) if hasattr(source, "read1") else source.read(4096)
+            if not chunk:
+                return
+            yield chunk
+
+
+def format_frame(frame: Frame, fmt: str) -> Optional[str]:
+    if fmt == "json":
+        kind = {Sample: "sample", DumpBegin: "dump_begin", DumpEnd: "dump_end"}[type(frame)]
+        return json.dumps({"type": kind, **asdict(frame)})
+    if isinstance(frame, Sample):
+        if fmt == "csv":
+            return ",".join(str(round(v, 2) if isinstance(v, float) else v) for v in asdict(frame).values())
+        return (
+            f"seq={frame.seq} uptime={frame.uptime_ms}ms hashrate={frame.hashrate:.2f}H/s "
+            f"accepted={frame.accepted} rejected={frame.rejected} heap={frame.free_heap} "
+            f"rssi={frame.rssi} job_age={frame.job_age_ms}ms"
+        )
+    if fmt == "csv":
+        return None
+    if isinstance(frame, DumpBegin):
+        return f"# history first={frame.first_seq} count={frame.count} interval={frame.interval_ms}ms"
+    return f"# history end next={frame.next_seq}"
+
+
+def parse_args() -> argparse.Namespace:
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("input", nargs="?", help="capture file (default: stdin unless --device)")
+    parser.add_argument("--device", help="serial port to read, e.g. /dev/ttyUSB0")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument(
+        "--request",
+        choices=("history", "stream"),
+        help="with --device: send 'history bin' or 'stream bin' first",
+    )
+    parser.add_argument("--format", choices=("text", "csv", "json"), default="text")
+    parser.add_argument("--echo-text", action="store_true", help="copy non-frame bytes (logs) to stderr")
+    parser.add_argument(
+        "--idle-timeout",
+        type=float,
+        default=0.0,
+        help="with --device: stop after this many quiet seconds (default: after a history dump ends, else never)",
+    )
+    return parser.parse_args()
+
+
+def main() -> None:
+    args = parse_args()
+    if args.device:
+        source: Union[int, BinaryIO] = open_serial(args.device, args.baud)
+        if args.request:
+            # Drain boot noise so the reply starts clean, then ask.
+            time.sleep(0.1)
+            os.write(source, f"{args.request} bin\n".encode())
+    elif args.input:
+        source = open(args.input, "rb")
+    else:
+        source = sys.stdin.buffer
+
+    stop_after_dump = args.device is not None and args.request == "history"
+    decoder = FrameDecoder()
+    if args.format == "csv":
+        print(",".join(CSV_FIELDS))
+    try:
+        for chunk in read_chunks(source, args.idle_timeout):
+            for frame in decoder.feed(chunk):
+                line = format_frame(frame, args.format)
+                if line is not None:
+                    print(line, flush=True)
+                if stop_after_dump and isinstance(frame, DumpEnd):
+                    return
+            text = decoder.take_text()
+            if args.echo_text and text:
+                sys.stderr.buffer.write(text)
+                sys.stderr.flush()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if args.device and args.request == "stream":
+            os.write(source, b"stream off\n")
+        if decoder.bad_crc:
+            print(f"[decode] skipped {decoder.bad_crc} false syncs / bad frames", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -2,6 +2,7 @@
 
 #include <ArduinoOTA.h>
 #include <LittleFS.h>
+#include <esp_heap_caps.h>
 
 #include "ui/serial_telemetry_ui.h"
 
@@ -12,6 +13,22 @@
 namespace idk {
 namespace {
 
+// Share candidates submitted per network loop pass; the rest stay queued for
+// the next pass so one burst cannot starve socket reads.
+constexpr size_t kShareDrainBatch = 8;
+
+// Longest the network task sleeps with nothing to do. Shares and pool data
+// wake it at once; this only bounds Wi-Fi reconnects, connect retries, OTA
+// polling and request timeouts.
+constexpr uint32_t kIdleTickMs = 100;
+
+constexpr const char* kMinerTuningPath = "/miner_tuning.json";
+constexpr const char* kRuntimeConfigPath = "/runtime_config.json";
+constexpr const char* kConfigBlobPath = "/runtime_config.bin";
+
+constexpr uint32_t kNetworkStackBytes = 6144;
+constexpr uint32_t kUiStackBytes = 4096;
+
 void safeCopy(char* dst, size_t dstSize, const char* src) {
   if (dst == nullptr || dstSize == 0) {
     return;
@@ -27,15 +44,30 @@ void safeCopy(char* dst, size_t dstSize, const char* src) {
 
 AppController::AppController(const ProjectProfile& profile) : profile_(profile) {}
 
-void AppController::begin() {
-  if (started_) {
-    return;
-  }
+bool AppController::loadConfig() {
+  char err[96] = {0};
 
-  Serial.begin(115200);
-  delay(200);
+  // Everything config_ is built from: the firmware (defaults and clamps in
+  // code), the compiled-in default JSON, the profile overrides and the
+  // uploaded JSON. Any change there misses the blob.
+  uint32_t sourceCrc = 0;
+  if (LittleFS.begin(true)) {
+    fsReady_ = true;
+    sourceCrc = configCrc32Build(sourceCrc);
+    sourceCrc = configCrc32(sourceCrc, profile_.defaultConfigJson, strlen(profile_.defaultConfigJson));
+    sourceCrc = configCrc32(sourceCrc, profile_.projectName, strlen(profile_.projectName));
+    sourceCrc = configCrc32(sourceCrc, profile_.minerName, strlen(profile_.minerName));
+    sourceCrc = configCrc32(sourceCrc, &profile_.enableOtaByDefault, sizeof(profile_.enableOtaByDefault));
+    sourceCrc = configCrc32File(LittleFS, kRuntimeConfigPath, sourceCrc);
+
+    if (loadConfigBlob(LittleFS, kConfigBlobPath, sourceCrc, config_, err, sizeof(err))) {
+      return true;
+    }
+    Serial.printf("[config] %s; rebuilding from JSON\n", err);
+  } else {
+    Serial.println("[config] LittleFS mount failed; using defaults");
+  }
 
-  char err[96] = {0};
   if (!loadDefaultsFromJson(profile_.defaultConfigJson, config_, err, sizeof(err))) {
     Serial.printf("[config] default parse failed: %s\n", err);
   }
@@ -47,28 +79,60 @@ void AppController::begin() {
     config_.enableOTA = false;
   }
 
-  if (!LittleFS.begin(true)) {
-    Serial.println("[config] LittleFS mount failed; using defaults");
+  if (!fsReady_) {
+    return false;
+  }
+
+  if (mergeFromFile(LittleFS, kRuntimeConfigPath, config_, err, sizeof(err))) {
+    Serial.printf("[config] loaded %s\n", kRuntimeConfigPath);
   } else {
-    if (mergeFromFile(LittleFS, "/runtime_config.json", config_, err, sizeof(err))) {
-      Serial.println("[config] loaded /runtime_config.json");
-    } else {
-      Serial.printf("[config] %s\n", err);
-    }
+    Serial.printf("[config] %s\n", err);
+  }
+
+  if (saveConfigBlob(LittleFS, kConfigBlobPath, sourceCrc, config_, err, sizeof(err))) {
+    Serial.printf("[config] cached as %s\n", kConfigBlobPath);
+  } else {
+    Serial.printf("[config] %s\n", err);
+  }
+  return false;
+}
+
+void AppController::begin() {
+  if (started_) {
+    return;
   }
 
+  Serial.begin(115200);
+  delay(200);
+
+  const uint32_t configStartUs = micros();
+  telemetry_.configCached = loadConfig();
+  telemetry_.configLoadUs = micros() - configStartUs;
+  Serial.printf("[config] ready in %luus (%s)\n", static_cast<unsigned long>(telemetry_.configLoadUs),
+                telemetry_.configCached ? "cached blob" : "json");
+
   safeCopy(telemetry_.coin, sizeof(telemetry_.coin), coinToString(config_.defaultCoin));
   setStatus("booting");
 
   wifi_.begin(profile_.wifiSsid, profile_.wifiPassword, config_.wifiReconnectMs);
 
-  pool_.begin(&config_);
+  pool_.begin(&config_, &transport_);
   pool_.setCoin(config_.defaultCoin);
   pool_.setIdentity(walletForCoin(config_, config_.defaultCoin), config_.workerName, config_.minerName,
                     config_.poolPassword);
 
   const MinerMode mode = (profile_.variant == VariantKind::Lottery) ? MinerMode::Lottery : MinerMode::Mine;
-  miner_.begin(config_, mode);
+  MinerTuning tuning{};
+  char err[96] = {0};
+  if (fsReady_ && config_.minerAutotune &&
+      !loadMinerTuning(LittleFS, kMinerTuningPath, config_.defaultCoin, tuning, err, sizeof(err))) {
+    Serial.printf("[config] %s\n", err);
+  }
+  if (!wake_.begin()) {
+    Serial.println("[miner] share wakeups unavailable; network task polls");
+  }
+  miner_.setWakeListener(&NetworkWake::signalFrom, &wake_);
+  miner_.begin(config_, mode, tuning);
 
 #if IDK_ENABLE_GUI
   if (profile_.device == DeviceKind::CYD) {
@@ -83,8 +147,8 @@ void AppController::begin() {
   if (ui_ != nullptr) {
     ui_->begin(config_);
   }
-
-  telemetryMutex_ = xSemaphoreCreateMutex();
+  history_.begin(config_.historyIntervalMs);
+  exporter_.begin(&history_);
 
   if (config_.enableOTA) {
     ArduinoOTA.setHostname(config_.projectName);
@@ -98,8 +162,12 @@ void AppController::begin() {
     ArduinoOTA.begin();
   }
 
-  xTaskCreatePinnedToCore(networkTaskEntry, "idk-net", 6144, this, 2, &networkTask_, 0);
-  xTaskCreatePinnedToCore(uiTaskEntry, "idk-ui", 4096, this, 1, &uiTask_, 1);
+  profiler_.begin(config_.stackAlertBytes, config_.heapAlertBytes);
+
+  // UI first so its handle is set by the time the network task registers
+  // every task with the profiler.
+  xTaskCreatePinnedToCore(uiTaskEntry, "idk-ui", kUiStackBytes, this, 1, &uiTask_, 1);
+  xTaskCreatePinnedToCore(networkTaskEntry, "idk-net", kNetworkStackBytes, this, 2, &networkTask_, 0);
 
   started_ = true;
 }
@@ -118,9 +186,25 @@ void AppController::uiTaskEntry(void* ctx) {
 
 void AppController::networkTaskLoop() {
   uint32_t lastMetricsMs = 0;
+  uint32_t wakeups = 0;
+  uint32_t queueTotalUs = 0;
+  uint32_t queueCount = 0;
+  uint32_t queueMaxUs = 0;
+  uint32_t lastJobMs = 0;
+  uint32_t busyUs = 0;
+
+  const uint8_t netSlot = profiler_.track("idk-net", networkTask_, kNetworkStackBytes);
+  const uint8_t uiSlot = profiler_.track("idk-ui", uiTask_, kUiStackBytes);
+  uint8_t workerSlots[2];
+  for (uint8_t i = 0; i < 2; ++i) {
+    workerSlots[i] = profiler_.track((i == 0) ? "mine-w0" : "mine-w1", miner_.workerTask(i),
+                                     MinerEngine::kWorkerStackBytes);
+  }
 
   while (true) {
     const uint32_t now = millis();
+    const uint32_t passStartUs = micros();
+    ++wakeups;
 
     wifi_.loop(now);
     const bool wifiConnected = wifi_.connected();
@@ -131,36 +215,144 @@ void AppController::networkTaskLoop() {
       ArduinoOTA.handle();
     }
 
+    if (miner_.takeNonceSpaceExhausted() && pool_.rollJob()) {
+      telemetry_.nonceRollovers++;
+      publishTelemetry();
+    }
+
     StratumJob job;
     if (pool_.takeLatestJob(job)) {
       const uint32_t fallbackTarget = (profile_.variant == VariantKind::Lottery) ? config_.lotteryTarget32 : config_.mineTarget32;
       miner_.updateJob(job, fallbackTarget);
+      lastJobMs = now;
 
-      TelemetryState t = snapshotTelemetry();
-      safeCopy(t.poolJob, sizeof(t.poolJob), job.jobId);
-      safeCopy(t.poolTarget, sizeof(t.poolTarget), job.targetHex);
-      t.target32 = (job.target32 == 0) ? fallbackTarget : job.target32;
-      updateTelemetry(t);
+      safeCopy(telemetry_.poolJob, sizeof(telemetry_.poolJob), job.jobId);
+      safeCopy(telemetry_.poolTarget, sizeof(telemetry_.poolTarget), job.targetHex);
+      telemetry_.target32 = job.hasTarget ? job.target32 : fallbackTarget;
+      telemetry_.poolDifficulty = static_cast<float>(job.difficulty);
+      publishTelemetry();
     }
 
-    ShareCandidate share;
-    if (miner_.takeShareCandidate(share)) {
-      pool_.submitPseudoShare(share.nonce, share.hash32);
+    ShareCandidate shares[kShareDrainBatch];
+    const size_t shareCount = miner_.takeShareCandidates(shares, kShareDrainBatch);
+    for (size_t i = 0; i < shareCount; ++i) {
+      const uint32_t queuedUs = micros() - shares[i].foundUs;
+      queueTotalUs += queuedUs;
+      ++queueCount;
+      if (queuedUs > queueMaxUs) {
+        queueMaxUs = queuedUs;
+      }
+      pool_.submitShare(shares[i].workId, shares[i].nonce);
     }
 
     if (lastMetricsMs == 0 || now - lastMetricsMs >= config_.telemetryIntervalMs) {
-      TelemetryState t = snapshotTelemetry();
+      miner_.sampleCounters(now);
+      pool_.sampleShareRate(now, miner_.averageHashrate(HashrateWindow::OneMinute));
+      pool_.sampleRx(now);
+
+      MinerTuning tuning{};
+      if (miner_.takeTuningResult(tuning)) {
+        Serial.printf("[miner] tuned batch=%u yield_every=%u hashrate=%.2fH/s\n",
+                      static_cast<unsigned>(tuning.batchSize), static_cast<unsigned>(tuning.yieldEvery),
+                      tuning.hashrate);
+        char err[96] = {0};
+        if (fsReady_ && !saveMinerTuning(LittleFS, kMinerTuningPath, config_.defaultCoin, tuning, err, sizeof(err))) {
+          Serial.printf("[config] %s\n", err);
+        }
+      }
+
+      TelemetryState& t = telemetry_;
 
       t.totalHash = miner_.totalHashes();
       t.bestDiff = miner_.bestDifficulty();
       t.blockFound = miner_.blocksFound();
-      t.currentHashrate = miner_.currentHashrate(now);
+      t.nonceCoverage = miner_.nonceCoverage();
+      t.currentHashrate = miner_.currentHashrate();
+      t.hashrate10s = miner_.averageHashrate(HashrateWindow::TenSeconds);
+      t.hashrate60s = miner_.averageHashrate(HashrateWindow::OneMinute);
+      t.hashrate15m = miner_.averageHashrate(HashrateWindow::FifteenMinutes);
+      t.jobSwitchUs = miner_.jobSwitchLatencyUs();
+      t.jobSwitchMaxUs = miner_.maxJobSwitchLatencyUs();
+      t.batchSize = miner_.batchSize();
+      t.yieldEvery = miner_.yieldEvery();
+      t.tuningSettled = miner_.tuningSettled();
+      t.workerCount = miner_.workerCount();
+      for (uint8_t i = 0; i < 2; ++i) {
+        t.workerHashrate[i] = miner_.workerHashrate(i);
+        t.workerTotalHash[i] = miner_.workerHashes(i);
+      }
 
       t.wifiConnected = wifiConnected;
       t.poolConnected = pool_.connected();
       t.reconnectCount = wifi_.reconnectCount() + pool_.reconnectCount();
+      t.poolEndpoint = pool_.endpointIndex();
+      t.poolEndpointCount = pool_.endpointCount();
+      t.poolLatencyMs = pool_.endpointLatencyMs();
+      t.poolFailovers = pool_.failoverCount();
+      t.tlsHandshakeMs = pool_.tlsHandshakeMs();
+      t.tlsFullHandshakes = pool_.tlsFullHandshakes();
+      t.tlsResumedHandshakes = pool_.tlsResumedHandshakes();
+      t.tlsPinFailures = pool_.tlsPinFailures();
+      t.connectToJobMs = pool_.connectToJobMs();
       t.acceptedShares = pool_.acceptedShares();
       t.rejectedShares = pool_.rejectedShares();
+      t.submittedShares = pool_.submittedShares();
+      t.staleShares = pool_.staleShares();
+      t.timedOutShares = pool_.timedOutShares();
+      t.unmatchedResponses = pool_.unmatchedResponses();
+      t.pendingRequests = pool_.pendingRequests();
+      t.shareLatencyAvgMs = pool_.averageShareLatencyMs();
+      t.shareLatencyMaxMs = pool_.maxShareLatencyMs();
+      for (uint8_t i = 0; i < kShareLatencyBuckets; ++i) {
+        t.shareLatencyHist[i] = pool_.shareLatencyCount(i);
+      }
+      t.expectedSharesPerMin = pool_.expectedSharesPerMinute();
+      t.observedSharesPerMin = pool_.observedSharesPerMinute();
+      t.droppedShares = miner_.droppedShares();
+      t.shareQueueHighWater = miner_.shareQueueHighWater();
+      t.rxBytesPerSec = pool_.rxBytesPerSecond();
+      t.lineParseUs = pool_.lineParseUs();
+      t.lineParseMaxUs = pool_.maxLineParseUs();
+      t.rxOverflows = pool_.rxOverflows();
+      if (lastMetricsMs != 0 && now != lastMetricsMs) {
+        t.netWakeupsPerSec = static_cast<float>(wakeups) * 1000.0f / static_cast<float>(now - lastMetricsMs);
+      }
+      t.shareQueueUs = (queueCount == 0) ? 0 : queueTotalUs / queueCount;
+      t.shareQueueMaxUs = queueMaxUs;
+      wakeups = 0;
+      queueTotalUs = 0;
+      queueCount = 0;
+      t.freeHeap = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+      t.rssi = wifi_.rssi();
+      t.jobAgeMs = (lastJobMs == 0) ? 0 : now - lastJobMs;
+
+      profiler_.reportBusyUs(netSlot, busyUs);
+      profiler_.reportBusyUs(uiSlot, uiBusyUs_.load(std::memory_order_relaxed));
+      for (uint8_t i = 0; i < 2; ++i) {
+        profiler_.reportBusyUs(workerSlots[i], miner_.workerBusyUs(i));
+      }
+      profiler_.sample();
+      t.taskCount = profiler_.taskCount();
+      for (uint8_t i = 0; i < t.taskCount; ++i) {
+        TaskTelemetry& task = t.tasks[i];
+        safeCopy(task.name, sizeof(task.name), profiler_.taskName(i));
+        task.cpuPercent = profiler_.cpuPercent(i);
+        task.stackFreeBytes = profiler_.stackFreeBytes(i);
+        task.stackBytes = profiler_.stackBytes(i);
+      }
+      t.minFreeHeap = profiler_.minFreeHeap();
+      t.largestFreeBlock = profiler_.largestFreeBlock();
+      if (profiler_.alert() && !t.resourceAlert) {
+        Serial.printf("[profile] low headroom: %s\n", profiler_.alertText());
+      }
+      t.resourceAlert = profiler_.alert();
+      safeCopy(t.resourceAlertText, sizeof(t.resourceAlertText), profiler_.alertText());
+      t.uiDrawUs = uiDrawUs_.load(std::memory_order_relaxed);
+      t.uiDrawMaxUs = uiDrawMaxUs_.load(std::memory_order_relaxed);
+      if (t.bootToHashMs == 0 && miner_.firstHashUs() != 0) {
+        t.bootToHashMs = miner_.firstHashUs() / 1000;
+        Serial.printf("[miner] first hash %lums after boot\n", static_cast<unsigned long>(t.bootToHashMs));
+      }
 
       if (!wifiConnected) {
         safeCopy(t.status, sizeof(t.status), wifi_.statusText());
@@ -168,55 +360,59 @@ void AppController::networkTaskLoop() {
         safeCopy(t.status, sizeof(t.status), pool_.statusText());
       }
 
-      updateTelemetry(t);
+      publishTelemetry();
       lastMetricsMs = now;
+
+      TelemetrySample sample{};
+      sample.uptimeMs = now;
+      sample.hashrate = t.hashrate10s;
+      sample.accepted = t.acceptedShares;
+      sample.rejected = t.rejectedShares;
+      sample.freeHeap = t.freeHeap;
+      sample.rssi = t.rssi;
+      sample.jobAgeMs = t.jobAgeMs;
+      history_.offer(sample);
     }
 
-    vTaskDelay(pdMS_TO_TICKS(20));
+    // Go straight round while there is backlog; otherwise sleep until a
+    // share, pool data, the next telemetry sample or the idle tick.
+    busyUs += micros() - passStartUs;
+    if (shareCount == kShareDrainBatch || pool_.hasPendingInput()) {
+      continue;
+    }
+    const uint32_t sinceMetrics = millis() - lastMetricsMs;
+    uint32_t waitMs = kIdleTickMs;
+    if (sinceMetrics < config_.telemetryIntervalMs && config_.telemetryIntervalMs - sinceMetrics < waitMs) {
+      waitMs = config_.telemetryIntervalMs - sinceMetrics;
+    }
+    wake_.wait(pool_.socketFd(), waitMs);
   }
 }
 
 void AppController::uiTaskLoop() {
   while (true) {
+    const uint32_t passStartUs = micros();
     if (ui_ != nullptr) {
-      const TelemetryState t = snapshotTelemetry();
-      ui_->update(t);
+      published_.read(uiTelemetry_);
+      ui_->update(uiTelemetry_);
+      uiDrawUs_.store(ui_->lastDrawUs(), std::memory_order_relaxed);
+      uiDrawMaxUs_.store(ui_->maxDrawUs(), std::memory_order_relaxed);
     }
+    exporter_.poll();
+    uiBusyUs_.store(uiBusyUs_.load(std::memory_order_relaxed) + (micros() - passStartUs), std::memory_order_relaxed);
 
     const uint32_t interval = (config_.uiUpdateMs == 0) ? 200 : config_.uiUpdateMs;
     vTaskDelay(pdMS_TO_TICKS(interval));
   }
 }
 
-void AppController::updateTelemetry(const TelemetryState& snapshot) {
-  if (telemetryMutex_ == nullptr) {
-    telemetry_ = snapshot;
-    return;
-  }
-
-  if (xSemaphoreTake(telemetryMutex_, pdMS_TO_TICKS(10)) == pdTRUE) {
-    telemetry_ = snapshot;
-    xSemaphoreGive(telemetryMutex_);
-  }
-}
-
-TelemetryState AppController::snapshotTelemetry() {
-  if (telemetryMutex_ == nullptr) {
-    return telemetry_;
-  }
-
-  TelemetryState out = telemetry_;
-  if (xSemaphoreTake(telemetryMutex_, pdMS_TO_TICKS(10)) == pdTRUE) {
-    out = telemetry_;
-    xSemaphoreGive(telemetryMutex_);
-  }
-  return out;
+void AppController::publishTelemetry() {
+  published_.publish(telemetry_);
 }
 
 void AppController::setStatus(const char* statusText) {
-  TelemetryState t = snapshotTelemetry();
-  safeCopy(t.status, sizeof(t.status), statusText);
-  updateTelemetry(t);
+  safeCopy(telemetry_.status, sizeof(telemetry_.status), statusText);
+  publishTelemetry();
 }
 
 }  // namespace idk
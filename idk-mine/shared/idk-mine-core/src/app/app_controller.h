@@ -5,14 +5,29 @@
 #include <freertos/semphr.h>
 #include <freertos/task.h>
 
+#include <atomic>
+
 #include "app/project_profile.h"
+#include "config/config_blob.h"
+#include "config/miner_tuning.h"
 #include "config/runtime_config.h"
 #include "miner/miner_engine.h"
+#include "network/network_wake.h"
 #include "network/stratum_client.h"
 #include "network/wifi_manager.h"
+#include "telemetry/telemetry_export.h"
+#include "telemetry/telemetry_history.h"
+#include "telemetry/telemetry_publisher.h"
+#include "telemetry/system_profiler.h"
 #include "telemetry/telemetry_state.h"
 #include "ui/ui_backend.h"
 
+#if IDK_NATIVE
+#include "network/posix_transport.h"
+#else
+#include "network/arduino_transport.h"
+#endif
+
 namespace idk {
 
 class AppController {
@@ -29,25 +44,53 @@ class AppController {
   void networkTaskLoop();
   void uiTaskLoop();
 
-  void updateTelemetry(const TelemetryState& snapshot);
-  TelemetryState snapshotTelemetry();
+  // Mounts LittleFS and fills config_, from the cached blob when it still
+  // matches the JSON sources. Returns true when the blob was used.
+  bool loadConfig();
+
+  // Writer-side helpers: network task only (and begin() before it starts;
+  // OTA callbacks run inside ArduinoOTA.handle() on the network task).
+  void publishTelemetry();
   void setStatus(const char* statusText);
 
   ProjectProfile profile_;
   RuntimeConfig config_{};
 
   WifiManager wifi_;
+#if IDK_NATIVE
+  PosixStratumTransport transport_;
+#else
+  ArduinoStratumTransport transport_;
+#endif
   StratumClient pool_;
   MinerEngine miner_;
+  // Wakes the network task when a worker queues a share; the pool socket
+  // wakes it when data arrives.
+  NetworkWake wake_;
 
   UIBackend* ui_ = nullptr;
 
   TaskHandle_t networkTask_ = nullptr;
   TaskHandle_t uiTask_ = nullptr;
 
-  SemaphoreHandle_t telemetryMutex_ = nullptr;
+  // Owned by the network task, which edits it in place and publishes whole
+  // copies; the UI task only ever reads a published copy.
   TelemetryState telemetry_{};
+  TelemetryPublisher published_;
+  TelemetryState uiTelemetry_{};
+
+  // Recorded by the network task, served over Serial by the UI task.
+  TelemetryHistory history_;
+  TelemetryExporter exporter_;
+
+  // Sampled by the network task; the UI task reports its busy time here.
+  SystemProfiler profiler_;
+  std::atomic<uint32_t> uiBusyUs_{0};
+  // Reported by the UI task after each update.
+  std::atomic<uint32_t> uiDrawUs_{0};
+  std::atomic<uint32_t> uiDrawMaxUs_{0};
 
+  bool fsReady_ = false;
   bool started_ = false;
 };
 
@@ -0,0 +1,135 @@
+#include "config_blob.h"
+
+#if !IDK_NATIVE
+#include <esp_ota_ops.h>
+#endif
+
+namespace idk {
+namespace {
+
+constexpr uint32_t kBlobMagic = 0x434B4449u;  // "IDKC" in file order
+constexpr size_t kFileChunkBytes = 256;
+
+struct BlobHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t headerBytes;
+  uint32_t payloadBytes;
+  uint32_t sourceCrc;
+  uint32_t payloadCrc;
+};
+
+}  // namespace
+
+uint32_t configCrc32(uint32_t crc, const void* data, size_t length) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  crc = ~crc;
+  for (size_t i = 0; i < length; ++i) {
+    crc ^= bytes[i];
+    for (uint8_t bit = 0; bit < 8; ++bit) {
+      crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+  }
+  return ~crc;
+}
+
+uint32_t configCrc32File(fs::FS& fs, const char* path, uint32_t crc) {
+  File file = fs.exists(path) ? fs.open(path, "r") : File();
+  if (!file) {
+    static const char kMissing[] = "<missing>";
+    return configCrc32(crc, kMissing, sizeof(kMissing));
+  }
+
+  uint8_t chunk[kFileChunkBytes];
+  size_t got = 0;
+  while ((got = file.read(chunk, sizeof(chunk))) > 0) {
+    crc = configCrc32(crc, chunk, got);
+  }
+  file.close();
+  return crc;
+}
+
+uint32_t configCrc32Build(uint32_t crc) {
+#if IDK_NATIVE
+  return configCrc32(crc, kRuntimeConfigBuildId, strlen(kRuntimeConfigBuildId));
+#else
+  const esp_app_desc_t* app = esp_ota_get_app_description();
+  return configCrc32(crc, app->app_elf_sha256, sizeof(app->app_elf_sha256));
+#endif
+}
+
+bool loadConfigBlob(fs::FS& fs, const char* path, uint32_t sourceCrc, RuntimeConfig& out, char* err,
+                    size_t errSize) {
+  if (!fs.exists(path)) {
+    snprintf(err, errSize, "no %s", path);
+    return false;
+  }
+
+  File file = fs.open(path, "r");
+  if (!file) {
+    snprintf(err, errSize, "failed to open %s", path);
+    return false;
+  }
+
+  BlobHeader header{};
+  const bool headerRead = file.read(reinterpret_cast<uint8_t*>(&header), sizeof(header)) == sizeof(header);
+  if (!headerRead || header.magic != kBlobMagic || header.headerBytes != sizeof(BlobHeader)) {
+    file.close();
+    snprintf(err, errSize, "%s: bad header", path);
+    return false;
+  }
+  if (header.version != kConfigBlobVersion || header.payloadBytes != sizeof(RuntimeConfig)) {
+    file.close();
+    snprintf(err, errSize, "%s: layout v%u/%luB, firmware v%u/%uB", path, header.version,
+             static_cast<unsigned long>(header.payloadBytes), kConfigBlobVersion,
+             static_cast<unsigned>(sizeof(RuntimeConfig)));
+    return false;
+  }
+  if (header.sourceCrc != sourceCrc) {
+    file.close();
+    snprintf(err, errSize, "%s: firmware or config JSON changed", path);
+    return false;
+  }
+
+  // Read into a scratch copy so a short or corrupt file leaves `out` alone.
+  RuntimeConfig loaded;
+  const size_t got = file.read(reinterpret_cast<uint8_t*>(&loaded), sizeof(loaded));
+  file.close();
+  if (got != sizeof(loaded) || configCrc32(0, &loaded, sizeof(loaded)) != header.payloadCrc) {
+    snprintf(err, errSize, "%s: payload CRC mismatch", path);
+    return false;
+  }
+
+  memcpy(&out, &loaded, sizeof(out));
+  return true;
+}
+
+bool saveConfigBlob(fs::FS& fs, const char* path, uint32_t sourceCrc, const RuntimeConfig& config, char* err,
+                    size_t errSize) {
+  BlobHeader header{};
+  header.magic = kBlobMagic;
+  header.version = kConfigBlobVersion;
+  header.headerBytes = sizeof(BlobHeader);
+  header.payloadBytes = sizeof(RuntimeConfig);
+  header.sourceCrc = sourceCrc;
+  header.payloadCrc = configCrc32(0, &config, sizeof(config));
+
+  File file = fs.open(path, "w");
+  if (!file) {
+    snprintf(err, errSize, "failed to open %s for write", path);
+    return false;
+  }
+
+  const size_t written = file.write(reinterpret_cast<const uint8_t*>(&header), sizeof(header)) +
+                         file.write(reinterpret_cast<const uint8_t*>(&config), sizeof(config));
+  file.close();
+  if (written != sizeof(header) + sizeof(config)) {
+    // A torn image would only fail its CRC next boot, but don't leave it.
+    fs.remove(path);
+    snprintf(err, errSize, "failed to write %s", path);
+    return false;
+  }
+  return true;
+}
+
+}  // namespace idk
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FS.h>
+
+#include "config/runtime_config.h"
+
+namespace idk {
+
+// Bump whenever a RuntimeConfig field changes meaning without changing the
+// struct size; size changes are caught by the header on their own.
+constexpr uint16_t kConfigBlobVersion = 1;
+
+// The merged RuntimeConfig as a raw image: a small header (magic, version,
+// struct size, CRC of the firmware and JSON it was built from, CRC of the
+// payload) followed by the struct bytes. Loading is one read and a CRC
+// instead of two JSON parses; any mismatch sends the caller back to the JSON.
+bool loadConfigBlob(fs::FS& fs, const char* path, uint32_t sourceCrc, RuntimeConfig& out, char* err,
+                    size_t errSize);
+bool saveConfigBlob(fs::FS& fs, const char* path, uint32_t sourceCrc, const RuntimeConfig& config, char* err,
+                    size_t errSize);
+
+// CRC-32 (IEEE), chainable: pass the previous result as `crc`, 0 to start.
+uint32_t configCrc32(uint32_t crc, const void* data, size_t length);
+// Folds the contents of `path` into `crc`; a missing file folds in a marker
+// so "no file" and "empty file" differ.
+uint32_t configCrc32File(fs::FS& fs, const char* path, uint32_t crc);
+// Folds in the running firmware's identity (its ELF SHA-256, or
+// kRuntimeConfigBuildId on the host), so an update that changes the
+// built-in defaults or clamps misses the blob.
+uint32_t configCrc32Build(uint32_t crc);
+
+}  // namespace idk
@@ -0,0 +1,105 @@
+#include "miner_tuning.h"
+
+#include <ArduinoJson.h>
+
+namespace idk {
+namespace {
+
+constexpr size_t kMaxTuningFileBytes = 1024;
+
+const char* coinKey(CoinType coin) {
+  return (coin == CoinType::BTC) ? "btc" : "ltc";
+}
+
+bool readDocument(fs::FS& fs, const char* path, JsonDocument& doc, char* err, size_t errSize) {
+  File file = fs.open(path, "r");
+  if (!file) {
+    snprintf(err, errSize, "failed to open %s", path);
+    return false;
+  }
+
+  const size_t size = file.size();
+  if (size == 0 || size > kMaxTuningFileBytes) {
+    file.close();
+    snprintf(err, errSize, "invalid tuning size");
+    return false;
+  }
+
+  char payload[kMaxTuningFileBytes + 1];
+  const size_t got = file.read(reinterpret_cast<uint8_t*>(payload), size);
+  file.close();
+  payload[got] = '\0';
+
+  const DeserializationError jsonErr = deserializeJson(doc, payload);
+  if (jsonErr) {
+    snprintf(err, errSize, "tuning parse failed: %s", jsonErr.c_str());
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+bool loadMinerTuning(fs::FS& fs, const char* path, CoinType coin, MinerTuning& out, char* err, size_t errSize) {
+  memset(&out, 0, sizeof(out));
+
+  if (!fs.exists(path)) {
+    snprintf(err, errSize, "tuning file not found: %s", path);
+    return false;
+  }
+
+  JsonDocument doc;
+  if (!readDocument(fs, path, doc, err, errSize)) {
+    return false;
+  }
+
+  JsonVariantConst entry = doc[coinKey(coin)];
+  if (entry.isNull() || entry["batch_size"].isNull() || entry["yield_every"].isNull()) {
+    snprintf(err, errSize, "no %s tuning in %s", coinToString(coin), path);
+    return false;
+  }
+
+  out.batchSize = entry["batch_size"].as<uint16_t>();
+  out.yieldEvery = entry["yield_every"].as<uint8_t>();
+  out.workers = entry["workers"] | static_cast<uint8_t>(0);
+  out.hashrate = entry["hashrate"] | 0.0f;
+  out.valid = out.batchSize > 0 && out.yieldEvery > 0;
+  if (!out.valid) {
+    snprintf(err, errSize, "invalid %s tuning", coinToString(coin));
+  }
+  return out.valid;
+}
+
+bool saveMinerTuning(fs::FS& fs, const char* path, CoinType coin, const MinerTuning& tuning, char* err,
+                     size_t errSize) {
+  // Keep the other coin's entry; a damaged file is simply rewritten.
+  JsonDocument doc;
+  if (fs.exists(path)) {
+    char ignored[8];
+    if (!readDocument(fs, path, doc, ignored, sizeof(ignored))) {
+      doc.clear();
+    }
+  }
+
+  JsonVariant entry = doc[coinKey(coin)];
+  entry["batch_size"] = tuning.batchSize;
+  entry["yield_every"] = tuning.yieldEvery;
+  entry["workers"] = tuning.workers;
+  entry["hashrate"] = tuning.hashrate;
+
+  File file = fs.open(path, "w");
+  if (!file) {
+    snprintf(err, errSize, "failed to open %s for write", path);
+    return false;
+  }
+
+  const size_t written = serializeJson(doc, file);
+  file.close();
+  if (written == 0) {
+    snprintf(err, errSize, "failed to write %s", path);
+    return false;
+  }
+  return true;
+}
+
+}  // namespace idk
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FS.h>
+
+#include "config/runtime_config.h"
+
+namespace idk {
+
+// Batch size and yield cadence found by the worker autotuner, persisted per
+// coin so later boots start from the device's own optimum.
+struct MinerTuning {
+  bool valid;
+  uint16_t batchSize;
+  // Worker tasks block for one tick after this many batches.
+  uint8_t yieldEvery;
+  uint8_t workers;
+  float hashrate;
+};
+
+bool loadMinerTuning(fs::FS& fs, const char* path, CoinType coin, MinerTuning& out, char* err, size_t errSize);
+bool saveMinerTuning(fs::FS& fs, const char* path, CoinType coin, const MinerTuning& tuning, char* err,
+                     size_t errSize);
+
+}  // namespace idk
@@ -29,11 +29,40 @@ uint16_t readPort(const JsonVariantConst& v, uint16_t fallback) {
   return fallback;
 }
 
-void mergePool(JsonVariantConst poolNode, PoolEndpointConfig& out) {
-  if (poolNode.isNull()) {
-    return;
+int hexNibble(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+bool parseFingerprint(const char* text, uint8_t out[32]) {
+  size_t nibbles = 0;
+  for (const char* p = text; *p != '\0'; ++p) {
+    if (*p == ':') {
+      continue;
+    }
+    const int v = hexNibble(*p);
+    if (v < 0 || nibbles >= 64) {
+      return false;
+    }
+    if ((nibbles & 1u) == 0) {
+      out[nibbles / 2] = static_cast<uint8_t>(v << 4);
+    } else {
+      out[nibbles / 2] |= static_cast<uint8_t>(v);
+    }
+    nibbles++;
   }
+  return nibbles == 64;
+}
 
+bool mergeEndpoint(JsonVariantConst poolNode, PoolEndpointConfig& out, char* err, size_t errSize) {
   const char* host = poolNode["host"] | nullptr;
   if (host != nullptr) {
     safeCopy(out.host, sizeof(out.host), host);
@@ -44,6 +73,51 @@ void mergePool(JsonVariantConst poolNode, PoolEndpointConfig& out) {
   if (!poolNode["tls"].isNull()) {
     out.tls = poolNode["tls"].as<bool>();
   }
+
+  JsonVariantConst pin = poolNode["pin_sha256"];
+  if (pin.is<const char*>()) {
+    const char* text = pin.as<const char*>();
+    out.pinned = text[0] != '\0';
+    if (out.pinned && !parseFingerprint(text, out.pinSha256)) {
+      snprintf(err, errSize, "invalid pin_sha256 for %s", out.host);
+      return false;
+    }
+  }
+  return true;
+}
+
+// A single object overrides the primary pool; an array replaces the whole
+// list in preference order.
+bool mergePools(JsonVariantConst poolNode, PoolListConfig& out, char* err, size_t errSize) {
+  if (poolNode.isNull()) {
+    return true;
+  }
+
+  if (!poolNode.is<JsonArrayConst>()) {
+    if (out.count == 0) {
+      out.count = 1;
+    }
+    return mergeEndpoint(poolNode, out.endpoints[0], err, errSize);
+  }
+
+  PoolListConfig list{};
+  for (JsonVariantConst item : poolNode.as<JsonArrayConst>()) {
+    if (list.count >= kMaxPoolEndpoints) {
+      break;
+    }
+    PoolEndpointConfig endpoint{};
+    endpoint.port = 3333;
+    if (!mergeEndpoint(item, endpoint, err, errSize)) {
+      return false;
+    }
+    if (endpoint.host[0] != '\0') {
+      list.endpoints[list.count++] = endpoint;
+    }
+  }
+  if (list.count > 0) {
+    out = list;
+  }
+  return true;
 }
 
 bool applyDocument(JsonDocument& doc, RuntimeConfig& cfg, char* err, size_t errSize) {
@@ -96,8 +170,10 @@ bool applyDocument(JsonDocument& doc, RuntimeConfig& cfg, char* err, size_t errS
 
   JsonVariantConst pool = doc["pool"];
   if (!pool.isNull()) {
-    mergePool(pool["btc"], cfg.btcPool);
-    mergePool(pool["ltc"], cfg.ltcPool);
+    if (!mergePools(pool["btc"], cfg.btcPools, err, errSize) ||
+        !mergePools(pool["ltc"], cfg.ltcPools, err, errSize)) {
+      return false;
+    }
   }
 
   JsonVariantConst timing = doc["timing"];
@@ -105,6 +181,9 @@ bool applyDocument(JsonDocument& doc, RuntimeConfig& cfg, char* err, size_t errS
     if (!timing["telemetry_ms"].isNull()) {
       cfg.telemetryIntervalMs = timing["telemetry_ms"].as<uint32_t>();
     }
+    if (!timing["history_ms"].isNull()) {
+      cfg.historyIntervalMs = timing["history_ms"].as<uint32_t>();
+    }
     if (!timing["ui_ms"].isNull()) {
       cfg.uiUpdateMs = timing["ui_ms"].as<uint32_t>();
     }
@@ -114,6 +193,9 @@ bool applyDocument(JsonDocument& doc, RuntimeConfig& cfg, char* err, size_t errS
     if (!timing["pool_retry_ms"].isNull()) {
       cfg.poolRetryMs = timing["pool_retry_ms"].as<uint32_t>();
     }
+    if (!timing["pool_probe_ms"].isNull()) {
+      cfg.poolProbeMs = timing["pool_probe_ms"].as<uint32_t>();
+    }
     if (!timing["keepalive_ms"].isNull()) {
       cfg.keepAliveMs = timing["keepalive_ms"].as<uint32_t>();
     }
@@ -127,6 +209,9 @@ bool applyDocument(JsonDocument& doc, RuntimeConfig& cfg, char* err, size_t errS
     if (!miner["batch_size"].isNull()) {
       cfg.minerBatchSize = constrain(miner["batch_size"].as<uint16_t>(), 32, 4096);
     }
+    if (!miner["autotune"].isNull()) {
+      cfg.minerAutotune = miner["autotune"].as<bool>();
+    }
     if (!miner["lottery_target32"].isNull()) {
       cfg.lotteryTarget32 = miner["lottery_target32"].as<uint32_t>();
     }
@@ -135,11 +220,25 @@ bool applyDocument(JsonDocument& doc, RuntimeConfig& cfg, char* err, size_t errS
     }
   }
 
+  JsonVariantConst alerts = doc["alerts"];
+  if (!alerts.isNull()) {
+    if (!alerts["stack_free_bytes"].isNull()) {
+      cfg.stackAlertBytes = alerts["stack_free_bytes"].as<uint32_t>();
+    }
+    if (!alerts["heap_free_bytes"].isNull()) {
+      cfg.heapAlertBytes = alerts["heap_free_bytes"].as<uint32_t>();
+    }
+  }
+
   return true;
 }
 
 }  // namespace
 
+#if IDK_NATIVE
+const char kRuntimeConfigBuildId[] = __DATE__ " " __TIME__;
+#endif
+
 bool loadDefaultsFromJson(const char* json, RuntimeConfig& out, char* err, size_t errSize) {
   memset(&out, 0, sizeof(out));
 
@@ -152,22 +251,30 @@ bool loadDefaultsFromJson(const char* json, RuntimeConfig& out, char* err, size_
   safeCopy(out.btcWallet, sizeof(out.btcWallet), "bc1qul2pvt0l5deykfznzkzhfjf3yj3cla2cssd54e");
   safeCopy(out.ltcWallet, sizeof(out.ltcWallet), "ltc1qcl9h4kffh8w8nr77u8la5ykn4cg59ms2lteply");
 
-  safeCopy(out.btcPool.host, sizeof(out.btcPool.host), "public-pool.io");
-  out.btcPool.port = 3333;
-  out.btcPool.tls = false;
+  safeCopy(out.btcPools.endpoints[0].host, sizeof(out.btcPools.endpoints[0].host), "public-pool.io");
+  out.btcPools.endpoints[0].port = 3333;
+  out.btcPools.endpoints[0].tls = false;
+  out.btcPools.count = 1;
 
-  safeCopy(out.ltcPool.host, sizeof(out.ltcPool.host), "rx.unmineable.com");
-  out.ltcPool.port = 3333;
-  out.ltcPool.tls = false;
+  safeCopy(out.ltcPools.endpoints[0].host, sizeof(out.ltcPools.endpoints[0].host), "rx.unmineable.com");
+  out.ltcPools.endpoints[0].port = 3333;
+  out.ltcPools.endpoints[0].tls = false;
+  out.ltcPools.count = 1;
 
   out.minerThreads = 2;
   out.minerBatchSize = 1024;
+  out.minerAutotune = true;
   out.telemetryIntervalMs = 1000;
+  out.historyIntervalMs = 5000;
   out.uiUpdateMs = 200;
   out.wifiReconnectMs = 5000;
   out.poolRetryMs = 4000;
+  out.poolProbeMs = 60000;
   out.keepAliveMs = 30000;
 
+  out.stackAlertBytes = 512;
+  out.heapAlertBytes = 16 * 1024;
+
   out.lotteryTarget32 = 0x0000FFFF;
   out.mineTarget32 = 0x00000FFF;
 
@@ -224,8 +331,8 @@ bool mergeFromFile(fs::FS& fs, const char* path, RuntimeConfig& inOut, char* err
   return mergeFromJson(payload.c_str(), inOut, err, errSize);
 }
 
-const PoolEndpointConfig& endpointForCoin(const RuntimeConfig& cfg, CoinType coin) {
-  return (coin == CoinType::BTC) ? cfg.btcPool : cfg.ltcPool;
+const PoolListConfig& poolsForCoin(const RuntimeConfig& cfg, CoinType coin) {
+  return (coin == CoinType::BTC) ? cfg.btcPools : cfg.ltcPools;
 }
 
 const char* walletForCoin(const RuntimeConfig& cfg, CoinType coin) {
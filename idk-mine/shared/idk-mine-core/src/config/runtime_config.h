@@ -14,6 +14,19 @@ struct PoolEndpointConfig {
   char host[64];
   uint16_t port;
   bool tls;
+  // Optional SHA-256 of the pool's TLS leaf certificate (JSON "pin_sha256",
+  // 64 hex digits, ':' separators allowed).
+  bool pinned;
+  uint8_t pinSha256[32];
+};
+
+constexpr uint8_t kMaxPoolEndpoints = 4;
+
+// Pools for one coin in preference order. The client connects to the
+// fastest healthy one and fails over along the list.
+struct PoolListConfig {
+  PoolEndpointConfig endpoints[kMaxPoolEndpoints];
+  uint8_t count;
 };
 
 struct RuntimeConfig {
@@ -27,17 +40,25 @@ struct RuntimeConfig {
   char btcWallet[96];
   char ltcWallet[96];
 
-  PoolEndpointConfig btcPool;
-  PoolEndpointConfig ltcPool;
+  PoolListConfig btcPools;
+  PoolListConfig ltcPools;
 
   uint8_t minerThreads;
   uint16_t minerBatchSize;
+  bool minerAutotune;
   uint32_t telemetryIntervalMs;
+  // Resolution of the on-device telemetry history (TelemetryHistory).
+  uint32_t historyIntervalMs;
   uint32_t uiUpdateMs;
   uint32_t wifiReconnectMs;
   uint32_t poolRetryMs;
+  uint32_t poolProbeMs;
   uint32_t keepAliveMs;
 
+  // Profiler alert limits: free stack of any task, heap low-water mark.
+  uint32_t stackAlertBytes;
+  uint32_t heapAlertBytes;
+
   uint32_t lotteryTarget32;
   uint32_t mineTarget32;
 
@@ -48,9 +69,15 @@ bool loadDefaultsFromJson(const char* json, RuntimeConfig& out, char* err, size_
 bool mergeFromJson(const char* json, RuntimeConfig& inOut, char* err, size_t errSize);
 bool mergeFromFile(fs::FS& fs, const char* path, RuntimeConfig& inOut, char* err, size_t errSize);
 
-const PoolEndpointConfig& endpointForCoin(const RuntimeConfig& cfg, CoinType coin);
+const PoolListConfig& poolsForCoin(const RuntimeConfig& cfg, CoinType coin);
 const char* walletForCoin(const RuntimeConfig& cfg, CoinType coin);
 const char* coinToString(CoinType coin);
 bool coinFromString(const char* value, CoinType& out);
 
+#if IDK_NATIVE
+// When runtime_config.cpp (the built-in defaults and clamps) was compiled;
+// stands in for the firmware ELF hash on the host.
+extern const char kRuntimeConfigBuildId[];
+#endif
+
 }  // namespace idk
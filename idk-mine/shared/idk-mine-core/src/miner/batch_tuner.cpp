@@ -0,0 +1,204 @@
+#include "batch_tuner.h"
+
+namespace idk {
+
+uint8_t BatchTuner::log2Floor(uint32_t value) {
+  uint8_t bits = 0;
+  while (value > 1) {
+    value >>= 1;
+    bits++;
+  }
+  return bits;
+}
+
+void BatchTuner::begin(uint16_t minBatch, uint16_t maxBatch, uint16_t batchSize, uint8_t yieldEvery, bool enabled) {
+  minBatchLog2_ = log2Floor(minBatch);
+  maxBatchLog2_ = log2Floor(maxBatch);
+  if (maxBatchLog2_ < minBatchLog2_) {
+    maxBatchLog2_ = minBatchLog2_;
+  }
+
+  batchLog2_ = log2Floor(batchSize);
+  if (batchLog2_ < minBatchLog2_) {
+    batchLog2_ = minBatchLog2_;
+  }
+  if (batchLog2_ > maxBatchLog2_) {
+    batchLog2_ = maxBatchLog2_;
+  }
+
+  yieldLog2_ = log2Floor((yieldEvery == 0) ? 1 : yieldEvery);
+  if (yieldLog2_ > log2Floor(kMaxYieldEvery)) {
+    yieldLog2_ = log2Floor(kMaxYieldEvery);
+  }
+
+  bestRate_ = 0.0f;
+  settledRate_ = 0.0f;
+  converged_ = false;
+  starvedStreak_ = 0;
+
+  if (!enabled) {
+    phase_ = Phase::Disabled;
+    return;
+  }
+
+  phase_ = Phase::Batch;
+  bestIndex_ = batchLog2_;
+  direction_ = 1;
+  baselineDone_ = false;
+  movedThisDirection_ = false;
+  startTrial();
+}
+
+void BatchTuner::resume(uint16_t batchSize, uint8_t yieldEvery) {
+  begin(1u << minBatchLog2_, 1u << maxBatchLog2_, batchSize, yieldEvery, false);
+  phase_ = Phase::Settled;
+}
+
+bool BatchTuner::onSample(float hashrate, uint32_t idleGapMs) {
+  if (phase_ == Phase::Disabled) {
+    return false;
+  }
+
+  const uint8_t batchBefore = batchLog2_;
+  const uint8_t yieldBefore = yieldLog2_;
+
+  if (phase_ == Phase::Settled) {
+    // A settled cadence can still starve IDLE later (Wi-Fi or TLS load on the
+    // same core); back the yield off one step when that persists.
+    starvedStreak_ = (idleGapMs > kMaxIdleGapMs) ? starvedStreak_ + 1 : 0;
+    if (starvedStreak_ >= kTrialSamples && yieldLog2_ > 0) {
+      yieldLog2_--;
+      starvedStreak_ = 0;
+      converged_ = true;
+    }
+    return yieldLog2_ != yieldBefore;
+  }
+
+  samplesSeen_++;
+  if (samplesSeen_ <= kSettleSamples) {
+    return false;
+  }
+
+  rateSum_ += hashrate;
+  if (idleGapMs > worstGapMs_) {
+    worstGapMs_ = idleGapMs;
+  }
+  if (samplesSeen_ < kSettleSamples + kTrialSamples) {
+    return false;
+  }
+
+  finishTrial(rateSum_ / kTrialSamples, worstGapMs_ > kMaxIdleGapMs);
+  return batchLog2_ != batchBefore || yieldLog2_ != yieldBefore;
+}
+
+uint16_t BatchTuner::batchSize() const {
+  return static_cast<uint16_t>(1u << batchLog2_);
+}
+
+uint8_t BatchTuner::yieldEvery() const {
+  return static_cast<uint8_t>(1u << yieldLog2_);
+}
+
+bool BatchTuner::settled() const {
+  return phase_ == Phase::Settled;
+}
+
+float BatchTuner::bestHashrate() const {
+  return (phase_ == Phase::Settled) ? settledRate_ : bestRate_;
+}
+
+bool BatchTuner::takeConverged() {
+  const bool converged = converged_;
+  converged_ = false;
+  return converged;
+}
+
+void BatchTuner::startTrial() {
+  samplesSeen_ = 0;
+  rateSum_ = 0.0f;
+  worstGapMs_ = 0;
+}
+
+void BatchTuner::finishTrial(float hashrate, bool starved) {
+  // A starving candidate scores zero so any candidate that lets IDLE run wins.
+  const float score = starved ? 0.0f : hashrate;
+
+  if (!baselineDone_) {
+    baselineDone_ = true;
+    bestRate_ = score;
+    bestIndex_ = axisIndex();
+    if (!tryStep(direction_)) {
+      direction_ = -1;
+      if (!tryStep(direction_)) {
+        nextPhase();
+      }
+    }
+    return;
+  }
+
+  if (score > bestRate_ * (1.0f + kMinGain)) {
+    bestRate_ = score;
+    bestIndex_ = axisIndex();
+    movedThisDirection_ = true;
+    if (!tryStep(direction_)) {
+      nextPhase();
+    }
+    return;
+  }
+
+  axisIndex() = bestIndex_;
+  if (direction_ > 0 && !movedThisDirection_) {
+    direction_ = -1;
+    if (tryStep(direction_)) {
+      return;
+    }
+  }
+  nextPhase();
+}
+
+bool BatchTuner::tryStep(int8_t direction) {
+  const int16_t next = static_cast<int16_t>(bestIndex_) + direction;
+  if (next < axisMin() || next > axisMax()) {
+    return false;
+  }
+  axisIndex() = static_cast<uint8_t>(next);
+  startTrial();
+  return true;
+}
+
+void BatchTuner::nextPhase() {
+  axisIndex() = bestIndex_;
+
+  if (phase_ == Phase::Batch) {
+    // The batch winner is the yield axis baseline; no need to measure it again.
+    phase_ = Phase::Yield;
+    bestIndex_ = yieldLog2_;
+    direction_ = 1;
+    movedThisDirection_ = false;
+    if (tryStep(direction_)) {
+      return;
+    }
+    direction_ = -1;
+    if (tryStep(direction_)) {
+      return;
+    }
+  }
+
+  phase_ = Phase::Settled;
+  settledRate_ = bestRate_;
+  converged_ = true;
+}
+
+uint8_t& BatchTuner::axisIndex() {
+  return (phase_ == Phase::Batch) ? batchLog2_ : yieldLog2_;
+}
+
+uint8_t BatchTuner::axisMin() const {
+  return (phase_ == Phase::Batch) ? minBatchLog2_ : 0;
+}
+
+uint8_t BatchTuner::axisMax() const {
+  return (phase_ == Phase::Batch) ? maxBatchLog2_ : log2Floor(kMaxYieldEvery);
+}
+
+}  // namespace idk
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <stdint.h>
+
+namespace idk {
+
+// Coordinate-descent search over worker batch size and yield cadence. Each
+// candidate runs for a few counter samples; a candidate only counts when the
+// IDLE tasks kept running (gap under kMaxIdleGapMs), and it must beat the best
+// so far by kMinGain to move the search. Batch size is settled first, then
+// the yield cadence. Both axes step in powers of two.
+class BatchTuner {
+ public:
+  static constexpr uint32_t kMaxIdleGapMs = 200;
+  static constexpr float kMinGain = 0.01f;
+  static constexpr uint8_t kMaxYieldEvery = 64;
+
+  // minBatch/maxBatch bound the batch axis; the start point is snapped to
+  // the nearest power-of-two step. A disabled tuner never moves.
+  void begin(uint16_t minBatch, uint16_t maxBatch, uint16_t batchSize, uint8_t yieldEvery, bool enabled);
+  // Call after begin(): starts settled on a stored result with only the
+  // starvation guard active.
+  void resume(uint16_t batchSize, uint8_t yieldEvery);
+
+  // Feeds one counter sample. Returns true when the setting changed and the
+  // workers should pick it up.
+  bool onSample(float hashrate, uint32_t idleGapMs);
+
+  uint16_t batchSize() const;
+  uint8_t yieldEvery() const;
+  bool settled() const;
+  float bestHashrate() const;
+  // True once per convergence (or guard adjustment) so the caller can persist.
+  bool takeConverged();
+
+ private:
+  enum class Phase : uint8_t {
+    Disabled = 0,
+    Batch = 1,
+    Yield = 2,
+    Settled = 3,
+  };
+
+  static constexpr uint8_t kSettleSamples = 1;
+  static constexpr uint8_t kTrialSamples = 3;
+
+  static uint8_t log2Floor(uint32_t value);
+
+  void startTrial();
+  void finishTrial(float hashrate, bool starved);
+  bool tryStep(int8_t direction);
+  void nextPhase();
+
+  uint8_t& axisIndex();
+  uint8_t axisMin() const;
+  uint8_t axisMax() const;
+
+  Phase phase_ = Phase::Disabled;
+  uint8_t batchLog2_ = 0;
+  uint8_t minBatchLog2_ = 0;
+  uint8_t maxBatchLog2_ = 0;
+  uint8_t yieldLog2_ = 3;
+
+  // Search state for the current axis.
+  uint8_t bestIndex_ = 0;
+  float bestRate_ = 0.0f;
+  int8_t direction_ = 1;
+  bool baselineDone_ = false;
+  bool movedThisDirection_ = false;
+
+  // Trial accumulation.
+  uint8_t samplesSeen_ = 0;
+  float rateSum_ = 0.0f;
+  uint32_t worstGapMs_ = 0;
+
+  float settledRate_ = 0.0f;
+  uint8_t starvedStreak_ = 0;
+  bool converged_ = false;
+};
+
+}  // namespace idk
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "config/runtime_config.h"
+
+// Hash kernels compiled into a firmware are picked with build flags in each
+// project's platformio.ini. Both default to on so a project without the flags
+// still builds every coin.
+#ifndef IDK_MINER_SHA256D
+#define IDK_MINER_SHA256D 1
+#endif
+
+#ifndef IDK_MINER_SCRYPT
+#define IDK_MINER_SCRYPT 1
+#endif
+
+// Nonces hashed in lockstep by the SHA-256d kernel (1, 2 or 4).
+#ifndef IDK_MINER_SHA256_LANES
+#define IDK_MINER_SHA256_LANES 1
+#endif
+
+#if IDK_MINER_SHA256_LANES != 1 && IDK_MINER_SHA256_LANES != 2 && IDK_MINER_SHA256_LANES != 4
+#error "IDK_MINER_SHA256_LANES must be 1, 2 or 4"
+#endif
+
+#if !IDK_MINER_SHA256D && !IDK_MINER_SCRYPT
+#error "idk-mine-core needs at least one of IDK_MINER_SHA256D or IDK_MINER_SCRYPT"
+#endif
+
+#if IDK_MINER_SHA256D
+#include "miner/sha256_rounds.h"
+#endif
+
+#if IDK_MINER_SCRYPT
+#include "miner/scrypt.h"
+#endif
+
+namespace idk {
+
+// Kernel policy contract used by MinerEngine::workerLoop<Kernel>:
+//   Job      per-job state prepared once from the 80-byte header
+//   Context  per-worker state owned by the engine (scratch memory)
+//   kCoin, kLanes, kMinBatch, kMaxBatch
+//   kPreemptStride  nonces between job-generation checks (power of two,
+//                   multiple of kLanes)
+//   prepare(header, job)
+//   hashLanes(job, context, nonces[kLanes], top32[kLanes])
+//   hashDigest(job, context, nonce, digest[32])  full hash, for target ties
+
+#if IDK_MINER_SHA256D
+template <uint8_t Lanes>
+struct Sha256dLanesKernel {
+  using Job = Sha256dHeaderJob;
+  struct Context {};
+
+  static constexpr CoinType kCoin = CoinType::BTC;
+  static constexpr uint8_t kLanes = Lanes;
+  static constexpr uint16_t kMinBatch = 32;
+  static constexpr uint16_t kMaxBatch = 4096;
+  // One relaxed load per 64 hashes is lost in the noise and bounds a stale
+  // tail to well under a millisecond.
+  static constexpr uint16_t kPreemptStride = 64;
+
+  static void prepare(const uint8_t header[80], Job& job) { sha256dPrepareHeader(header, job); }
+
+  static inline void hashLanes(const Job& job, Context&, const uint32_t* nonces, uint32_t* top32) {
+    if (Lanes == 1) {
+      top32[0] = sha256_rounds::headerTop32(job, nonces[0]);
+    } else {
+      sha256_rounds::headerTop32Lanes<Lanes>(job, nonces, top32);
+    }
+  }
+
+  static void hashDigest(const Job& job, Context&, uint32_t nonce, uint8_t digest[32]) {
+    sha256dHashHeader(job, nonce, digest);
+  }
+};
+
+using Sha256dKernel = Sha256dLanesKernel<IDK_MINER_SHA256_LANES>;
+#endif
+
+#if IDK_MINER_SCRYPT
+struct ScryptKernel {
+  using Job = ScryptHeaderJob;
+  using Context = ScryptScratchpad;
+
+  static constexpr CoinType kCoin = CoinType::LTC;
+  static constexpr uint8_t kLanes = 1;
+  // A scrypt hash costs ~2048 Salsa20/8 cores. Job switches are checked on
+  // every hash, so the batch only sets how far apart the yield points are;
+  // the tuner searches 8..64 from the short end under its idle-gap guard.
+  static constexpr uint16_t kMinBatch = 8;
+  static constexpr uint16_t kMaxBatch = 64;
+  static constexpr uint16_t kPreemptStride = 1;
+
+  static void prepare(const uint8_t header[80], Job& job) { scryptPrepareHeader(header, job); }
+
+  // One call per nonce is noise next to ROMix, so this stays out of line.
+  static inline void hashLanes(const Job& job, Context& scratchpad, const uint32_t* nonces, uint32_t* top32) {
+    top32[0] = scryptHeaderTop32(job, nonces[0], scratchpad);
+  }
+
+  static void hashDigest(const Job& job, Context& scratchpad, uint32_t nonce, uint8_t digest[32]) {
+    scryptHashHeader(job, nonce, scratchpad, digest);
+  }
+};
+#endif
+
+constexpr bool kernelCompiledFor(CoinType coin) {
+  return (coin == CoinType::BTC) ? (IDK_MINER_SHA256D != 0) : (IDK_MINER_SCRYPT != 0);
+}
+
+}  // namespace idk
@@ -0,0 +1,65 @@
+#include "idle_monitor.h"
+
+#include <Arduino.h>
+#include <esp_freertos_hooks.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <atomic>
+
+namespace idk {
+namespace {
+
+constexpr uint8_t kCores = 2;
+
+std::atomic<uint32_t> gLastIdleTick[kCores];
+std::atomic<uint32_t> gMaxIdleGapTicks[kCores];
+bool gInstalled = false;
+
+// Runs on every pass of the IDLE task, so it only touches its own core's slot.
+bool idleHook() {
+  const uint8_t core = (xPortGetCoreID() == 0) ? 0 : 1;
+  const uint32_t now = xTaskGetTickCount();
+  const uint32_t gap = now - gLastIdleTick[core].load(std::memory_order_relaxed);
+  if (gap > gMaxIdleGapTicks[core].load(std::memory_order_relaxed)) {
+    gMaxIdleGapTicks[core].store(gap, std::memory_order_relaxed);
+  }
+  gLastIdleTick[core].store(now, std::memory_order_relaxed);
+  return true;
+}
+
+}  // namespace
+
+void idleMonitorBegin() {
+  const uint32_t now = xTaskGetTickCount();
+  for (uint8_t core = 0; core < kCores; ++core) {
+    gLastIdleTick[core].store(now);
+    gMaxIdleGapTicks[core].store(0);
+  }
+
+  if (gInstalled) {
+    return;
+  }
+  for (uint8_t core = 0; core < kCores; ++core) {
+    esp_register_freertos_idle_hook_for_cpu(idleHook, core);
+  }
+  gInstalled = true;
+}
+
+uint32_t idleMonitorTakeMaxGapMs() {
+  const uint32_t now = xTaskGetTickCount();
+  uint32_t worst = 0;
+  for (uint8_t core = 0; core < kCores; ++core) {
+    uint32_t gap = gMaxIdleGapTicks[core].exchange(0, std::memory_order_relaxed);
+    const uint32_t open = now - gLastIdleTick[core].load(std::memory_order_relaxed);
+    if (open > gap) {
+      gap = open;
+    }
+    if (gap > worst) {
+      worst = gap;
+    }
+  }
+  return worst * portTICK_PERIOD_MS;
+}
+
+}  // namespace idk
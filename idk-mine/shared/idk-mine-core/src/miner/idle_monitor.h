@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stdint.h>
+
+namespace idk {
+
+// Tracks how long each core's IDLE task goes without running. The task
+// watchdog fires when that gap reaches its timeout, so this is the starvation
+// signal the batch tuner trades hashrate against.
+void idleMonitorBegin();
+
+// Longest IDLE gap on any core since the previous call, in ms, including a
+// gap that is still open.
+uint32_t idleMonitorTakeMaxGapMs();
+
+}  // namespace idk
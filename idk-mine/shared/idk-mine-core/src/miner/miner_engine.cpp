@@ -1,34 +1,145 @@
 #include "miner_engine.h"
 
+#include <esp_heap_caps.h>
+#include <math.h>
+
+#include "miner/idle_monitor.h"
+
 namespace idk {
+namespace {
+
+constexpr float kHashrateWindowSeconds[] = {10.0f, 60.0f, 900.0f};
+// Worker breakdown uses the short window so it tracks tuning changes quickly.
+constexpr float kWorkerWindowSeconds = 10.0f;
+
+float ewmaStep(float average, float sample, float dtSeconds, float windowSeconds) {
+  const float alpha = 1.0f - expf(-dtSeconds / windowSeconds);
+  return average + alpha * (sample - average);
+}
 
-void MinerEngine::begin(const RuntimeConfig& cfg, MinerMode mode) {
+// Workers used to block on every 8th batch; the tuner starts from there.
+constexpr uint8_t kDefaultYieldEvery = 8;
+
+// Batch bounds for the coin's kernel, kept to whole nonce-allocator granules.
+void batchLimitsFor(CoinType coin, uint16_t& minBatch, uint16_t& maxBatch) {
+  minBatch = NonceRangeAllocator::kGranule;
+  maxBatch = NonceRangeAllocator::kGranule;
+#if IDK_MINER_SHA256D
+  if (coin == CoinType::BTC) {
+    minBatch = Sha256dKernel::kMinBatch;
+    maxBatch = Sha256dKernel::kMaxBatch;
+  }
+#endif
+#if IDK_MINER_SCRYPT
+  if (coin == CoinType::LTC) {
+    minBatch = ScryptKernel::kMinBatch;
+    maxBatch = ScryptKernel::kMaxBatch;
+  }
+#endif
+  minBatch = (minBatch < NonceRangeAllocator::kGranule)
+                 ? NonceRangeAllocator::kGranule
+                 : minBatch / NonceRangeAllocator::kGranule * NonceRangeAllocator::kGranule;
+  maxBatch = (maxBatch < minBatch)
+                 ? minBatch
+                 : maxBatch / NonceRangeAllocator::kGranule * NonceRangeAllocator::kGranule;
+}
+
+// Used until the pool delivers a job so the workers hash a distinct header
+// per boot instead of idling.
+void fillRandomHeader(uint8_t header[80]) {
+  for (uint8_t i = 0; i < 80; i += 4) {
+    const uint32_t r = esp_random();
+    memcpy(header + i, &r, sizeof(r));
+  }
+}
+
+}  // namespace
+
+void MinerEngine::begin(const RuntimeConfig& cfg, MinerMode mode, const MinerTuning& tuning) {
   stop();
 
   config_ = cfg;
   mode_ = mode;
+  coin_ = cfg.defaultCoin;
 
-  totalHashes_.store(0);
-  bestHash_.store(0xFFFFFFFFu);
   blocksFound_.store(0);
-  pendingShare_.store(0);
-  pendingNonce_.store(0);
-  pendingHash_.store(0);
-  target32_.store((mode_ == MinerMode::Lottery) ? config_.lotteryTarget32 : config_.mineTarget32);
-  jobSeed_.store(esp_random());
+  shares_.reset();
+
+  PublishedWork work{};
+  fillRandomHeader(work.header);
+  work.target = fallbackTarget((mode_ == MinerMode::Lottery) ? config_.lotteryTarget32 : config_.mineTarget32);
+  publishWork(work);
 
   workerCount_ = (mode_ == MinerMode::Lottery) ? 1 : constrain(config_.minerThreads, static_cast<uint8_t>(1), kMaxWorkers);
   if (workerCount_ < 1) {
     workerCount_ = 1;
   }
 
-  lastHashTotal_ = 0;
-  lastHashrateMs_ = millis();
-  cachedHashrate_ = 0.0f;
+  if (!supportsCoin(coin_)) {
+    Serial.printf("[miner] no %s kernel in this build; workers not started\n", coinToString(coin_));
+    workerCount_ = 0;
+  }
+
+#if IDK_MINER_SCRYPT
+  if (coin_ == CoinType::LTC && workerCount_ > 0) {
+    const uint8_t wanted = workerCount_;
+    workerCount_ = reserveScratchpads(wanted);
+    if (workerCount_ < wanted) {
+      Serial.printf("[miner] scrypt scratchpads for %u/%u workers (free heap %u)\n",
+                    static_cast<unsigned>(workerCount_), static_cast<unsigned>(wanted),
+                    static_cast<unsigned>(heap_caps_get_free_size(MALLOC_CAP_8BIT)));
+    }
+  }
+#endif
+
+  // Lottery workers sleep after every batch on purpose; only mine mode is
+  // worth tuning.
+  uint16_t minBatch = 0;
+  uint16_t maxBatch = 0;
+  batchLimitsFor(coin_, minBatch, maxBatch);
+  const bool autotune = config_.minerAutotune && mode_ == MinerMode::Mine && workerCount_ > 0;
+  // miner.batch_size is validated for SHA-256d (32..4096); scrypt starts from
+  // its shortest batch and leaves lengthening it to the tuner.
+  const uint16_t startBatch = (coin_ == CoinType::LTC) ? minBatch : config_.minerBatchSize;
+  tuner_.begin(minBatch, maxBatch, startBatch, kDefaultYieldEvery, autotune);
+  if (autotune && tuning.valid && tuning.workers == workerCount_) {
+    tuner_.resume(tuning.batchSize, tuning.yieldEvery);
+    Serial.printf("[miner] tuned batch=%u yield_every=%u\n", static_cast<unsigned>(tuner_.batchSize()),
+                  static_cast<unsigned>(tuner_.yieldEvery()));
+  }
+  if (autotune) {
+    batchSize_.store(tuner_.batchSize());
+    yieldEvery_.store(tuner_.yieldEvery());
+  } else {
+    batchSize_.store(constrain(startBatch, minBatch, maxBatch) / NonceRangeAllocator::kGranule *
+                     NonceRangeAllocator::kGranule);
+    yieldEvery_.store(kDefaultYieldEvery);
+  }
+  idleMonitorBegin();
+
+  for (uint8_t i = 0; i < kMaxWorkers; ++i) {
+    counters_[i].hashes.store(0);
+    counters_[i].bestHash.store(0xFFFFFFFFu);
+    counters_[i].switchLatencyUs.store(0);
+    workerTotals_[i] = 0;
+    lastWorkerCounts_[i] = 0;
+    workerHashrate_[i] = 0.0f;
+  }
+
+  totalHashes_ = 0;
+  jobSwitchLatencyUs_ = 0;
+  maxJobSwitchLatencyUs_ = 0;
+  lastSampleMs_ = millis();
+  averagesPrimed_ = false;
+  currentHashrate_ = 0.0f;
+  for (uint8_t w = 0; w < kHashrateWindows; ++w) {
+    averageHashrate_[w] = 0.0f;
+  }
 
   running_.store(true);
   for (uint8_t i = 0; i < workerCount_; ++i) {
-    xTaskCreatePinnedToCore(workerEntry, (i == 0) ? "mine-w0" : "mine-w1", 4096, this, 1, &workers_[i], i % 2);
+    xTaskCreatePinnedToCore(workerEntry, (i == 0) ? "mine-w0" : "mine-w1", kWorkerStackBytes, this, 1, &workers_[i],
+                            i % 2);
   }
 }
 
@@ -42,35 +153,137 @@ void MinerEngine::stop() {
   }
 }
 
+void MinerEngine::setWakeListener(void (*listener)(void*), void* ctx) {
+  wakeListener_ = listener;
+  wakeContext_ = ctx;
+}
+
+void MinerEngine::wake() {
+  if (wakeListener_ != nullptr) {
+    wakeListener_(wakeContext_);
+  }
+}
+
+bool MinerEngine::supportsCoin(CoinType coin) const {
+  return kernelCompiledFor(coin);
+}
+
 void MinerEngine::updateJob(const StratumJob& job, uint32_t fallbackTarget32) {
-  uint32_t target = job.target32;
-  if (target == 0) {
-    target = fallbackTarget32;
+  PublishedWork work{};
+  memcpy(work.header, job.header, sizeof(work.header));
+  work.workId = job.workId;
+  work.target = job.hasTarget ? job.target : fallbackTarget(fallbackTarget32);
+  publishWork(work);
+}
+
+ShareTarget MinerEngine::fallbackTarget(uint32_t fallbackTarget32) const {
+  if (fallbackTarget32 == 0) {
+    fallbackTarget32 = (mode_ == MinerMode::Lottery) ? 0x0000FFFFu : 0x00000FFFu;
   }
-  if (target == 0) {
-    target = (mode_ == MinerMode::Lottery) ? 0x0000FFFFu : 0x00000FFFu;
+  ShareTarget target;
+  shareTargetFromTop32(fallbackTarget32, target);
+  return target;
+}
+
+size_t MinerEngine::takeShareCandidates(ShareCandidate* out, size_t maxCount) {
+  return shares_.popBatch(out, maxCount);
+}
+
+uint32_t MinerEngine::droppedShares() const {
+  return shares_.dropped();
+}
+
+uint8_t MinerEngine::shareQueueHighWater() const {
+  return shares_.highWater();
+}
+
+void MinerEngine::sampleCounters(uint32_t nowMs) {
+  const uint32_t elapsed = nowMs - lastSampleMs_;
+  if (elapsed == 0) {
+    return;
+  }
+  const float dt = static_cast<float>(elapsed) / 1000.0f;
+
+  uint32_t delta = 0;
+  for (uint8_t i = 0; i < kMaxWorkers; ++i) {
+    const uint32_t count = counters_[i].hashes.load(std::memory_order_relaxed);
+    const uint32_t workerDelta = count - lastWorkerCounts_[i];
+    lastWorkerCounts_[i] = count;
+    workerTotals_[i] += workerDelta;
+    delta += workerDelta;
+
+    const float workerRate = static_cast<float>(workerDelta) / dt;
+    workerHashrate_[i] =
+        averagesPrimed_ ? ewmaStep(workerHashrate_[i], workerRate, dt, kWorkerWindowSeconds) : workerRate;
   }
 
-  target32_.store(target);
-  jobSeed_.store(job.seed);
+  totalHashes_ += delta;
+
+  uint32_t switchLatency = 0;
+  for (uint8_t i = 0; i < workerCount_; ++i) {
+    const uint32_t latency = counters_[i].switchLatencyUs.load(std::memory_order_relaxed);
+    if (latency > switchLatency) {
+      switchLatency = latency;
+    }
+  }
+  jobSwitchLatencyUs_ = switchLatency;
+  if (switchLatency > maxJobSwitchLatencyUs_) {
+    maxJobSwitchLatencyUs_ = switchLatency;
+  }
+
+  currentHashrate_ = static_cast<float>(delta) / dt;
+  for (uint8_t w = 0; w < kHashrateWindows; ++w) {
+    averageHashrate_[w] = averagesPrimed_
+                              ? ewmaStep(averageHashrate_[w], currentHashrate_, dt, kHashrateWindowSeconds[w])
+                              : currentHashrate_;
+  }
+
+  averagesPrimed_ = true;
+  lastSampleMs_ = nowMs;
+
+  if (tuner_.onSample(currentHashrate_, idleMonitorTakeMaxGapMs())) {
+    batchSize_.store(tuner_.batchSize(), std::memory_order_relaxed);
+    yieldEvery_.store(tuner_.yieldEvery(), std::memory_order_relaxed);
+  }
+}
+
+uint16_t MinerEngine::batchSize() const {
+  return batchSize_.load(std::memory_order_relaxed);
+}
+
+uint8_t MinerEngine::yieldEvery() const {
+  return yieldEvery_.load(std::memory_order_relaxed);
 }
 
-bool MinerEngine::takeShareCandidate(ShareCandidate& out) {
-  if (pendingShare_.exchange(0) == 0) {
+bool MinerEngine::tuningSettled() const {
+  return tuner_.settled();
+}
+
+bool MinerEngine::takeTuningResult(MinerTuning& out) {
+  if (!tuner_.takeConverged()) {
     return false;
   }
-
-  out.nonce = pendingNonce_.load();
-  out.hash32 = pendingHash_.load();
+  out.valid = true;
+  out.batchSize = tuner_.batchSize();
+  out.yieldEvery = tuner_.yieldEvery();
+  out.workers = workerCount_;
+  out.hashrate = tuner_.bestHashrate();
   return true;
 }
 
 uint64_t MinerEngine::totalHashes() const {
-  return totalHashes_.load();
+  return totalHashes_;
 }
 
 uint32_t MinerEngine::bestHash() const {
-  return bestHash_.load();
+  uint32_t best = 0xFFFFFFFFu;
+  for (uint8_t i = 0; i < kMaxWorkers; ++i) {
+    const uint32_t workerBest = counters_[i].bestHash.load(std::memory_order_relaxed);
+    if (workerBest < best) {
+      best = workerBest;
+    }
+  }
+  return best;
 }
 
 float MinerEngine::bestDifficulty() const {
@@ -85,105 +298,261 @@ uint32_t MinerEngine::blocksFound() const {
   return blocksFound_.load();
 }
 
-float MinerEngine::currentHashrate(uint32_t nowMs) {
-  if (nowMs - lastHashrateMs_ < 1000) {
-    return cachedHashrate_;
-  }
+float MinerEngine::currentHashrate() const {
+  return currentHashrate_;
+}
 
-  const uint64_t current = totalHashes();
-  const uint64_t delta = current - lastHashTotal_;
-  const uint32_t elapsed = nowMs - lastHashrateMs_;
+float MinerEngine::averageHashrate(HashrateWindow window) const {
+  return averageHashrate_[static_cast<uint8_t>(window)];
+}
 
-  if (elapsed > 0) {
-    cachedHashrate_ = (static_cast<float>(delta) * 1000.0f) / static_cast<float>(elapsed);
+float MinerEngine::workerHashrate(uint8_t workerIndex) const {
+  if (workerIndex >= workerCount_) {
+    return 0.0f;
   }
+  return workerHashrate_[workerIndex];
+}
 
-  lastHashTotal_ = current;
-  lastHashrateMs_ = nowMs;
-  return cachedHashrate_;
+uint64_t MinerEngine::workerHashes(uint8_t workerIndex) const {
+  if (workerIndex >= kMaxWorkers) {
+    return 0;
+  }
+  return workerTotals_[workerIndex];
+}
+
+uint32_t MinerEngine::jobSwitchLatencyUs() const {
+  return jobSwitchLatencyUs_;
+}
+
+uint32_t MinerEngine::maxJobSwitchLatencyUs() const {
+  return maxJobSwitchLatencyUs_;
+}
+
+uint8_t MinerEngine::workerCount() const {
+  return workerCount_;
+}
+
+uint32_t MinerEngine::workerBusyUs(uint8_t workerIndex) const {
+  return (workerIndex < kMaxWorkers) ? counters_[workerIndex].busyUs.load(std::memory_order_relaxed) : 0;
+}
+
+uint32_t MinerEngine::firstHashUs() const {
+  return firstHashUs_.load(std::memory_order_relaxed);
+}
+
+TaskHandle_t MinerEngine::workerTask(uint8_t workerIndex) const {
+  return (workerIndex < kMaxWorkers) ? workers_[workerIndex] : nullptr;
+}
+
+float MinerEngine::nonceCoverage() const {
+  return nonceRanges_[jobGeneration_.load() & 1u].coverage();
+}
+
+bool MinerEngine::takeNonceSpaceExhausted() {
+  const uint32_t exhausted = exhaustedGeneration_.load();
+  if (exhausted == reportedExhaustedGeneration_ || exhausted != jobGeneration_.load()) {
+    return false;
+  }
+  reportedExhaustedGeneration_ = exhausted;
+  return true;
 }
 
 void MinerEngine::workerEntry(void* ctx) {
   auto* self = static_cast<MinerEngine*>(ctx);
   const uint8_t workerIndex = (xPortGetCoreID() == 0) ? 0 : 1;
-  self->workerLoop(workerIndex);
+
+  // The kernel is fixed per task, so the batch loop below is instantiated once
+  // per compiled kernel with the hash call inlined.
+#if IDK_MINER_SCRYPT
+  if (self->coin_ == CoinType::LTC) {
+    self->workerLoop<ScryptKernel>(workerIndex, self->scratchpads_[workerIndex]);
+  }
+#endif
+#if IDK_MINER_SHA256D
+  if (self->coin_ == CoinType::BTC) {
+    Sha256dKernel::Context context;
+    self->workerLoop<Sha256dKernel>(workerIndex, context);
+  }
+#endif
+
+  vTaskDelete(nullptr);
 }
 
-void MinerEngine::workerLoop(uint8_t workerIndex) {
-  uint32_t nonce = esp_random() ^ (0x9E3779B9u * (workerIndex + 1));
-  const uint16_t batchSize = constrain(config_.minerBatchSize, static_cast<uint16_t>(32), static_cast<uint16_t>(4096));
-  uint16_t yieldCounter = 0;
+template <typename Kernel>
+void MinerEngine::workerLoop(uint8_t workerIndex, typename Kernel::Context& context) {
+  uint8_t yieldCounter = 0;
+  WorkerCounters& counters = counters_[workerIndex];
+
+  PublishedWork work;
+  typename Kernel::Job job;
+  uint32_t targetTop = 0;
+  uint32_t jobGeneration = jobGeneration_.load() - 1;
+  bool firstJob = true;
+
+  static_assert((Kernel::kPreemptStride & (Kernel::kPreemptStride - 1)) == 0 &&
+                    Kernel::kPreemptStride % Kernel::kLanes == 0,
+                "kPreemptStride must be a power of two and a multiple of kLanes");
 
   while (running_.load()) {
-    const uint32_t seed = jobSeed_.load();
-    const uint32_t target = target32_.load();
+    if (jobGeneration_.load() != jobGeneration) {
+      jobGeneration = loadWork(work);
+      Kernel::prepare(work.header, job);
+      targetTop = shareTargetTop32(work.target);
+      if (!firstJob) {
+        counters.switchLatencyUs.store(micros() - publishedAtUs_.load(std::memory_order_relaxed),
+                                       std::memory_order_relaxed);
+      }
+      firstJob = false;
+    }
 
+    // The tuner keeps this a whole number of allocator granules (which every
+    // lane width divides).
+    const uint16_t batchSize = batchSize_.load(std::memory_order_relaxed);
+    uint32_t start = 0;
+    uint32_t claimed = 0;
+    if (!nonceRanges_[jobGeneration & 1u].claim(jobGeneration, batchSize, start, claimed)) {
+      // The slot's allocator was handed to a newer job; go and load it.
+      if (jobGeneration_.load() != jobGeneration) {
+        continue;
+      }
+      if (exhaustedGeneration_.exchange(jobGeneration) != jobGeneration) {
+        wake();
+      }
+      vTaskDelay(pdMS_TO_TICKS(10));
+      continue;
+    }
+    // A newer job landed while claiming; the slice is still the old job's,
+    // but that job is dead, so drop it and switch now.
+    if (jobGeneration_.load() != jobGeneration) {
+      continue;
+    }
+
+    const uint32_t batchStartUs = micros();
     uint32_t localBest = 0xFFFFFFFFu;
-    bool found = false;
-    uint32_t foundNonce = 0;
-    uint32_t foundHash = 0;
+    uint32_t hashed = 0;
 
-    for (uint16_t i = 0; i < batchSize; ++i) {
-      nonce += 0x01000193u;
-      const uint32_t hash32 = pseudoHash(seed, nonce);
+    for (; hashed < claimed; hashed += Kernel::kLanes) {
+      // Abandon the rest of the slice as soon as a newer job is published.
+      if ((hashed & (Kernel::kPreemptStride - 1)) == 0 && hashed != 0 &&
+          jobGeneration_.load(std::memory_order_relaxed) != jobGeneration) {
+        break;
+      }
 
-      if (hash32 < localBest) {
-        localBest = hash32;
+      uint32_t nonces[Kernel::kLanes];
+      uint32_t hashes[Kernel::kLanes];
+      for (uint8_t l = 0; l < Kernel::kLanes; ++l) {
+        nonces[l] = start + hashed + l;
       }
 
-      if (hash32 < target) {
-        found = true;
-        foundNonce = nonce;
-        foundHash = hash32;
+      Kernel::hashLanes(job, context, nonces, hashes);
+
+      for (uint8_t l = 0; l < Kernel::kLanes; ++l) {
+        const uint32_t hash32 = hashes[l];
+        if (hash32 < localBest) {
+          localBest = hash32;
+        }
+
+        // The upper word settles all but a tie, which needs the full digest.
+        if (hash32 > targetTop) {
+          continue;
+        }
+        if (hash32 == targetTop) {
+          uint8_t digest[32];
+          Kernel::hashDigest(job, context, nonces[l], digest);
+          if (!hashMeetsTarget(digest, work.target)) {
+            continue;
+          }
+        }
+        blocksFound_.fetch_add(1);
+        shares_.push(ShareCandidate{nonces[l], hash32, work.workId, micros()});
+        wake();
       }
     }
 
-    totalHashes_.fetch_add(batchSize);
-    updateAtomicMin(bestHash_, localBest);
-
-    if (found) {
-      blocksFound_.fetch_add(1);
-      if (pendingShare_.load() == 0) {
-        pendingNonce_.store(foundNonce);
-        pendingHash_.store(foundHash);
-        pendingShare_.store(1);
-      }
+    // Single writer per line: no read-modify-write atomics needed.
+    counters.hashes.store(counters.hashes.load(std::memory_order_relaxed) + hashed, std::memory_order_relaxed);
+    counters.busyUs.store(counters.busyUs.load(std::memory_order_relaxed) + (micros() - batchStartUs),
+                          std::memory_order_relaxed);
+    if (localBest < counters.bestHash.load(std::memory_order_relaxed)) {
+      counters.bestHash.store(localBest, std::memory_order_relaxed);
+    }
+    if (hashed != 0 && firstHashUs_.load(std::memory_order_relaxed) == 0) {
+      uint32_t unset = 0;
+      firstHashUs_.compare_exchange_strong(unset, micros(), std::memory_order_relaxed);
     }
 
     if (mode_ == MinerMode::Lottery) {
       vTaskDelay(pdMS_TO_TICKS(1));
     } else {
-      // Leave CPU time for IDLE tasks so task watchdog does not trigger.
+      // Leave CPU time for IDLE tasks so task watchdog does not trigger; the
+      // cadence comes from the tuner.
       yieldCounter++;
-      if ((yieldCounter & 0x07u) == 0) {
+      if (yieldCounter >= yieldEvery_.load(std::memory_order_relaxed)) {
+        yieldCounter = 0;
         vTaskDelay(pdMS_TO_TICKS(1));
       } else {
         taskYIELD();
       }
     }
   }
+}
 
-  vTaskDelete(nullptr);
+void MinerEngine::publishWork(const PublishedWork& work) {
+  const uint32_t generation = jobGeneration_.load();
+  const uint32_t slot = (generation + 1) & 1u;
+  // The idle slot may still be mid-copy by a worker that loaded the previous
+  // generation; order the last bump before these writes so that worker sees
+  // it moved and retries.
+  std::atomic_thread_fence(std::memory_order_release);
+  workSlots_[slot] = work;
+  nonceRanges_[slot].reset(generation + 1);
+  publishedAtUs_.store(micros(), std::memory_order_relaxed);
+  jobGeneration_.store(generation + 1);
 }
 
-uint32_t MinerEngine::pseudoHash(uint32_t seed, uint32_t nonce) {
-  uint32_t x = seed ^ (nonce * 0x9E3779B9u);
-  x ^= x >> 16;
-  x *= 0x85ebca6bu;
-  x ^= x >> 13;
-  x *= 0xc2b2ae35u;
-  x ^= x >> 16;
-  return x;
+uint32_t MinerEngine::loadWork(PublishedWork& out) const {
+  uint32_t generation = 0;
+  do {
+    generation = jobGeneration_.load();
+    memcpy(&out, &workSlots_[generation & 1u], sizeof(out));
+    std::atomic_thread_fence(std::memory_order_acquire);
+  } while (jobGeneration_.load() != generation);
+  return generation;
 }
 
-bool MinerEngine::updateAtomicMin(std::atomic<uint32_t>& target, uint32_t value) {
-  uint32_t current = target.load();
-  while (value < current) {
-    if (target.compare_exchange_weak(current, value)) {
-      return true;
+#if IDK_MINER_SCRYPT
+uint8_t MinerEngine::reserveScratchpads(uint8_t wanted) {
+  uint8_t ready = 0;
+  for (; ready < wanted; ++ready) {
+    ScryptScratchpad& pad = scratchpads_[ready];
+
+    bool complete = true;
+    for (uint8_t s = 0; s < kScryptSegmentCount; ++s) {
+      if (pad.segments[s] != nullptr) {
+        continue;
+      }
+      if (heap_caps_get_free_size(MALLOC_CAP_8BIT) < kScryptSegmentBytes + kScryptHeapReserveBytes) {
+        complete = false;
+        break;
+      }
+      pad.segments[s] =
+          static_cast<uint32_t*>(heap_caps_malloc(kScryptSegmentBytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT));
+      if (pad.segments[s] == nullptr) {
+        complete = false;
+        break;
+      }
+    }
+
+    if (!complete) {
+      for (uint8_t s = 0; s < kScryptSegmentCount; ++s) {
+        heap_caps_free(pad.segments[s]);
+        pad.segments[s] = nullptr;
+      }
+      break;
     }
   }
-  return false;
+  return ready;
 }
+#endif
 
 }  // namespace idk
@@ -6,7 +6,13 @@
 
 #include <atomic>
 
+#include "config/miner_tuning.h"
 #include "config/runtime_config.h"
+#include "miner/batch_tuner.h"
+#include "miner/hash_kernel.h"
+#include "miner/nonce_range.h"
+#include "miner/share_queue.h"
+#include "miner/share_target.h"
 #include "network/stratum_client.h"
 
 namespace idk {
@@ -16,56 +22,164 @@ enum class MinerMode : uint8_t {
   Mine = 1,
 };
 
-struct ShareCandidate {
-  uint32_t nonce;
-  uint32_t hash32;
+enum class HashrateWindow : uint8_t {
+  TenSeconds = 0,
+  OneMinute = 1,
+  FifteenMinutes = 2,
 };
 
 class MinerEngine {
  public:
-  void begin(const RuntimeConfig& cfg, MinerMode mode);
+  static constexpr uint32_t kWorkerStackBytes = 4096;
+
+  // `tuning` is a stored autotuner result for the configured coin; when it is
+  // valid for this worker count the search is skipped.
+  void begin(const RuntimeConfig& cfg, MinerMode mode, const MinerTuning& tuning);
   void stop();
 
+  // Called from the worker tasks whenever a share is queued or the nonce space
+  // runs out, so the consumer can block instead of polling. Set before begin().
+  void setWakeListener(void (*listener)(void*), void* ctx);
+
+  bool supportsCoin(CoinType coin) const;
+
+  // Uses the job's pool share target, or `fallbackTarget32` (upper hash word
+  // threshold) when the pool has not set a difficulty.
   void updateJob(const StratumJob& job, uint32_t fallbackTarget32);
 
-  bool takeShareCandidate(ShareCandidate& out);
+  size_t takeShareCandidates(ShareCandidate* out, size_t maxCount);
+  uint32_t droppedShares() const;
+  uint8_t shareQueueHighWater() const;
+
+  // Folds the per-worker counters into totals and moving averages and feeds
+  // the batch tuner. Call from a single task; the accessors below read the
+  // last sample.
+  void sampleCounters(uint32_t nowMs);
+
+  uint16_t batchSize() const;
+  uint8_t yieldEvery() const;
+  bool tuningSettled() const;
+  // True once each time the tuner converges; `out` is the result to persist.
+  bool takeTuningResult(MinerTuning& out);
 
   uint64_t totalHashes() const;
   uint32_t bestHash() const;
   float bestDifficulty() const;
   uint32_t blocksFound() const;
-  float currentHashrate(uint32_t nowMs);
+  float currentHashrate() const;
+  float averageHashrate(HashrateWindow window) const;
+  float workerHashrate(uint8_t workerIndex) const;
+  uint64_t workerHashes(uint8_t workerIndex) const;
+  uint8_t workerCount() const;
+  // Running total (wrapping) of the time a worker spent hashing, and its
+  // task, for the system profiler.
+  uint32_t workerBusyUs(uint8_t workerIndex) const;
+  TaskHandle_t workerTask(uint8_t workerIndex) const;
+  // micros() when the first batch of the first begin() finished hashing (the
+  // boot-to-first-hash time), 0 until then.
+  uint32_t firstHashUs() const;
+  // Time from a job being published to the slowest worker hashing it, for
+  // the last switch and the worst seen since begin().
+  uint32_t jobSwitchLatencyUs() const;
+  uint32_t maxJobSwitchLatencyUs() const;
+
+  // Share of the current job's nonce space handed out to workers, 0..1.
+  float nonceCoverage() const;
+  // True once per job when every nonce has been claimed and the workers are
+  // idle until a new job or extranonce arrives.
+  bool takeNonceSpaceExhausted();
 
  private:
   static void workerEntry(void* ctx);
-  void workerLoop(uint8_t workerIndex);
-
-  static uint32_t pseudoHash(uint32_t seed, uint32_t nonce);
-  static bool updateAtomicMin(std::atomic<uint32_t>& target, uint32_t value);
+  template <typename Kernel>
+  void workerLoop(uint8_t workerIndex, typename Kernel::Context& context);
+
+  // Everything a worker needs from one published job.
+  struct PublishedWork {
+    uint8_t header[80];
+    uint32_t workId;
+    ShareTarget target;
+  };
+
+  void publishWork(const PublishedWork& work);
+  uint32_t loadWork(PublishedWork& out) const;
+  ShareTarget fallbackTarget(uint32_t fallbackTarget32) const;
+  void wake();
+#if IDK_MINER_SCRYPT
+  uint8_t reserveScratchpads(uint8_t wanted);
+#endif
 
   static constexpr uint8_t kMaxWorkers = 2;
+  static constexpr uint8_t kHashrateWindows = 3;
+  // ESP32 cache lines are 32 bytes; keeping each worker's counters on their
+  // own line (and off the 64-bit libatomic lock) stops the cores contending.
+  static constexpr size_t kCounterAlign = 32;
+
+  // Written only by the owning worker with plain loads/stores, read lazily by
+  // sampleCounters(). The hash count wraps and is widened there.
+  struct alignas(kCounterAlign) WorkerCounters {
+    std::atomic<uint32_t> hashes{0};
+    std::atomic<uint32_t> bestHash{0xFFFFFFFFu};
+    std::atomic<uint32_t> switchLatencyUs{0};
+    std::atomic<uint32_t> busyUs{0};
+  };
+#if IDK_MINER_SCRYPT
+  // Heap left untouched after scratchpads for Wi-Fi buffers, task stacks and
+  // the mbedTLS handshake on stratum+tls pools.
+  static constexpr size_t kScryptHeapReserveBytes = 64 * 1024;
+#endif
 
   RuntimeConfig config_{};
   MinerMode mode_ = MinerMode::Lottery;
+  CoinType coin_ = CoinType::BTC;
   uint8_t workerCount_ = 1;
 
   std::atomic<bool> running_{false};
-  std::atomic<uint64_t> totalHashes_{0};
-  std::atomic<uint32_t> bestHash_{0xFFFFFFFFu};
   std::atomic<uint32_t> blocksFound_{0};
-
-  std::atomic<uint32_t> target32_{0x0000FFFFu};
-  std::atomic<uint32_t> jobSeed_{0};
-
-  std::atomic<uint8_t> pendingShare_{0};
-  std::atomic<uint32_t> pendingNonce_{0};
-  std::atomic<uint32_t> pendingHash_{0};
+  std::atomic<uint32_t> firstHashUs_{0};
+  WorkerCounters counters_[kMaxWorkers];
+
+  // Set by the tuner, read by workers at the top of every batch.
+  std::atomic<uint16_t> batchSize_{1024};
+  std::atomic<uint8_t> yieldEvery_{8};
+  BatchTuner tuner_;
+
+  // Two work slots published seqlock-style: the writer fills the idle slot and
+  // bumps the generation, readers retry if it moved during their copy. Each
+  // worker prepares its own kernel job when it sees a new generation.
+  PublishedWork workSlots_[2]{};
+  NonceRangeAllocator nonceRanges_[2];
+  std::atomic<uint32_t> jobGeneration_{0};
+  // micros() at the last publish, for job-switch latency.
+  std::atomic<uint32_t> publishedAtUs_{0};
+  // Generation whose nonce space ran out, and the last one reported to the
+  // network task (only touched by takeNonceSpaceExhausted).
+  std::atomic<uint32_t> exhaustedGeneration_{0xFFFFFFFFu};
+  uint32_t reportedExhaustedGeneration_ = 0xFFFFFFFFu;
+
+  ShareQueue shares_;
+  void (*wakeListener_)(void*) = nullptr;
+  void* wakeContext_ = nullptr;
 
   TaskHandle_t workers_[kMaxWorkers] = {nullptr, nullptr};
 
-  uint64_t lastHashTotal_ = 0;
-  uint32_t lastHashrateMs_ = 0;
-  float cachedHashrate_ = 0.0f;
+#if IDK_MINER_SCRYPT
+  // Allocated on the first LTC begin() and kept for the life of the firmware
+  // so the hashing loop never touches the heap.
+  ScryptScratchpad scratchpads_[kMaxWorkers]{};
+#endif
+
+  // Aggregates owned by the sampling task.
+  uint64_t totalHashes_ = 0;
+  uint64_t workerTotals_[kMaxWorkers] = {0, 0};
+  uint32_t lastWorkerCounts_[kMaxWorkers] = {0, 0};
+  uint32_t lastSampleMs_ = 0;
+  bool averagesPrimed_ = false;
+  float currentHashrate_ = 0.0f;
+  float averageHashrate_[kHashrateWindows] = {0.0f, 0.0f, 0.0f};
+  float workerHashrate_[kMaxWorkers] = {0.0f, 0.0f};
+  uint32_t jobSwitchLatencyUs_ = 0;
+  uint32_t maxJobSwitchLatencyUs_ = 0;
 };
 
 }  // namespace idk
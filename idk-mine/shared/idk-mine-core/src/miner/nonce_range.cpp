@@ -0,0 +1,47 @@
+#include "nonce_range.h"
+
+namespace idk {
+
+void NonceRangeAllocator::reset(uint32_t generation) {
+  state_.store(tagFor(generation));
+}
+
+bool NonceRangeAllocator::claim(uint32_t generation, uint32_t count, uint32_t& start, uint32_t& claimed) {
+  const uint32_t granules = (count < kGranule) ? 1 : count / kGranule;
+  const uint32_t tag = tagFor(generation);
+
+  // The tag and the counter move together, so a stale generation is turned
+  // away without consuming any of the new job's nonces, and an exhausted
+  // counter is never pushed further.
+  uint32_t state = state_.load();
+  for (;;) {
+    if ((state & ~kCountMask) != tag) {
+      return false;
+    }
+    const uint32_t first = state & kCountMask;
+    if (first >= kTotalGranules) {
+      return false;
+    }
+    const uint32_t available = kTotalGranules - first;
+    const uint32_t next = first + ((granules < available) ? granules : available);
+    if (state_.compare_exchange_weak(state, tag | next)) {
+      start = first * kGranule;
+      claimed = (next - first) * kGranule;
+      return true;
+    }
+  }
+}
+
+bool NonceRangeAllocator::exhausted() const {
+  return (state_.load() & kCountMask) >= kTotalGranules;
+}
+
+float NonceRangeAllocator::coverage() const {
+  const uint32_t used = state_.load() & kCountMask;
+  if (used >= kTotalGranules) {
+    return 1.0f;
+  }
+  return static_cast<float>(used) / static_cast<float>(kTotalGranules);
+}
+
+}  // namespace idk
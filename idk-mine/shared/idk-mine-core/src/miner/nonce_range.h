@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+
+namespace idk {
+
+// Hands out disjoint slices of one job's 32-bit nonce space to workers with a
+// single compare-exchange. Slices are counted in granules of kGranule nonces
+// so the counter cannot wrap before the space is exhausted.
+//
+// The engine keeps one allocator per work slot and reuses it every other
+// generation. The counter shares its word with a tag of the generation it was
+// last reset for, so a worker still holding the generation that used the slot
+// before cannot claim (and hash against its stale header) nonces meant for
+// the new job.
+class NonceRangeAllocator {
+ public:
+  static constexpr uint32_t kGranule = 8;
+
+  void reset(uint32_t generation);
+
+  // Claims up to `count` nonces (a multiple of kGranule) of `generation`'s
+  // job. The last slice of the space may be shorter. Returns false once every
+  // nonce has been handed out, or when the allocator now belongs to a
+  // different generation.
+  bool claim(uint32_t generation, uint32_t count, uint32_t& start, uint32_t& claimed);
+
+  bool exhausted() const;
+  // Fraction of the nonce space handed out so far, 0..1.
+  float coverage() const;
+
+ private:
+  static constexpr uint32_t kTotalGranules = 0x20000000u;  // 2^32 / kGranule
+  // Granule counter in the low 30 bits (it stops at kTotalGranules = 2^29),
+  // generation tag in the top two.
+  static constexpr uint32_t kCountMask = 0x3FFFFFFFu;
+  static constexpr uint32_t kTagShift = 30;
+
+  // Slots alternate, so the generations sharing one allocator differ by two;
+  // drop the slot bit. A worker would have to fall eight jobs behind between
+  // loading its work and claiming for the tag to alias.
+  static uint32_t tagFor(uint32_t generation) {
+    return ((generation >> 1) & 3u) << kTagShift;
+  }
+
+  std::atomic<uint32_t> state_{0};
+};
+
+}  // namespace idk
@@ -0,0 +1,217 @@
+#include "scrypt.h"
+
+#include "miner/hash_kernel.h"
+
+#if IDK_MINER_SCRYPT
+
+#include <string.h>
+
+namespace idk {
+namespace {
+
+inline uint32_t rotl(uint32_t x, uint32_t n) { return (x << n) | (x >> (32 - n)); }
+
+inline uint32_t readLe32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) |
+         (static_cast<uint32_t>(p[3]) << 24);
+}
+
+inline void writeLe32(uint8_t* p, uint32_t v) {
+  p[0] = static_cast<uint8_t>(v);
+  p[1] = static_cast<uint8_t>(v >> 8);
+  p[2] = static_cast<uint8_t>(v >> 16);
+  p[3] = static_cast<uint8_t>(v >> 24);
+}
+
+// b ^= bx; b = b + Salsa20/8(b). The sixteen state words live in locals and
+// each double round is spelled out so the compiler can keep them in
+// registers instead of indexing an array.
+inline void xorSalsa8(uint32_t b[16], const uint32_t bx[16]) {
+  uint32_t x00 = (b[0] ^= bx[0]);
+  uint32_t x01 = (b[1] ^= bx[1]);
+  uint32_t x02 = (b[2] ^= bx[2]);
+  uint32_t x03 = (b[3] ^= bx[3]);
+  uint32_t x04 = (b[4] ^= bx[4]);
+  uint32_t x05 = (b[5] ^= bx[5]);
+  uint32_t x06 = (b[6] ^= bx[6]);
+  uint32_t x07 = (b[7] ^= bx[7]);
+  uint32_t x08 = (b[8] ^= bx[8]);
+  uint32_t x09 = (b[9] ^= bx[9]);
+  uint32_t x10 = (b[10] ^= bx[10]);
+  uint32_t x11 = (b[11] ^= bx[11]);
+  uint32_t x12 = (b[12] ^= bx[12]);
+  uint32_t x13 = (b[13] ^= bx[13]);
+  uint32_t x14 = (b[14] ^= bx[14]);
+  uint32_t x15 = (b[15] ^= bx[15]);
+
+  for (uint8_t i = 0; i < 8; i += 2) {
+    // Columns.
+    x04 ^= rotl(x00 + x12, 7);
+    x08 ^= rotl(x04 + x00, 9);
+    x12 ^= rotl(x08 + x04, 13);
+    x00 ^= rotl(x12 + x08, 18);
+    x09 ^= rotl(x05 + x01, 7);
+    x13 ^= rotl(x09 + x05, 9);
+    x01 ^= rotl(x13 + x09, 13);
+    x05 ^= rotl(x01 + x13, 18);
+    x14 ^= rotl(x10 + x06, 7);
+    x02 ^= rotl(x14 + x10, 9);
+    x06 ^= rotl(x02 + x14, 13);
+    x10 ^= rotl(x06 + x02, 18);
+    x03 ^= rotl(x15 + x11, 7);
+    x07 ^= rotl(x03 + x15, 9);
+    x11 ^= rotl(x07 + x03, 13);
+    x15 ^= rotl(x11 + x07, 18);
+
+    // Rows.
+    x01 ^= rotl(x00 + x03, 7);
+    x02 ^= rotl(x01 + x00, 9);
+    x03 ^= rotl(x02 + x01, 13);
+    x00 ^= rotl(x03 + x02, 18);
+    x06 ^= rotl(x05 + x04, 7);
+    x07 ^= rotl(x06 + x05, 9);
+    x04 ^= rotl(x07 + x06, 13);
+    x05 ^= rotl(x04 + x07, 18);
+    x11 ^= rotl(x10 + x09, 7);
+    x08 ^= rotl(x11 + x10, 9);
+    x09 ^= rotl(x08 + x11, 13);
+    x10 ^= rotl(x09 + x08, 18);
+    x12 ^= rotl(x15 + x14, 7);
+    x13 ^= rotl(x12 + x15, 9);
+    x14 ^= rotl(x13 + x12, 13);
+    x15 ^= rotl(x14 + x13, 18);
+  }
+
+  b[0] += x00;
+  b[1] += x01;
+  b[2] += x02;
+  b[3] += x03;
+  b[4] += x04;
+  b[5] += x05;
+  b[6] += x06;
+  b[7] += x07;
+  b[8] += x08;
+  b[9] += x09;
+  b[10] += x10;
+  b[11] += x11;
+  b[12] += x12;
+  b[13] += x13;
+  b[14] += x14;
+  b[15] += x15;
+}
+
+// BlockMix with r=1 over the 32-word working block.
+inline void blockMix(uint32_t x[32]) {
+  xorSalsa8(x, x + 16);
+  xorSalsa8(x + 16, x);
+}
+
+inline uint32_t* scratchEntry(const ScryptScratchpad& scratchpad, uint16_t index) {
+  return scratchpad.segments[index / kScryptEntriesPerSegment] + (index % kScryptEntriesPerSegment) * kScryptBlockWords;
+}
+
+void romix(uint32_t x[32], const ScryptScratchpad& scratchpad) {
+  for (uint16_t i = 0; i < kScryptN; ++i) {
+    memcpy(scratchEntry(scratchpad, i), x, kScryptBlockWords * sizeof(uint32_t));
+    blockMix(x);
+  }
+
+  for (uint16_t i = 0; i < kScryptN; ++i) {
+    const uint32_t* v = scratchEntry(scratchpad, static_cast<uint16_t>(x[16] & (kScryptN - 1)));
+    for (uint8_t k = 0; k < kScryptBlockWords; ++k) {
+      x[k] ^= v[k];
+    }
+    blockMix(x);
+  }
+}
+
+// HMAC-SHA256 keyed with the 80-byte header. Both pad blocks are absorbed
+// once per nonce and reused for the five HMACs scrypt needs.
+struct HmacState {
+  Sha256Context inner;
+  Sha256Context outer;
+};
+
+void hmacInit(const ScryptHeaderJob& job, const uint8_t* headerTail, HmacState& out) {
+  Sha256Context keyCtx = job.keyPrefix;
+  sha256Update(keyCtx, headerTail, 16);
+
+  uint8_t key[32];
+  sha256Final(keyCtx, key);
+
+  uint8_t pad[64];
+  for (uint8_t i = 0; i < 64; ++i) {
+    pad[i] = static_cast<uint8_t>(((i < 32) ? key[i] : 0) ^ 0x36);
+  }
+  sha256Init(out.inner);
+  sha256Update(out.inner, pad, sizeof(pad));
+
+  for (uint8_t i = 0; i < 64; ++i) {
+    pad[i] ^= 0x36 ^ 0x5c;
+  }
+  sha256Init(out.outer);
+  sha256Update(out.outer, pad, sizeof(pad));
+}
+
+void hmacBlock(const HmacState& hmac, const uint8_t* msg, size_t msgLen, uint32_t blockIndex, uint8_t out[32]) {
+  const uint8_t counter[4] = {static_cast<uint8_t>(blockIndex >> 24), static_cast<uint8_t>(blockIndex >> 16),
+                              static_cast<uint8_t>(blockIndex >> 8), static_cast<uint8_t>(blockIndex)};
+
+  Sha256Context ctx = hmac.inner;
+  sha256Update(ctx, msg, msgLen);
+  sha256Update(ctx, counter, sizeof(counter));
+
+  uint8_t innerDigest[32];
+  sha256Final(ctx, innerDigest);
+
+  ctx = hmac.outer;
+  sha256Update(ctx, innerDigest, sizeof(innerDigest));
+  sha256Final(ctx, out);
+}
+
+}  // namespace
+
+void scryptPrepareHeader(const uint8_t header[80], ScryptHeaderJob& out) {
+  memcpy(out.header, header, sizeof(out.header));
+  sha256Init(out.keyPrefix);
+  sha256Update(out.keyPrefix, header, 64);
+}
+
+void scryptHashHeader(const ScryptHeaderJob& job, uint32_t nonce, const ScryptScratchpad& scratchpad,
+                      uint8_t digest[32]) {
+  uint8_t header[80];
+  memcpy(header, job.header, 76);
+  writeLe32(header + 76, nonce);
+
+  HmacState hmac;
+  hmacInit(job, header + 64, hmac);
+
+  // PBKDF2 with one iteration: B = HMAC(P, P || i) for i = 1..4.
+  uint8_t block[128];
+  for (uint8_t i = 0; i < 4; ++i) {
+    hmacBlock(hmac, header, sizeof(header), i + 1u, block + (i * 32));
+  }
+
+  uint32_t x[kScryptBlockWords];
+  for (uint8_t i = 0; i < kScryptBlockWords; ++i) {
+    x[i] = readLe32(block + (i * 4));
+  }
+
+  romix(x, scratchpad);
+
+  for (uint8_t i = 0; i < kScryptBlockWords; ++i) {
+    writeLe32(block + (i * 4), x[i]);
+  }
+
+  hmacBlock(hmac, block, sizeof(block), 1, digest);
+}
+
+uint32_t scryptHeaderTop32(const ScryptHeaderJob& job, uint32_t nonce, const ScryptScratchpad& scratchpad) {
+  uint8_t digest[32];
+  scryptHashHeader(job, nonce, scratchpad, digest);
+  return readLe32(digest + 28);
+}
+
+}  // namespace idk
+
+#endif  // IDK_MINER_SCRYPT
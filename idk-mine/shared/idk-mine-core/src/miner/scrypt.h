@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "miner/sha256.h"
+
+namespace idk {
+
+// Litecoin parameters: N=1024, r=1, p=1, 32-byte output.
+constexpr uint16_t kScryptN = 1024;
+constexpr size_t kScryptBlockWords = 32;
+constexpr size_t kScryptScratchpadBytes = kScryptN * kScryptBlockWords * sizeof(uint32_t);
+
+// The 128 KiB V array is split into equal segments so it can be placed in a
+// fragmented ESP32 heap where no single 128 KiB block is available.
+constexpr uint8_t kScryptSegmentCount = 4;
+constexpr uint16_t kScryptEntriesPerSegment = kScryptN / kScryptSegmentCount;
+constexpr size_t kScryptSegmentBytes = kScryptScratchpadBytes / kScryptSegmentCount;
+
+struct ScryptScratchpad {
+  uint32_t* segments[kScryptSegmentCount];
+};
+
+struct ScryptHeaderJob {
+  uint8_t header[80];
+  // SHA-256 state after the first 64 header bytes; the HMAC key is the hash
+  // of the full header, so only its 16-byte tail is hashed per nonce.
+  Sha256Context keyPrefix;
+};
+
+void scryptPrepareHeader(const uint8_t header[80], ScryptHeaderJob& out);
+
+// Scratchpad segments must each hold kScryptSegmentBytes.
+void scryptHashHeader(const ScryptHeaderJob& job, uint32_t nonce, const ScryptScratchpad& scratchpad,
+                      uint8_t digest[32]);
+
+// Most significant 32 bits of the hash read as a little-endian 256-bit number.
+uint32_t scryptHeaderTop32(const ScryptHeaderJob& job, uint32_t nonce, const ScryptScratchpad& scratchpad);
+
+}  // namespace idk
@@ -0,0 +1,141 @@
+#include "sha256.h"
+
+#include <string.h>
+
+#include "miner/sha256_rounds.h"
+
+namespace idk {
+namespace {
+
+using namespace sha256_rounds;
+
+inline uint32_t readBe32(const uint8_t* p) {
+  return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+         (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+inline void writeBe32(uint8_t* p, uint32_t v) {
+  p[0] = static_cast<uint8_t>(v >> 24);
+  p[1] = static_cast<uint8_t>(v >> 16);
+  p[2] = static_cast<uint8_t>(v >> 8);
+  p[3] = static_cast<uint8_t>(v);
+}
+
+}  // namespace
+
+void sha256Transform(uint32_t state[8], const uint8_t block[64]) {
+  uint32_t w[16];
+  for (uint8_t i = 0; i < 16; ++i) {
+    w[i] = readBe32(block + (i * 4));
+  }
+
+  uint32_t s[8];
+  memcpy(s, state, sizeof(s));
+  compressRounds(s, w, 0, 64);
+  for (uint8_t i = 0; i < 8; ++i) {
+    state[i] += s[i];
+  }
+}
+
+void sha256Init(Sha256Context& ctx) {
+  memcpy(ctx.state, kIv, sizeof(ctx.state));
+  ctx.totalLen = 0;
+  ctx.bufferLen = 0;
+}
+
+void sha256Update(Sha256Context& ctx, const uint8_t* data, size_t len) {
+  ctx.totalLen += len;
+
+  if (ctx.bufferLen > 0) {
+    const size_t take = (len < 64 - ctx.bufferLen) ? len : 64 - ctx.bufferLen;
+    memcpy(ctx.buffer + ctx.bufferLen, data, take);
+    ctx.bufferLen += take;
+    data += take;
+    len -= take;
+    if (ctx.bufferLen < 64) {
+      return;
+    }
+    sha256Transform(ctx.state, ctx.buffer);
+    ctx.bufferLen = 0;
+  }
+
+  while (len >= 64) {
+    sha256Transform(ctx.state, data);
+    data += 64;
+    len -= 64;
+  }
+
+  if (len > 0) {
+    memcpy(ctx.buffer, data, len);
+    ctx.bufferLen = len;
+  }
+}
+
+void sha256Final(Sha256Context& ctx, uint8_t out[32]) {
+  const uint64_t bitLen = ctx.totalLen * 8;
+
+  ctx.buffer[ctx.bufferLen++] = 0x80;
+  if (ctx.bufferLen > 56) {
+    memset(ctx.buffer + ctx.bufferLen, 0, 64 - ctx.bufferLen);
+    sha256Transform(ctx.state, ctx.buffer);
+    ctx.bufferLen = 0;
+  }
+  memset(ctx.buffer + ctx.bufferLen, 0, 56 - ctx.bufferLen);
+  writeBe32(ctx.buffer + 56, static_cast<uint32_t>(bitLen >> 32));
+  writeBe32(ctx.buffer + 60, static_cast<uint32_t>(bitLen));
+  sha256Transform(ctx.state, ctx.buffer);
+
+  for (uint8_t i = 0; i < 8; ++i) {
+    writeBe32(out + (i * 4), ctx.state[i]);
+  }
+}
+
+void sha256(const uint8_t* data, size_t len, uint8_t out[32]) {
+  Sha256Context ctx;
+  sha256Init(ctx);
+  sha256Update(ctx, data, len);
+  sha256Final(ctx, out);
+}
+
+void sha256d(const uint8_t* data, size_t len, uint8_t out[32]) {
+  uint8_t first[32];
+  sha256(data, len, first);
+  sha256(first, sizeof(first), out);
+}
+
+void sha256dPrepareHeader(const uint8_t header[80], Sha256dHeaderJob& out) {
+  memcpy(out.midstate, kIv, sizeof(out.midstate));
+  sha256Transform(out.midstate, header);
+
+  for (uint8_t i = 0; i < 3; ++i) {
+    out.tail[i] = readBe32(header + 64 + (i * 4));
+  }
+
+  memcpy(out.round3State, out.midstate, sizeof(out.round3State));
+  for (uint8_t i = 0; i < 3; ++i) {
+    compressRound(out.round3State, kK[i], out.tail[i]);
+  }
+}
+
+void sha256dHashHeader(const Sha256dHeaderJob& job, uint32_t nonce, uint8_t digest[32]) {
+  uint32_t w[16];
+  innerHash(job, nonce, w);
+  w[8] = 0x80000000u;
+  for (uint8_t i = 9; i < 15; ++i) {
+    w[i] = 0;
+  }
+  w[15] = 256u;
+
+  uint32_t s[8];
+  memcpy(s, kIv, sizeof(s));
+  compressRounds(s, w, 0, 64);
+  for (uint8_t i = 0; i < 8; ++i) {
+    writeBe32(digest + (i * 4), kIv[i] + s[i]);
+  }
+}
+
+uint32_t sha256dHeaderTop32(const Sha256dHeaderJob& job, uint32_t nonce) {
+  return headerTop32(job, nonce);
+}
+
+}  // namespace idk
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace idk {
+
+struct Sha256Context {
+  uint32_t state[8];
+  uint8_t buffer[64];
+  uint64_t totalLen;
+  size_t bufferLen;
+};
+
+void sha256Init(Sha256Context& ctx);
+void sha256Update(Sha256Context& ctx, const uint8_t* data, size_t len);
+void sha256Final(Sha256Context& ctx, uint8_t out[32]);
+void sha256(const uint8_t* data, size_t len, uint8_t out[32]);
+void sha256d(const uint8_t* data, size_t len, uint8_t out[32]);
+void sha256Transform(uint32_t state[8], const uint8_t block[64]);
+
+// 80-byte block header prepared for nonce scanning. The first 64 bytes never
+// change inside a job, so they are folded into a midstate once; the second
+// block only differs in its nonce word (W3), which lets the first three
+// rounds be precomputed as well.
+struct Sha256dHeaderJob {
+  uint32_t midstate[8];
+  uint32_t tail[3];
+  uint32_t round3State[8];
+};
+
+void sha256dPrepareHeader(const uint8_t header[80], Sha256dHeaderJob& out);
+
+// Full double hash; digest is in SHA-256 output byte order.
+void sha256dHashHeader(const Sha256dHeaderJob& job, uint32_t nonce, uint8_t digest[32]);
+
+// Most significant 32 bits of the header hash read as a little-endian
+// 256-bit number, which is what share targets are compared against. The last
+// three rounds of the outer hash do not affect this word and are skipped.
+uint32_t sha256dHeaderTop32(const Sha256dHeaderJob& job, uint32_t nonce);
+
+}  // namespace idk
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#include "miner/sha256.h"
+
+// SHA-256 round primitives shared by sha256.cpp and the inlined hash kernels
+// in hash_kernel.h, so the per-nonce path compiles into the batch loop.
+
+namespace idk {
+namespace sha256_rounds {
+
+constexpr uint32_t kK[64] = {
+    0x428a2f98u, 0x71374491u, 0xb5c0fbcfu, 0xe9b5dba5u, 0x3956c25bu, 0x59f111f1u, 0x923f82a4u, 0xab1c5ed5u,
+    0xd807aa98u, 0x12835b01u, 0x243185beu, 0x550c7dc3u, 0x72be5d74u, 0x80deb1feu, 0x9bdc06a7u, 0xc19bf174u,
+    0xe49b69c1u, 0xefbe4786u, 0x0fc19dc6u, 0x240ca1ccu, 0x2de92c6fu, 0x4a7484aau, 0x5cb0a9dcu, 0x76f988dau,
+    0x983e5152u, 0xa831c66du, 0xb00327c8u, 0xbf597fc7u, 0xc6e00bf3u, 0xd5a79147u, 0x06ca6351u, 0x14292967u,
+    0x27b70a85u, 0x2e1b2138u, 0x4d2c6dfcu, 0x53380d13u, 0x650a7354u, 0x766a0abbu, 0x81c2c92eu, 0x92722c85u,
+    0xa2bfe8a1u, 0xa81a664bu, 0xc24b8b70u, 0xc76c51a3u, 0xd192e819u, 0xd6990624u, 0xf40e3585u, 0x106aa070u,
+    0x19a4c116u, 0x1e376c08u, 0x2748774cu, 0x34b0bcb5u, 0x391c0cb3u, 0x4ed8aa4au, 0x5b9cca4fu, 0x682e6ff3u,
+    0x748f82eeu, 0x78a5636fu, 0x84c87814u, 0x8cc70208u, 0x90befffau, 0xa4506cebu, 0xbef9a3f7u, 0xc67178f2u,
+};
+
+constexpr uint32_t kIv[8] = {
+    0x6a09e667u, 0xbb67ae85u, 0x3c6ef372u, 0xa54ff53au, 0x510e527fu, 0x9b05688cu, 0x1f83d9abu, 0x5be0cd19u,
+};
+
+inline uint32_t rotr(uint32_t x, uint32_t n) { return (x >> n) | (x << (32 - n)); }
+inline uint32_t bigSigma0(uint32_t x) { return rotr(x, 2) ^ rotr(x, 13) ^ rotr(x, 22); }
+inline uint32_t bigSigma1(uint32_t x) { return rotr(x, 6) ^ rotr(x, 11) ^ rotr(x, 25); }
+inline uint32_t smallSigma0(uint32_t x) { return rotr(x, 7) ^ rotr(x, 18) ^ (x >> 3); }
+inline uint32_t smallSigma1(uint32_t x) { return rotr(x, 17) ^ rotr(x, 19) ^ (x >> 10); }
+inline uint32_t choose(uint32_t e, uint32_t f, uint32_t g) { return g ^ (e & (f ^ g)); }
+inline uint32_t majority(uint32_t a, uint32_t b, uint32_t c) { return (a & b) | (c & (a | b)); }
+
+inline uint32_t byteSwap32(uint32_t v) {
+  return (v >> 24) | ((v >> 8) & 0x0000FF00u) | ((v << 8) & 0x00FF0000u) | (v << 24);
+}
+
+// s[0..7] = a..h. One compression round with the schedule word already known.
+inline void compressRound(uint32_t* s, uint32_t k, uint32_t w) {
+  const uint32_t t1 = s[7] + bigSigma1(s[4]) + choose(s[4], s[5], s[6]) + k + w;
+  const uint32_t t2 = bigSigma0(s[0]) + majority(s[0], s[1], s[2]);
+  s[7] = s[6];
+  s[6] = s[5];
+  s[5] = s[4];
+  s[4] = s[3] + t1;
+  s[3] = s[2];
+  s[2] = s[1];
+  s[1] = s[0];
+  s[0] = t1 + t2;
+}
+
+// Runs rounds [first, last) over a 16-word schedule window that is expanded in
+// place. Rounds before `first` must already have been applied to `s`.
+inline void compressRounds(uint32_t* s, uint32_t* w, uint8_t first, uint8_t last) {
+  for (uint8_t i = first; i < last; ++i) {
+    if (i >= 16) {
+      w[i & 15] += smallSigma1(w[(i - 2) & 15]) + w[(i - 7) & 15] + smallSigma0(w[(i - 15) & 15]);
+    }
+    compressRound(s, kK[i], w[i & 15]);
+  }
+}
+
+// Inner hash of the nonce block: returns the eight words of SHA-256(header).
+inline void innerHash(const Sha256dHeaderJob& job, uint32_t nonce, uint32_t out[8]) {
+  uint32_t w[16] = {job.tail[0], job.tail[1], job.tail[2], byteSwap32(nonce), 0x80000000u, 0, 0, 0,
+                    0,           0,           0,           0,                  0,           0, 0, 640u};
+  uint32_t s[8];
+  memcpy(s, job.round3State, sizeof(s));
+  compressRounds(s, w, 3, 64);
+  for (uint8_t i = 0; i < 8; ++i) {
+    out[i] = job.midstate[i] + s[i];
+  }
+}
+
+// Outer hash of sha256dHeaderTop32. After round 60, e shifts unchanged into h
+// by the end of round 63, so the last three rounds are skipped.
+inline uint32_t headerTop32(const Sha256dHeaderJob& job, uint32_t nonce) {
+  uint32_t w[16];
+  innerHash(job, nonce, w);
+  w[8] = 0x80000000u;
+  for (uint8_t i = 9; i < 15; ++i) {
+    w[i] = 0;
+  }
+  w[15] = 256u;
+
+  uint32_t s[8];
+  memcpy(s, kIv, sizeof(s));
+  compressRounds(s, w, 0, 61);
+  return byteSwap32(kIv[7] + s[4]);
+}
+
+// Lane-interleaved variants: Lanes independent nonces advance through each
+// round together. State is laid out [word][lane] so one round touches each
+// lane's copy back to back and the dependency chains of different nonces
+// can overlap in the pipeline.
+template <uint8_t Lanes>
+inline void compressRoundsLanes(uint32_t (*s)[Lanes], uint32_t (*w)[Lanes], uint8_t first, uint8_t last) {
+  for (uint8_t i = first; i < last; ++i) {
+    uint32_t* wi = w[i & 15];
+    if (i >= 16) {
+      const uint32_t* w2 = w[(i - 2) & 15];
+      const uint32_t* w7 = w[(i - 7) & 15];
+      const uint32_t* w15 = w[(i - 15) & 15];
+      for (uint8_t l = 0; l < Lanes; ++l) {
+        wi[l] += smallSigma1(w2[l]) + w7[l] + smallSigma0(w15[l]);
+      }
+    }
+
+    for (uint8_t l = 0; l < Lanes; ++l) {
+      const uint32_t t1 = s[7][l] + bigSigma1(s[4][l]) + choose(s[4][l], s[5][l], s[6][l]) + kK[i] + wi[l];
+      const uint32_t t2 = bigSigma0(s[0][l]) + majority(s[0][l], s[1][l], s[2][l]);
+      s[7][l] = s[6][l];
+      s[6][l] = s[5][l];
+      s[5][l] = s[4][l];
+      s[4][l] = s[3][l] + t1;
+      s[3][l] = s[2][l];
+      s[2][l] = s[1][l];
+      s[1][l] = s[0][l];
+      s[0][l] = t1 + t2;
+    }
+  }
+}
+
+template <uint8_t Lanes>
+inline void headerTop32Lanes(const Sha256dHeaderJob& job, const uint32_t* nonces, uint32_t* out) {
+  uint32_t w[16][Lanes];
+  uint32_t s[8][Lanes];
+
+  for (uint8_t l = 0; l < Lanes; ++l) {
+    w[0][l] = job.tail[0];
+    w[1][l] = job.tail[1];
+    w[2][l] = job.tail[2];
+    w[3][l] = byteSwap32(nonces[l]);
+    w[4][l] = 0x80000000u;
+    for (uint8_t k = 5; k < 15; ++k) {
+      w[k][l] = 0;
+    }
+    w[15][l] = 640u;
+    for (uint8_t k = 0; k < 8; ++k) {
+      s[k][l] = job.round3State[k];
+    }
+  }
+  compressRoundsLanes<Lanes>(s, w, 3, 64);
+
+  for (uint8_t l = 0; l < Lanes; ++l) {
+    for (uint8_t k = 0; k < 8; ++k) {
+      w[k][l] = job.midstate[k] + s[k][l];
+      s[k][l] = kIv[k];
+    }
+    w[8][l] = 0x80000000u;
+    for (uint8_t k = 9; k < 15; ++k) {
+      w[k][l] = 0;
+    }
+    w[15][l] = 256u;
+  }
+  compressRoundsLanes<Lanes>(s, w, 0, 61);
+
+  for (uint8_t l = 0; l < Lanes; ++l) {
+    out[l] = byteSwap32(kIv[7] + s[4][l]);
+  }
+}
+
+}  // namespace sha256_rounds
+}  // namespace idk
@@ -0,0 +1,84 @@
+#include "share_queue.h"
+
+namespace idk {
+
+ShareQueue::ShareQueue() {
+  reset();
+}
+
+void ShareQueue::reset() {
+  for (uint8_t i = 0; i < kCapacity; ++i) {
+    cells_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+  head_.store(0, std::memory_order_relaxed);
+  tail_.store(0, std::memory_order_relaxed);
+  dropped_.store(0, std::memory_order_relaxed);
+  highWater_.store(0, std::memory_order_release);
+}
+
+bool ShareQueue::push(const ShareCandidate& share) {
+  uint32_t pos = head_.load(std::memory_order_relaxed);
+  Cell* cell = nullptr;
+
+  while (true) {
+    cell = &cells_[pos & (kCapacity - 1)];
+    const uint32_t sequence = cell->sequence.load(std::memory_order_acquire);
+    const int32_t diff = static_cast<int32_t>(sequence - pos);
+    if (diff == 0) {
+      if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    } else {
+      pos = head_.load(std::memory_order_relaxed);
+    }
+  }
+
+  cell->value = share;
+  cell->sequence.store(pos + 1, std::memory_order_release);
+
+  const uint32_t depthNow = pos + 1 - tail_.load(std::memory_order_relaxed);
+  uint8_t seen = highWater_.load(std::memory_order_relaxed);
+  while (depthNow > seen && !highWater_.compare_exchange_weak(seen, static_cast<uint8_t>(depthNow))) {
+  }
+  return true;
+}
+
+bool ShareQueue::pop(ShareCandidate& out) {
+  const uint32_t pos = tail_.load(std::memory_order_relaxed);
+  Cell& cell = cells_[pos & (kCapacity - 1)];
+  const uint32_t sequence = cell.sequence.load(std::memory_order_acquire);
+  if (static_cast<int32_t>(sequence - (pos + 1)) < 0) {
+    return false;
+  }
+
+  out = cell.value;
+  cell.sequence.store(pos + kCapacity, std::memory_order_release);
+  tail_.store(pos + 1, std::memory_order_relaxed);
+  return true;
+}
+
+size_t ShareQueue::popBatch(ShareCandidate* out, size_t maxCount) {
+  size_t count = 0;
+  while (count < maxCount && pop(out[count])) {
+    count++;
+  }
+  return count;
+}
+
+uint32_t ShareQueue::dropped() const {
+  return dropped_.load(std::memory_order_relaxed);
+}
+
+uint8_t ShareQueue::depth() const {
+  const uint32_t depthNow = head_.load(std::memory_order_relaxed) - tail_.load(std::memory_order_relaxed);
+  return static_cast<uint8_t>((depthNow > kCapacity) ? kCapacity : depthNow);
+}
+
+uint8_t ShareQueue::highWater() const {
+  return highWater_.load(std::memory_order_relaxed);
+}
+
+}  // namespace idk
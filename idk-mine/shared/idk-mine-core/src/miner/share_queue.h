@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+namespace idk {
+
+struct ShareCandidate {
+  uint32_t nonce;
+  uint32_t hash32;
+  // StratumJob::workId of the header the nonce was found on.
+  uint32_t workId;
+  // micros() when the worker queued it.
+  uint32_t foundUs;
+};
+
+// Bounded lock-free multi-producer / single-consumer ring. Every cell carries
+// a sequence number, so producers only contend on the head index and a
+// candidate is published whole (nonce and hash cannot tear). Workers push,
+// the network task pops; a push into a full ring is counted and dropped.
+class ShareQueue {
+ public:
+  static constexpr uint8_t kCapacity = 16;
+
+  ShareQueue();
+
+  void reset();
+  bool push(const ShareCandidate& share);
+  bool pop(ShareCandidate& out);
+  size_t popBatch(ShareCandidate* out, size_t maxCount);
+
+  uint32_t dropped() const;
+  uint8_t depth() const;
+  uint8_t highWater() const;
+
+ private:
+  struct Cell {
+    std::atomic<uint32_t> sequence;
+    ShareCandidate value;
+  };
+
+  static_assert((kCapacity & (kCapacity - 1)) == 0, "ShareQueue capacity must be a power of two");
+
+  Cell cells_[kCapacity];
+  std::atomic<uint32_t> head_{0};
+  std::atomic<uint32_t> tail_{0};
+  std::atomic<uint32_t> dropped_{0};
+  std::atomic<uint8_t> highWater_{0};
+};
+
+}  // namespace idk
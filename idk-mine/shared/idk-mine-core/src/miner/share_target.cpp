@@ -0,0 +1,79 @@
+#include "share_target.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace idk {
+
+void shareTargetFromDifficulty(double difficulty, uint16_t diff1Shift, ShareTarget& out) {
+  memset(&out, 0, sizeof(out));
+  if (!(difficulty > 0.0)) {
+    difficulty = 1.0;
+  }
+
+  // 0xFFFF / difficulty = mantissa * 2^exponent with a 53-bit integer
+  // mantissa, so the quotient keeps every bit the double carries.
+  int exponent = 0;
+  const double fraction = frexp(65535.0 / difficulty, &exponent);
+  const uint64_t mantissa = static_cast<uint64_t>(ldexp(fraction, 53));
+  const int shift = exponent - 53 + diff1Shift;
+
+  if (shift + 53 > 256) {
+    memset(out.words, 0xFF, sizeof(out.words));
+    return;
+  }
+
+  for (uint8_t bit = 0; bit < 53; ++bit) {
+    if ((mantissa >> bit) & 1u) {
+      const int position = bit + shift;
+      if (position >= 0) {
+        out.words[position / 32] |= 1u << (position % 32);
+      }
+    }
+  }
+}
+
+void shareTargetFromTop32(uint32_t top32, ShareTarget& out) {
+  memset(out.words, 0xFF, sizeof(out.words));
+  out.words[7] = top32 - 1;
+}
+
+uint32_t shareTargetTop32(const ShareTarget& target) {
+  return target.words[7];
+}
+
+bool hashMeetsTarget(const uint8_t digest[32], const ShareTarget& target) {
+  for (int8_t i = 7; i >= 0; --i) {
+    const uint8_t* p = digest + i * 4;
+    const uint32_t word = static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+                          (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    if (word != target.words[i]) {
+      return word < target.words[i];
+    }
+  }
+  return true;
+}
+
+double shareTargetProbability(const ShareTarget& target) {
+  double value = 0.0;
+  for (int8_t i = 7; i >= 0; --i) {
+    value = value * 4294967296.0 + target.words[i];
+  }
+  return ldexp(value, -256);
+}
+
+void formatShareTarget(const ShareTarget& target, char* out, size_t outSize) {
+  if (out == nullptr || outSize == 0) {
+    return;
+  }
+
+  size_t pos = 0;
+  for (int8_t i = 7; i >= 0 && pos + 8 < outSize; --i) {
+    snprintf(out + pos, outSize - pos, "%08lx", static_cast<unsigned long>(target.words[i]));
+    pos += 8;
+  }
+  out[pos] = '\0';
+}
+
+}  // namespace idk
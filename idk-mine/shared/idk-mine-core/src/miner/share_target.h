@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace idk {
+
+// Pool difficulty 1 is 0xFFFF << shift. Scrypt pools scale share difficulty
+// by 2^16 relative to SHA-256d ones.
+constexpr uint16_t kDiff1ShiftSha256d = 208;
+constexpr uint16_t kDiff1ShiftScrypt = 224;
+
+// 256-bit share target as little-endian 32-bit words (words[7] is the most
+// significant), the order hash digests are compared in. A hash meets the
+// target when, read as a little-endian number, it is <= the target.
+struct ShareTarget {
+  uint32_t words[8];
+};
+
+// target = (0xFFFF << diff1Shift) / difficulty, saturating at 2^256 - 1.
+// Non-positive difficulties yield the difficulty-1 target.
+void shareTargetFromDifficulty(double difficulty, uint16_t diff1Shift, ShareTarget& out);
+
+// Target accepting exactly the hashes whose upper 32 bits are below `top32`
+// (the local lottery/mine thresholds). `top32` must be non-zero.
+void shareTargetFromTop32(uint32_t top32, ShareTarget& out);
+
+// Upper 32 bits of the target. Hashes whose upper word is below it always
+// meet the target and hashes above it never do; only a tie needs the full
+// digest, so workers filter on this word alone.
+uint32_t shareTargetTop32(const ShareTarget& target);
+
+bool hashMeetsTarget(const uint8_t digest[32], const ShareTarget& target);
+
+// Probability that one hash meets the target.
+double shareTargetProbability(const ShareTarget& target);
+
+// Most significant words as hex, big-endian like block explorers show,
+// truncated to whole words that fit in `out`.
+void formatShareTarget(const ShareTarget& target, char* out, size_t outSize);
+
+}  // namespace idk
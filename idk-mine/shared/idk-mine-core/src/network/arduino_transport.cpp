@@ -0,0 +1,88 @@
+// Device only; native builds use PosixStratumTransport and have no mbedtls.
+#if !IDK_NATIVE
+
+#include "arduino_transport.h"
+
+namespace idk {
+
+bool ArduinoStratumTransport::connect(const PoolEndpointConfig& endpoint, uint32_t timeoutMs) {
+  close();
+
+  usingTls_ = endpoint.tls;
+  bool ok = false;
+  if (usingTls_) {
+    tls_.setPin(endpoint.pinned ? endpoint.pinSha256 : nullptr);
+    tls_.setHandshakeTimeout(timeoutMs);
+    ok = tls_.connect(endpoint.host, endpoint.port) != 0;
+    active_ = &tls_;
+  } else {
+    ok = tcp_.connect(endpoint.host, endpoint.port, static_cast<int32_t>(timeoutMs)) != 0;
+    active_ = &tcp_;
+  }
+
+  if (!ok) {
+    active_ = nullptr;
+  }
+  return ok;
+}
+
+void ArduinoStratumTransport::close() {
+  if (active_ != nullptr) {
+    active_->stop();
+  }
+  active_ = nullptr;
+}
+
+bool ArduinoStratumTransport::connected() {
+  return active_ != nullptr && active_->connected();
+}
+
+int ArduinoStratumTransport::available() {
+  return (active_ != nullptr) ? active_->available() : 0;
+}
+
+int ArduinoStratumTransport::read(uint8_t* buf, size_t len) {
+  return (active_ != nullptr) ? active_->read(buf, len) : -1;
+}
+
+size_t ArduinoStratumTransport::write(const uint8_t* buf, size_t len) {
+  return (active_ != nullptr) ? active_->write(buf, len) : 0;
+}
+
+bool ArduinoStratumTransport::linkUp() {
+  return WiFi.status() == WL_CONNECTED;
+}
+
+bool ArduinoStratumTransport::probe(const PoolEndpointConfig& endpoint, uint32_t timeoutMs, uint32_t& connectMs) {
+  // Plain TCP even for TLS endpoints: only the handshake time matters.
+  WiFiClient probe;
+  const uint32_t startMs = millis();
+  const bool ok = probe.connect(endpoint.host, endpoint.port, static_cast<int32_t>(timeoutMs)) != 0;
+  connectMs = millis() - startMs;
+  probe.stop();
+  return ok;
+}
+
+int ArduinoStratumTransport::socketFd() const {
+  if (active_ == nullptr) {
+    return -1;
+  }
+  return usingTls_ ? tls_.fd() : tcp_.fd();
+}
+
+uint32_t ArduinoStratumTransport::lastHandshakeMs() const {
+  return usingTls_ ? tls_.lastHandshakeMs() : 0;
+}
+
+StratumTransportStats ArduinoStratumTransport::stats() const {
+  StratumTransportStats out{};
+  out.handshakeMs = tls_.lastHandshakeMs();
+  out.fullHandshakes = tls_.fullHandshakes();
+  out.resumedHandshakes = tls_.resumedHandshakes();
+  out.pinFailures = tls_.pinFailures();
+  return out;
+}
+
+}  // namespace idk
+
+#endif  // !IDK_NATIVE
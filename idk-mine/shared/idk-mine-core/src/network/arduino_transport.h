@@ -0,0 +1,34 @@
+#pragma once
+
+#include <Arduino.h>
+#include <WiFi.h>
+
+#include "network/stratum_transport.h"
+#include "network/tls_client.h"
+
+namespace idk {
+
+// Device transport: WiFiClient for stratum+tcp, TlsClient (with session
+// resumption and optional pinning) for stratum+tls.
+class ArduinoStratumTransport : public StratumTransport {
+ public:
+  bool connect(const PoolEndpointConfig& endpoint, uint32_t timeoutMs) override;
+  void close() override;
+  bool connected() override;
+  int available() override;
+  int read(uint8_t* buf, size_t len) override;
+  size_t write(const uint8_t* buf, size_t len) override;
+  bool linkUp() override;
+  bool probe(const PoolEndpointConfig& endpoint, uint32_t timeoutMs, uint32_t& connectMs) override;
+  int socketFd() const override;
+  uint32_t lastHandshakeMs() const override;
+  StratumTransportStats stats() const override;
+
+ private:
+  WiFiClient tcp_;
+  TlsClient tls_;
+  Client* active_ = nullptr;
+  bool usingTls_ = false;
+};
+
+}  // namespace idk
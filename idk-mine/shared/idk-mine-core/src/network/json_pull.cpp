@@ -0,0 +1,473 @@
+#include "json_pull.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace idk {
+namespace {
+
+bool isWhitespace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+bool isDelimiter(char c) {
+  return c == ',' || c == ']' || c == '}' || c == ':' || isWhitespace(c);
+}
+
+int hexNibble(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+bool readHex4(const char* p, uint32_t& out) {
+  out = 0;
+  for (uint8_t i = 0; i < 4; ++i) {
+    const int nibble = hexNibble(p[i]);
+    if (nibble < 0) {
+      return false;
+    }
+    out = (out << 4) | static_cast<uint32_t>(nibble);
+  }
+  return true;
+}
+
+// Encoded length never exceeds the escape it replaces (\uXXXX -> <= 3 bytes,
+// a surrogate pair -> 4), so in-place decoding cannot overrun the reader.
+size_t writeUtf8(char* out, uint32_t code) {
+  if (code < 0x80) {
+    out[0] = static_cast<char>(code);
+    return 1;
+  }
+  if (code < 0x800) {
+    out[0] = static_cast<char>(0xC0 | (code >> 6));
+    out[1] = static_cast<char>(0x80 | (code & 0x3F));
+    return 2;
+  }
+  if (code < 0x10000) {
+    out[0] = static_cast<char>(0xE0 | (code >> 12));
+    out[1] = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+    out[2] = static_cast<char>(0x80 | (code & 0x3F));
+    return 3;
+  }
+  out[0] = static_cast<char>(0xF0 | (code >> 18));
+  out[1] = static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+  out[2] = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+  out[3] = static_cast<char>(0x80 | (code & 0x3F));
+  return 4;
+}
+
+enum class Expect : uint8_t {
+  Value,
+  ValueOrClose,
+  Key,
+  KeyOrClose,
+  Colon,
+  CommaOrClose,
+  End,
+};
+
+}  // namespace
+
+bool JsonPull::parse(char* text, size_t len) {
+  text_ = text;
+  len_ = len;
+  count_ = 0;
+  error_ = nullptr;
+
+  if (text == nullptr || len == 0) {
+    return fail("empty");
+  }
+  if (len > 0xFFFF) {
+    return fail("too long");
+  }
+
+  uint16_t stack[kMaxDepth];
+  uint8_t depth = 0;
+  Expect expect = Expect::Value;
+  size_t pos = 0;
+
+  while (true) {
+    while (pos < len && isWhitespace(text[pos])) {
+      pos++;
+    }
+    if (pos >= len) {
+      break;
+    }
+
+    const char c = text[pos];
+    const bool inObject = depth > 0 && tokens_[stack[depth - 1]].type == JsonType::Object;
+
+    if (expect == Expect::Colon) {
+      if (c != ':') {
+        return fail("expected ':'");
+      }
+      pos++;
+      expect = Expect::Value;
+      continue;
+    }
+
+    if (expect == Expect::CommaOrClose) {
+      if (c == ',') {
+        pos++;
+        expect = inObject ? Expect::Key : Expect::Value;
+        continue;
+      }
+      if ((c == '}' && !inObject) || (c == ']' && inObject) || (c != '}' && c != ']')) {
+        return fail("expected ',' or close");
+      }
+    }
+
+    if (c == '}' || c == ']') {
+      const bool closesObject = (c == '}');
+      const bool allowed = (expect == Expect::CommaOrClose) || (closesObject && expect == Expect::KeyOrClose) ||
+                           (!closesObject && expect == Expect::ValueOrClose);
+      if (!allowed || depth == 0 || inObject != closesObject) {
+        return fail("unexpected close");
+      }
+      Token& container = tokens_[stack[--depth]];
+      container.next = count_;
+      container.length = static_cast<uint16_t>(pos + 1 - container.start);
+      pos++;
+      expect = (depth == 0) ? Expect::End : Expect::CommaOrClose;
+      continue;
+    }
+
+    if (expect == Expect::End) {
+      return fail("trailing data");
+    }
+
+    if (expect == Expect::Key || expect == Expect::KeyOrClose) {
+      if (c != '"') {
+        return fail("expected key");
+      }
+      uint16_t start = 0;
+      uint16_t length = 0;
+      if (!parseString(pos, start, length)) {
+        return false;
+      }
+      const int16_t key = addToken(JsonType::String, start, static_cast<int16_t>(stack[depth - 1]));
+      if (key < 0) {
+        return false;
+      }
+      tokens_[key].length = length;
+      tokens_[stack[depth - 1]].size++;
+      expect = Expect::Colon;
+      continue;
+    }
+
+    // A value. Members of an object were already counted through their key.
+    const int16_t parent = (depth > 0) ? static_cast<int16_t>(stack[depth - 1]) : -1;
+    if (depth > 0 && !inObject) {
+      tokens_[stack[depth - 1]].size++;
+    }
+
+    if (c == '{' || c == '[') {
+      if (depth >= kMaxDepth) {
+        return fail("too deep");
+      }
+      const int16_t container = addToken((c == '{') ? JsonType::Object : JsonType::Array, static_cast<uint16_t>(pos),
+                                         parent);
+      if (container < 0) {
+        return false;
+      }
+      stack[depth++] = static_cast<uint16_t>(container);
+      pos++;
+      expect = (c == '{') ? Expect::KeyOrClose : Expect::ValueOrClose;
+      continue;
+    }
+
+    JsonType valueType = JsonType::String;
+    uint16_t start = 0;
+    uint16_t length = 0;
+    if (c == '"') {
+      if (!parseString(pos, start, length)) {
+        return false;
+      }
+    } else if (!parsePrimitive(pos, valueType, start, length)) {
+      return false;
+    }
+
+    const int16_t value = addToken(valueType, start, parent);
+    if (value < 0) {
+      return false;
+    }
+    tokens_[value].length = length;
+    expect = (depth == 0) ? Expect::End : Expect::CommaOrClose;
+  }
+
+  if (depth != 0 || expect != Expect::End) {
+    return fail("truncated");
+  }
+  return true;
+}
+
+const char* JsonPull::error() const {
+  return (error_ == nullptr) ? "" : error_;
+}
+
+int16_t JsonPull::root() const {
+  return (count_ > 0 && error_ == nullptr) ? 0 : -1;
+}
+
+JsonType JsonPull::type(int16_t value) const {
+  return (value < 0 || value >= count_) ? JsonType::Invalid : tokens_[value].type;
+}
+
+uint16_t JsonPull::size(int16_t value) const {
+  return (value < 0 || value >= count_) ? 0 : tokens_[value].size;
+}
+
+int16_t JsonPull::member(int16_t object, const char* key) const {
+  if (type(object) != JsonType::Object || key == nullptr) {
+    return -1;
+  }
+
+  int16_t k = static_cast<int16_t>(object + 1);
+  while (k < tokens_[object].next) {
+    const int16_t value = static_cast<int16_t>(k + 1);
+    if (strcmp(text_ + tokens_[k].start, key) == 0) {
+      return value;
+    }
+    k = static_cast<int16_t>(tokens_[value].next);
+  }
+  return -1;
+}
+
+int16_t JsonPull::element(int16_t array, uint16_t index) const {
+  int16_t child = firstChild(array);
+  while (child >= 0 && index > 0) {
+    child = nextSibling(child);
+    index--;
+  }
+  return child;
+}
+
+int16_t JsonPull::firstChild(int16_t container) const {
+  if (type(container) != JsonType::Array || tokens_[container].size == 0) {
+    return -1;
+  }
+  return static_cast<int16_t>(container + 1);
+}
+
+int16_t JsonPull::nextSibling(int16_t value) const {
+  if (type(value) == JsonType::Invalid || tokens_[value].parent < 0) {
+    return -1;
+  }
+  const uint16_t next = tokens_[value].next;
+  return (next < tokens_[tokens_[value].parent].next) ? static_cast<int16_t>(next) : -1;
+}
+
+bool JsonPull::isNull(int16_t value) const {
+  const JsonType t = type(value);
+  return t == JsonType::Null || t == JsonType::Invalid;
+}
+
+const char* JsonPull::string(int16_t value, const char* fallback) const {
+  return (type(value) == JsonType::String) ? text_ + tokens_[value].start : fallback;
+}
+
+bool JsonPull::toUint32(int16_t value, uint32_t& out) const {
+  double number = 0.0;
+  if (!toDouble(value, number) || number < 0.0 || number > 4294967295.0 || floor(number) != number) {
+    return false;
+  }
+  out = static_cast<uint32_t>(number);
+  return true;
+}
+
+bool JsonPull::toDouble(int16_t value, double& out) const {
+  if (type(value) != JsonType::Number) {
+    return false;
+  }
+  // Numbers are not terminated in the buffer, and one that ends the text may
+  // run right up to `len`, so strtod gets a bounded copy.
+  const Token& token = tokens_[value];
+  char digits[32];
+  if (token.length >= sizeof(digits)) {
+    return false;
+  }
+  memcpy(digits, text_ + token.start, token.length);
+  digits[token.length] = '\0';
+  out = strtod(digits, nullptr);
+  return true;
+}
+
+bool JsonPull::toBool(int16_t value, bool& out) const {
+  if (type(value) != JsonType::Bool) {
+    return false;
+  }
+  out = text_[tokens_[value].start] == 't';
+  return true;
+}
+
+int16_t JsonPull::addToken(JsonType type, uint16_t start, int16_t parent) {
+  if (count_ >= kMaxTokens) {
+    fail("too many tokens");
+    return -1;
+  }
+  Token& token = tokens_[count_];
+  token.type = type;
+  token.start = start;
+  token.length = 0;
+  token.size = 0;
+  token.next = static_cast<uint16_t>(count_ + 1);
+  token.parent = parent;
+  return static_cast<int16_t>(count_++);
+}
+
+bool JsonPull::parseString(size_t& pos, uint16_t& start, uint16_t& length) {
+  size_t read = pos + 1;
+  size_t write = read;
+  start = static_cast<uint16_t>(read);
+
+  while (read < len_) {
+    const char c = text_[read];
+    if (c == '"') {
+      text_[write] = '\0';
+      length = static_cast<uint16_t>(write - start);
+      pos = read + 1;
+      return true;
+    }
+    if (static_cast<uint8_t>(c) < 0x20) {
+      return fail("control character in string");
+    }
+    if (c != '\\') {
+      text_[write++] = c;
+      read++;
+      continue;
+    }
+
+    if (read + 1 >= len_) {
+      break;
+    }
+    const char escape = text_[read + 1];
+    read += 2;
+    switch (escape) {
+      case '"':
+      case '\\':
+      case '/':
+        text_[write++] = escape;
+        break;
+      case 'b':
+        text_[write++] = '\b';
+        break;
+      case 'f':
+        text_[write++] = '\f';
+        break;
+      case 'n':
+        text_[write++] = '\n';
+        break;
+      case 'r':
+        text_[write++] = '\r';
+        break;
+      case 't':
+        text_[write++] = '\t';
+        break;
+      case 'u': {
+        uint32_t code = 0;
+        if (read + 4 > len_ || !readHex4(text_ + read, code)) {
+          return fail("bad \\u escape");
+        }
+        read += 4;
+        if (code >= 0xD800 && code <= 0xDBFF) {
+          uint32_t low = 0;
+          if (read + 6 > len_ || text_[read] != '\\' || text_[read + 1] != 'u' ||
+              !readHex4(text_ + read + 2, low) || low < 0xDC00 || low > 0xDFFF) {
+            return fail("bad surrogate pair");
+          }
+          read += 6;
+          code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+        } else if (code >= 0xDC00 && code <= 0xDFFF) {
+          return fail("bad surrogate pair");
+        }
+        write += writeUtf8(text_ + write, code);
+        break;
+      }
+      default:
+        return fail("bad escape");
+    }
+  }
+
+  return fail("unterminated string");
+}
+
+bool JsonPull::parsePrimitive(size_t& pos, JsonType& type, uint16_t& start, uint16_t& length) {
+  start = static_cast<uint16_t>(pos);
+  while (pos < len_ && !isDelimiter(text_[pos])) {
+    pos++;
+  }
+  length = static_cast<uint16_t>(pos - start);
+  const char* p = text_ + start;
+
+  if (length == 4 && memcmp(p, "true", 4) == 0) {
+    type = JsonType::Bool;
+    return true;
+  }
+  if (length == 5 && memcmp(p, "false", 5) == 0) {
+    type = JsonType::Bool;
+    return true;
+  }
+  if (length == 4 && memcmp(p, "null", 4) == 0) {
+    type = JsonType::Null;
+    return true;
+  }
+
+  // JSON numbers: -?digits(.digits)?([eE][+-]?digits)?
+  size_t i = 0;
+  if (i < length && p[i] == '-') {
+    i++;
+  }
+  const size_t intStart = i;
+  while (i < length && p[i] >= '0' && p[i] <= '9') {
+    i++;
+  }
+  if (i == intStart || (p[intStart] == '0' && i - intStart > 1)) {
+    return fail("bad value");
+  }
+  if (i < length && p[i] == '.') {
+    const size_t fracStart = ++i;
+    while (i < length && p[i] >= '0' && p[i] <= '9') {
+      i++;
+    }
+    if (i == fracStart) {
+      return fail("bad number");
+    }
+  }
+  if (i < length && (p[i] == 'e' || p[i] == 'E')) {
+    i++;
+    if (i < length && (p[i] == '+' || p[i] == '-')) {
+      i++;
+    }
+    const size_t expStart = i;
+    while (i < length && p[i] >= '0' && p[i] <= '9') {
+      i++;
+    }
+    if (i == expStart) {
+      return fail("bad number");
+    }
+  }
+  if (i != length) {
+    return fail("bad number");
+  }
+
+  type = JsonType::Number;
+  return true;
+}
+
+bool JsonPull::fail(const char* message) {
+  if (error_ == nullptr) {
+    error_ = message;
+  }
+  return false;
+}
+
+}  // namespace idk
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace idk {
+
+enum class JsonType : uint8_t {
+  Invalid = 0,
+  Object = 1,
+  Array = 2,
+  String = 3,
+  Number = 4,
+  Bool = 5,
+  Null = 6,
+};
+
+// Tokenizes one JSON text of `len` bytes in place into a fixed token table;
+// nothing is allocated and nothing past `len` is read. Strings are unescaped
+// and NUL-terminated inside the caller's buffer, so the buffer must stay
+// alive (and unmodified) while values are read. Values are addressed by
+// token index; -1 means "absent" and every accessor accepts it.
+class JsonPull {
+ public:
+  static constexpr uint16_t kMaxTokens = 128;
+  static constexpr uint8_t kMaxDepth = 8;
+
+  bool parse(char* text, size_t len);
+  const char* error() const;
+
+  int16_t root() const;
+  JsonType type(int16_t value) const;
+  uint16_t size(int16_t value) const;
+
+  // Object member by key, array element by position.
+  int16_t member(int16_t object, const char* key) const;
+  int16_t element(int16_t array, uint16_t index) const;
+  // Iteration over an array: first element, then the following ones.
+  int16_t firstChild(int16_t container) const;
+  int16_t nextSibling(int16_t value) const;
+
+  bool isNull(int16_t value) const;
+  const char* string(int16_t value, const char* fallback = nullptr) const;
+  // Numbers spelled with more than 31 characters are rejected.
+  bool toUint32(int16_t value, uint32_t& out) const;
+  bool toDouble(int16_t value, double& out) const;
+  bool toBool(int16_t value, bool& out) const;
+
+ private:
+  struct Token {
+    JsonType type;
+    uint16_t start;
+    uint16_t length;
+    uint16_t size;
+    // Index just past this token's subtree, i.e. its next sibling.
+    uint16_t next;
+    int16_t parent;
+  };
+
+  int16_t addToken(JsonType type, uint16_t start, int16_t parent);
+  bool parseString(size_t& pos, uint16_t& start, uint16_t& length);
+  bool parsePrimitive(size_t& pos, JsonType& type, uint16_t& start, uint16_t& length);
+  bool fail(const char* message);
+
+  char* text_ = nullptr;
+  size_t len_ = 0;
+  Token tokens_[kMaxTokens];
+  uint16_t count_ = 0;
+  const char* error_ = "empty";
+};
+
+}  // namespace idk
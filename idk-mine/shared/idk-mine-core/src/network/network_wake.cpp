@@ -0,0 +1,94 @@
+#include "network_wake.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <sys/select.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#if IDK_NATIVE
+#include <sys/eventfd.h>
+#else
+#include <esp_vfs_eventfd.h>
+#endif
+
+namespace idk {
+namespace {
+
+// select() failing outright (a socket closed under it) must not turn the
+// network loop into a spin.
+constexpr uint32_t kSelectErrorBackoffMs = 10;
+
+}  // namespace
+
+bool NetworkWake::begin() {
+  if (eventFd_ >= 0) {
+    return true;
+  }
+
+#if !IDK_NATIVE
+  esp_vfs_eventfd_config_t config{};
+  config.max_fds = 1;
+  const esp_err_t err = esp_vfs_eventfd_register(&config);
+  // Already registered elsewhere is fine.
+  if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+    return false;
+  }
+#endif
+
+  eventFd_ = eventfd(0, 0);
+  return eventFd_ >= 0;
+}
+
+void NetworkWake::signal() {
+  if (eventFd_ < 0 || pending_.exchange(true)) {
+    return;
+  }
+  const uint64_t one = 1;
+  write(eventFd_, &one, sizeof(one));
+}
+
+void NetworkWake::signalFrom(void* ctx) {
+  static_cast<NetworkWake*>(ctx)->signal();
+}
+
+bool NetworkWake::wait(int socketFd, uint32_t timeoutMs) {
+  fd_set readSet;
+  FD_ZERO(&readSet);
+  int maxFd = -1;
+  if (socketFd >= 0) {
+    FD_SET(socketFd, &readSet);
+    maxFd = socketFd;
+  }
+  if (eventFd_ >= 0) {
+    FD_SET(eventFd_, &readSet);
+    maxFd = (eventFd_ > maxFd) ? eventFd_ : maxFd;
+  }
+  if (maxFd < 0) {
+    vTaskDelay(pdMS_TO_TICKS(timeoutMs));
+    return false;
+  }
+
+  timeval timeout{};
+  timeout.tv_sec = timeoutMs / 1000;
+  timeout.tv_usec = (timeoutMs % 1000) * 1000;
+  const int ready = select(maxFd + 1, &readSet, nullptr, nullptr, &timeout);
+  if (ready < 0) {
+    vTaskDelay(pdMS_TO_TICKS(kSelectErrorBackoffMs));
+    return false;
+  }
+  if (ready == 0) {
+    return false;
+  }
+
+  if (eventFd_ >= 0 && FD_ISSET(eventFd_, &readSet)) {
+    // Drain first, then re-arm: a signal landing in between skips its write
+    // but the task is awake and about to handle it anyway.
+    uint64_t count = 0;
+    read(eventFd_, &count, sizeof(count));
+    pending_.store(false);
+  }
+  return true;
+}
+
+}  // namespace idk
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include <atomic>
+
+namespace idk {
+
+// Parks the network task until the pool socket has data, another task calls
+// signal() (a worker found a share), or a timeout passes. The signal is an
+// eventfd selected together with the socket, so either one wakes the task
+// immediately instead of at the next poll.
+class NetworkWake {
+ public:
+  // Without an eventfd, signal() does nothing and only the socket and the
+  // timeout wake the task.
+  bool begin();
+
+  // Any task. Signals before the next wait coalesce into one wakeup.
+  void signal();
+  static void signalFrom(void* ctx);
+
+  // True when woken by the socket or a signal rather than the timeout.
+  bool wait(int socketFd, uint32_t timeoutMs);
+
+ private:
+  int eventFd_ = -1;
+  std::atomic<bool> pending_{false};
+};
+
+}  // namespace idk
@@ -0,0 +1,141 @@
+#include "pool_selector.h"
+
+namespace idk {
+namespace {
+
+constexpr uint32_t kProbeTimeoutMs = 2000;
+// Ranks endpoints that have never been measured behind every measured one.
+constexpr uint32_t kUnmeasuredLatencyMs = 0xFFFFFFFFu;
+// Backoff doubles per consecutive failure up to retryMs << kMaxBackoffShift.
+constexpr uint8_t kMaxBackoffShift = 4;
+
+}  // namespace
+
+void PoolSelector::begin(StratumTransport* transport, uint32_t retryMs, uint32_t probeIntervalMs) {
+  transport_ = transport;
+  retryMs_ = (retryMs == 0) ? 1 : retryMs;
+  probeIntervalMs_ = probeIntervalMs;
+  if (mutex_ == nullptr) {
+    mutex_ = xSemaphoreCreateMutex();
+  }
+  if (probeTask_ == nullptr && probeIntervalMs_ > 0 && transport_ != nullptr) {
+    xTaskCreatePinnedToCore(probeTaskEntry, "idk-probe", 4096, this, 1, &probeTask_, 0);
+  }
+}
+
+void PoolSelector::setPools(const PoolListConfig* pools) {
+  xSemaphoreTake(mutex_, portMAX_DELAY);
+  pools_ = pools;
+  memset(health_, 0, sizeof(health_));
+  xSemaphoreGive(mutex_);
+}
+
+uint8_t PoolSelector::select(uint32_t nowMs) {
+  xSemaphoreTake(mutex_, portMAX_DELAY);
+  const uint8_t n = (pools_ == nullptr) ? 0 : pools_->count;
+
+  int best = -1;
+  uint32_t bestLatency = 0;
+  int soonest = 0;
+  for (uint8_t i = 0; i < n; ++i) {
+    const EndpointHealth& h = health_[i];
+    if (h.failures > 0 && static_cast<int32_t>(nowMs - h.retryAtMs) < 0) {
+      if (static_cast<int32_t>(h.retryAtMs - health_[soonest].retryAtMs) < 0) {
+        soonest = i;
+      }
+      continue;
+    }
+
+    const uint32_t latency = (h.latencyMs == 0) ? kUnmeasuredLatencyMs : h.latencyMs;
+    if (best < 0 || latency < bestLatency) {
+      best = i;
+      bestLatency = latency;
+    }
+  }
+  xSemaphoreGive(mutex_);
+
+  return static_cast<uint8_t>((best >= 0) ? best : soonest);
+}
+
+void PoolSelector::reportConnect(uint8_t index, bool ok, uint32_t connectMs, uint32_t nowMs) {
+  xSemaphoreTake(mutex_, portMAX_DELAY);
+  recordLocked(index, ok, connectMs, nowMs);
+  xSemaphoreGive(mutex_);
+}
+
+void PoolSelector::reportFailure(uint8_t index, uint32_t nowMs) {
+  xSemaphoreTake(mutex_, portMAX_DELAY);
+  recordLocked(index, false, 0, nowMs);
+  xSemaphoreGive(mutex_);
+}
+
+uint8_t PoolSelector::count() const {
+  return (pools_ == nullptr) ? 0 : pools_->count;
+}
+
+uint32_t PoolSelector::latencyMs(uint8_t index) const {
+  return (index < kMaxPoolEndpoints) ? health_[index].latencyMs : 0;
+}
+
+bool PoolSelector::healthy(uint8_t index) const {
+  return index < count() && health_[index].failures == 0;
+}
+
+void PoolSelector::probeTaskEntry(void* ctx) {
+  static_cast<PoolSelector*>(ctx)->probeLoop();
+}
+
+void PoolSelector::probeLoop() {
+  while (true) {
+    vTaskDelay(pdMS_TO_TICKS(probeIntervalMs_));
+    if (!transport_->linkUp()) {
+      continue;
+    }
+
+    for (uint8_t i = 0; i < kMaxPoolEndpoints; ++i) {
+      // Copy the endpoint so the connect runs without holding the lock.
+      xSemaphoreTake(mutex_, portMAX_DELAY);
+      const PoolListConfig* pools = pools_;
+      const bool present = pools != nullptr && i < pools->count;
+      PoolEndpointConfig endpoint{};
+      if (present) {
+        endpoint = pools->endpoints[i];
+      }
+      xSemaphoreGive(mutex_);
+      if (!present) {
+        break;
+      }
+
+      uint32_t connectMs = 0;
+      const bool ok = transport_->probe(endpoint, kProbeTimeoutMs, connectMs);
+
+      xSemaphoreTake(mutex_, portMAX_DELAY);
+      if (pools_ == pools) {
+        recordLocked(i, ok, connectMs, millis());
+      }
+      xSemaphoreGive(mutex_);
+    }
+  }
+}
+
+void PoolSelector::recordLocked(uint8_t index, bool ok, uint32_t connectMs, uint32_t nowMs) {
+  if (index >= kMaxPoolEndpoints) {
+    return;
+  }
+
+  EndpointHealth& h = health_[index];
+  if (!ok) {
+    const uint8_t shift = (h.failures < kMaxBackoffShift) ? h.failures : kMaxBackoffShift;
+    if (h.failures < 0xFF) {
+      h.failures++;
+    }
+    h.retryAtMs = nowMs + (retryMs_ << shift);
+    return;
+  }
+
+  h.failures = 0;
+  const uint32_t sample = (connectMs == 0) ? 1 : connectMs;
+  h.latencyMs = (h.latencyMs == 0) ? sample : (h.latencyMs * 3 + sample) / 4;
+}
+
+}  // namespace idk
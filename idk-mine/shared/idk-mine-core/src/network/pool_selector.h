@@ -0,0 +1,56 @@
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include "config/runtime_config.h"
+#include "network/stratum_transport.h"
+
+namespace idk {
+
+// Ranks the configured pools of one coin by measured latency and health.
+// A background task times a TCP connect (StratumTransport::probe) to every
+// endpoint each probe interval (one handshake round trip, so it doubles as
+// the ping); real connects feed the same estimate. Failed endpoints back
+// off exponentially from the retry interval.
+class PoolSelector {
+ public:
+  void begin(StratumTransport* transport, uint32_t retryMs, uint32_t probeIntervalMs);
+  void setPools(const PoolListConfig* pools);
+
+  // Endpoint to connect to next: the lowest-latency healthy one, in list
+  // order among those not yet measured. When every endpoint is backing off,
+  // the one whose backoff ends first.
+  uint8_t select(uint32_t nowMs);
+  void reportConnect(uint8_t index, bool ok, uint32_t connectMs, uint32_t nowMs);
+  // The established connection died (closed or unanswered requests).
+  void reportFailure(uint8_t index, uint32_t nowMs);
+
+  uint8_t count() const;
+  // 0 until the endpoint has been measured once.
+  uint32_t latencyMs(uint8_t index) const;
+  bool healthy(uint8_t index) const;
+
+ private:
+  struct EndpointHealth {
+    uint32_t latencyMs;
+    uint8_t failures;
+    uint32_t retryAtMs;
+  };
+
+  static void probeTaskEntry(void* ctx);
+  void probeLoop();
+  void recordLocked(uint8_t index, bool ok, uint32_t connectMs, uint32_t nowMs);
+
+  StratumTransport* transport_ = nullptr;
+  SemaphoreHandle_t mutex_ = nullptr;
+  TaskHandle_t probeTask_ = nullptr;
+  const PoolListConfig* pools_ = nullptr;
+  EndpointHealth health_[kMaxPoolEndpoints]{};
+  uint32_t retryMs_ = 4000;
+  uint32_t probeIntervalMs_ = 0;
+};
+
+}  // namespace idk
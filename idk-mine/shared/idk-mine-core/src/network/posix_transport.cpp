@@ -0,0 +1,188 @@
+#include "posix_transport.h"
+
+#if IDK_NATIVE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdio.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace idk {
+namespace {
+
+#ifdef MSG_NOSIGNAL
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;
+#endif
+
+constexpr int kWriteStallMs = 1000;
+
+uint32_t monotonicMs() {
+  timespec ts{};
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint32_t>(ts.tv_sec * 1000u + ts.tv_nsec / 1000000u);
+}
+
+bool wouldBlock() {
+  return errno == EAGAIN || errno == EWOULDBLOCK;
+}
+
+// Non-blocking socket connected within `timeoutMs`, or -1.
+int connectWithTimeout(const char* host, uint16_t port, uint32_t timeoutMs) {
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  char portText[8];
+  snprintf(portText, sizeof(portText), "%u", static_cast<unsigned>(port));
+
+  addrinfo* results = nullptr;
+  if (getaddrinfo(host, portText, &hints, &results) != 0) {
+    return -1;
+  }
+
+  int fd = -1;
+  for (addrinfo* ai = results; ai != nullptr && fd < 0; ai = ai->ai_next) {
+    fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+    if (fd < 0) {
+      continue;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+
+    int rc = ::connect(fd, ai->ai_addr, ai->ai_addrlen);
+    if (rc != 0 && errno == EINPROGRESS) {
+      pollfd pfd{fd, POLLOUT, 0};
+      int err = 0;
+      socklen_t errLen = sizeof(err);
+      rc = (poll(&pfd, 1, static_cast<int>(timeoutMs)) == 1 &&
+            getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &errLen) == 0 && err == 0)
+               ? 0
+               : -1;
+    }
+    if (rc != 0) {
+      ::close(fd);
+      fd = -1;
+    }
+  }
+  freeaddrinfo(results);
+
+  if (fd >= 0) {
+    const int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  }
+  return fd;
+}
+
+}  // namespace
+
+PosixStratumTransport::~PosixStratumTransport() {
+  close();
+}
+
+bool PosixStratumTransport::connect(const PoolEndpointConfig& endpoint, uint32_t timeoutMs) {
+  close();
+  if (endpoint.tls) {
+    return false;
+  }
+  fd_ = connectWithTimeout(endpoint.host, endpoint.port, timeoutMs);
+  return fd_ >= 0;
+}
+
+void PosixStratumTransport::close() {
+  if (fd_ >= 0) {
+    ::close(fd_);
+  }
+  fd_ = -1;
+}
+
+bool PosixStratumTransport::connected() {
+  return fd_ >= 0;
+}
+
+int PosixStratumTransport::available() {
+  if (fd_ < 0) {
+    return 0;
+  }
+
+  int pending = 0;
+  if (ioctl(fd_, FIONREAD, &pending) != 0) {
+    close();
+    return 0;
+  }
+  if (pending > 0) {
+    return pending;
+  }
+
+  // Readable with nothing queued means the peer closed (or reset).
+  pollfd pfd{fd_, POLLIN, 0};
+  if (poll(&pfd, 1, 0) == 1) {
+    char probe = 0;
+    const ssize_t got = recv(fd_, &probe, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (got == 0 || (got < 0 && !wouldBlock())) {
+      close();
+    }
+  }
+  return 0;
+}
+
+int PosixStratumTransport::read(uint8_t* buf, size_t len) {
+  if (fd_ < 0) {
+    return -1;
+  }
+
+  const ssize_t got = recv(fd_, buf, len, MSG_DONTWAIT);
+  if (got > 0) {
+    return static_cast<int>(got);
+  }
+  if (got == 0 || !wouldBlock()) {
+    close();
+  }
+  return -1;
+}
+
+size_t PosixStratumTransport::write(const uint8_t* buf, size_t len) {
+  size_t sent = 0;
+  while (fd_ >= 0 && sent < len) {
+    const ssize_t n = send(fd_, buf + sent, len - sent, kSendFlags);
+    if (n > 0) {
+      sent += static_cast<size_t>(n);
+      continue;
+    }
+    pollfd pfd{fd_, POLLOUT, 0};
+    if (n < 0 && wouldBlock() && poll(&pfd, 1, kWriteStallMs) == 1) {
+      continue;
+    }
+    close();
+  }
+  return sent;
+}
+
+bool PosixStratumTransport::linkUp() {
+  return true;
+}
+
+bool PosixStratumTransport::probe(const PoolEndpointConfig& endpoint, uint32_t timeoutMs, uint32_t& connectMs) {
+  const uint32_t startMs = monotonicMs();
+  const int fd = connectWithTimeout(endpoint.host, endpoint.port, timeoutMs);
+  connectMs = monotonicMs() - startMs;
+  if (fd < 0) {
+    return false;
+  }
+  ::close(fd);
+  return true;
+}
+
+int PosixStratumTransport::socketFd() const {
+  return fd_;
+}
+
+}  // namespace idk
+
+#endif  // IDK_NATIVE
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "network/stratum_transport.h"
+
+namespace idk {
+
+// Host transport over POSIX sockets, for native builds (IDK_NATIVE) that
+// run the stratum client against a local mock pool. Plain TCP only: TLS
+// endpoints fail to connect, so point host configs at "tls": false.
+class PosixStratumTransport : public StratumTransport {
+ public:
+  ~PosixStratumTransport() override;
+
+  bool connect(const PoolEndpointConfig& endpoint, uint32_t timeoutMs) override;
+  void close() override;
+  bool connected() override;
+  int available() override;
+  int read(uint8_t* buf, size_t len) override;
+  size_t write(const uint8_t* buf, size_t len) override;
+  bool linkUp() override;
+  bool probe(const PoolEndpointConfig& endpoint, uint32_t timeoutMs, uint32_t& connectMs) override;
+  int socketFd() const override;
+
+ private:
+  int fd_ = -1;
+};
+
+}  // namespace idk
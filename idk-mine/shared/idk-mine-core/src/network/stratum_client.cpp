@@ -1,16 +1,12 @@
 #include "stratum_client.h"
 
-#include <ArduinoJson.h>
-#include <WiFi.h>
-#include <WiFiClientSecure.h>
+#include <algorithm>
+#include <math.h>
+#include <stdlib.h>
 
 namespace idk {
 namespace {
 
-WiFiClient gTcpClient;
-WiFiClientSecure gTlsClient;
-Client* gActiveClient = nullptr;
-
 void safeCopy(char* dst, size_t dstSize, const char* src) {
   if (dst == nullptr || dstSize == 0) {
     return;
@@ -22,18 +18,32 @@ void safeCopy(char* dst, size_t dstSize, const char* src) {
   strlcpy(dst, src, dstSize);
 }
 
+// Observed share rate is smoothed over ten minutes; shares are rare events,
+// so shorter windows mostly show noise.
+constexpr float kShareRateWindowSeconds = 600.0f;
+
+constexpr uint32_t kConnectTimeoutMs = 5000;
+
+// Bytes taken from the socket per loop() call, so a pool flooding notifies
+// cannot hold the network task.
+constexpr size_t kRxBytesPerLoop = 4096;
+
 const char* endpointTag(const PoolEndpointConfig& endpoint) {
   return endpoint.tls ? "stratum+tls" : "stratum+tcp";
 }
 
 }  // namespace
 
-void StratumClient::begin(const RuntimeConfig* config) {
+void StratumClient::begin(const RuntimeConfig* config, StratumTransport* transport) {
   config_ = config;
+  transport_ = transport;
+  selector_.begin(transport_, config_->poolRetryMs, config_->poolProbeMs);
+  selector_.setPools(&poolsForCoin(*config_, coin_));
   memset(&latestJob_, 0, sizeof(latestJob_));
   safeCopy(latestJob_.jobId, sizeof(latestJob_.jobId), "-");
   safeCopy(latestJob_.targetHex, sizeof(latestJob_.targetHex), "-");
   hasValidJob_ = false;
+  difficulty_ = 1.0;
   safeCopy(status_, sizeof(status_), "pool:idle");
 }
 
@@ -44,6 +54,9 @@ void StratumClient::setCoin(CoinType coin) {
 
   coin_ = coin;
   disconnect();
+  if (config_ != nullptr) {
+    selector_.setPools(&poolsForCoin(*config_, coin_));
+  }
 }
 
 void StratumClient::setIdentity(const char* wallet, const char* worker, const char* minerName,
@@ -55,7 +68,7 @@ void StratumClient::setIdentity(const char* wallet, const char* worker, const ch
 }
 
 void StratumClient::loop(uint32_t nowMs, bool wifiConnected) {
-  if (config_ == nullptr) {
+  if (config_ == nullptr || transport_ == nullptr) {
     safeCopy(status_, sizeof(status_), "pool:no-config");
     return;
   }
@@ -72,33 +85,51 @@ void StratumClient::loop(uint32_t nowMs, bool wifiConnected) {
   }
 
   if (!subscribed_) {
-    sendSubscribe();
+    sendSubscribe(nowMs);
     subscribed_ = true;
   }
 
   if (!authorized_) {
-    sendAuthorize();
+    sendAuthorize(nowMs);
   }
 
   processInput(nowMs);
+  if (expirePendingRequests(nowMs)) {
+    return;
+  }
 
-  // Keepalive RPC disabled: some pools reject custom methods and return
-  // repeated rpc-error responses.
+  // A pool can go quiet with the socket still open. After keepAliveMs
+  // without a byte from it, ask for something cheap; no answer within a
+  // retry interval drops it (see expirePendingRequests).
+  if (authorized_ && config_->keepAliveMs > 0 && !keepAlivePending_ && connected() &&
+      nowMs - lastRxMs_ >= config_->keepAliveMs) {
+    sendKeepAlive(nowMs);
+  }
 
-  if (!gActiveClient->connected()) {
+  if (!transport_->connected()) {
+    // The next connect goes to another endpoint if one is healthy.
+    selector_.reportFailure(endpointIndex_, nowMs);
     disconnect();
     safeCopy(status_, sizeof(status_), "pool:disconnected");
   }
 }
 
 bool StratumClient::connected() const {
-  return (gActiveClient != nullptr) && gActiveClient->connected();
+  return (transport_ != nullptr) && transport_->connected();
 }
 
 bool StratumClient::authorized() const {
   return connected() && authorized_;
 }
 
+int StratumClient::socketFd() const {
+  return connected() ? transport_->socketFd() : -1;
+}
+
+bool StratumClient::hasPendingInput() const {
+  return connected() && transport_->available() > 0;
+}
+
 bool StratumClient::hasActiveJob() const {
   return hasValidJob_;
 }
@@ -107,6 +138,42 @@ uint32_t StratumClient::reconnectCount() const {
   return reconnectCount_;
 }
 
+uint32_t StratumClient::failoverCount() const {
+  return failoverCount_;
+}
+
+uint8_t StratumClient::endpointIndex() const {
+  return endpointIndex_;
+}
+
+uint8_t StratumClient::endpointCount() const {
+  return selector_.count();
+}
+
+uint32_t StratumClient::endpointLatencyMs() const {
+  return selector_.latencyMs(endpointIndex_);
+}
+
+uint32_t StratumClient::tlsHandshakeMs() const {
+  return (transport_ != nullptr) ? transport_->stats().handshakeMs : 0;
+}
+
+uint32_t StratumClient::tlsFullHandshakes() const {
+  return (transport_ != nullptr) ? transport_->stats().fullHandshakes : 0;
+}
+
+uint32_t StratumClient::tlsResumedHandshakes() const {
+  return (transport_ != nullptr) ? transport_->stats().resumedHandshakes : 0;
+}
+
+uint32_t StratumClient::tlsPinFailures() const {
+  return (transport_ != nullptr) ? transport_->stats().pinFailures : 0;
+}
+
+uint32_t StratumClient::connectToJobMs() const {
+  return connectToJobMs_;
+}
+
 uint32_t StratumClient::acceptedShares() const {
   return acceptedShares_;
 }
@@ -129,41 +196,178 @@ bool StratumClient::takeLatestJob(StratumJob& out) {
   return true;
 }
 
-void StratumClient::submitPseudoShare(uint32_t nonce, uint32_t hash32) {
+bool StratumClient::rollJob() {
+  if (!hasValidJob_) {
+    return false;
+  }
+
+  // Every extranonce2 value of this job has been handed out; wait for the
+  // pool's next notify instead of reusing one.
+  const uint8_t bits = static_cast<uint8_t>(template_.extranonce2Size * 8);
+  if (bits < 64 && extranonce2_ + 1 >= (1ULL << bits)) {
+    return false;
+  }
+
+  extranonce2_++;
+  issueWork();
+  safeCopy(status_, sizeof(status_), "pool:job-rolled");
+  return true;
+}
+
+void StratumClient::submitShare(uint32_t workId, uint32_t nonce) {
   if (!connected() || !authorized_ || !hasValidJob_) {
     return;
   }
 
-  char user[140];
-  if (worker_[0] == '\0') {
-    snprintf(user, sizeof(user), "%s", wallet_);
-  } else {
-    snprintf(user, sizeof(user), "%s.%s", wallet_, worker_);
+  const WorkRecord* work = nullptr;
+  for (uint8_t i = 0; i < kRecentWork; ++i) {
+    if (workId != 0 && recentWork_[i].workId == workId) {
+      work = &recentWork_[i];
+      break;
+    }
   }
+  if (work == nullptr) {
+    staleShares_++;
+    return;
+  }
+
+  char user[140];
+  formatUser(user, sizeof(user));
+
+  char extranonce2[kStratumMaxExtranonceBytes * 2 + 1];
+  formatStratumExtranonce2(work->extranonce2, template_.extranonce2Size, extranonce2, sizeof(extranonce2));
 
-  const uint32_t requestId = nextRequestId_++;
+  // Replies are matched by id, so submits go out back to back without
+  // waiting for the previous one.
+  const uint32_t requestId = trackRequest(RpcKind::Submit, millis(), workId, nonce);
 
   char payload[320];
   snprintf(payload, sizeof(payload),
-           "{\"id\":%lu,\"method\":\"mining.submit\",\"params\":[\"%s\",\"%s\",\"%08lx\",\"%08lx\",\"%08lx\"]}",
-           static_cast<unsigned long>(requestId), user, latestJob_.jobId,
-           static_cast<unsigned long>(nonce ^ 0x5A5A5A5AUL), static_cast<unsigned long>(millis()),
-           static_cast<unsigned long>(hash32));
+           "{\"id\":%lu,\"method\":\"mining.submit\",\"params\":[\"%s\",\"%s\",\"%s\",\"%08lx\",\"%08lx\"]}",
+           static_cast<unsigned long>(requestId), user, work->jobId, extranonce2,
+           static_cast<unsigned long>(work->ntime), static_cast<unsigned long>(nonce));
 
   sendJsonLine(payload);
+  submittedShares_++;
+}
+
+uint32_t StratumClient::staleShares() const {
+  return staleShares_;
+}
+
+uint32_t StratumClient::submittedShares() const {
+  return submittedShares_;
+}
+
+uint32_t StratumClient::timedOutShares() const {
+  return timedOutShares_;
+}
+
+uint32_t StratumClient::unmatchedResponses() const {
+  return unmatchedResponses_;
+}
+
+uint8_t StratumClient::pendingRequests() const {
+  return pendingCount_;
+}
+
+uint32_t StratumClient::shareLatencyCount(uint8_t bucket) const {
+  return (bucket < kShareLatencyBuckets) ? shareLatencyHist_[bucket] : 0;
+}
+
+uint32_t StratumClient::averageShareLatencyMs() const {
+  uint32_t replies = 0;
+  for (uint8_t i = 0; i < kShareLatencyBuckets; ++i) {
+    replies += shareLatencyHist_[i];
+  }
+  return (replies == 0) ? 0 : shareLatencyTotalMs_ / replies;
+}
+
+uint32_t StratumClient::maxShareLatencyMs() const {
+  return shareLatencyMaxMs_;
+}
+
+void StratumClient::sampleShareRate(uint32_t nowMs, float hashrate) {
+  const uint32_t elapsed = nowMs - lastShareSampleMs_;
+  if (lastShareSampleMs_ == 0 || elapsed == 0) {
+    lastShareSampleMs_ = nowMs;
+    lastSubmittedSample_ = submittedShares_;
+    return;
+  }
+
+  const float dt = static_cast<float>(elapsed) / 1000.0f;
+  const float observed = static_cast<float>(submittedShares_ - lastSubmittedSample_) * 60.0f / dt;
+  const float alpha = 1.0f - expf(-dt / kShareRateWindowSeconds);
+  observedSharesPerMinute_ += alpha * (observed - observedSharesPerMinute_);
+
+  expectedSharesPerMinute_ =
+      hasValidJob_ ? static_cast<float>(hashrate * 60.0 * shareTargetProbability(jobTarget_)) : 0.0f;
+
+  lastShareSampleMs_ = nowMs;
+  lastSubmittedSample_ = submittedShares_;
+}
+
+double StratumClient::difficulty() const {
+  return jobDifficulty_;
+}
+
+float StratumClient::expectedSharesPerMinute() const {
+  return expectedSharesPerMinute_;
+}
+
+float StratumClient::observedSharesPerMinute() const {
+  return observedSharesPerMinute_;
+}
+
+void StratumClient::sampleRx(uint32_t nowMs) {
+  const uint32_t elapsed = nowMs - lastRxSampleMs_;
+  if (lastRxSampleMs_ != 0 && elapsed != 0) {
+    rxBytesPerSecond_ = static_cast<float>(rxBytes_ - lastRxSampleBytes_) * 1000.0f / static_cast<float>(elapsed);
+    const uint32_t lines = lineCount_ - lastRxSampleLines_;
+    lineParseUs_ = (lines == 0) ? 0 : (lineParseTotalUs_ - lastRxSampleParseUs_) / lines;
+  }
+
+  lastRxSampleMs_ = nowMs;
+  lastRxSampleBytes_ = rxBytes_;
+  lastRxSampleLines_ = lineCount_;
+  lastRxSampleParseUs_ = lineParseTotalUs_;
+}
+
+float StratumClient::rxBytesPerSecond() const {
+  return rxBytesPerSecond_;
+}
+
+uint32_t StratumClient::lineParseUs() const {
+  return lineParseUs_;
+}
+
+uint32_t StratumClient::maxLineParseUs() const {
+  return lineParseMaxUs_;
+}
+
+uint32_t StratumClient::rxOverflows() const {
+  return rxOverflows_;
 }
 
 void StratumClient::disconnect() {
-  if (gActiveClient != nullptr) {
-    gActiveClient->stop();
+  if (transport_ != nullptr) {
+    transport_->close();
   }
-  gActiveClient = nullptr;
-  usingTls_ = false;
   subscribed_ = false;
   authorized_ = false;
   hasValidJob_ = false;
+  hasSession_ = false;
+  difficulty_ = 1.0;
   waitingAuthorizeResult_ = false;
-  lineLen_ = 0;
+  resetRx();
+  memset(recentWork_, 0, sizeof(recentWork_));
+
+  // Replies to anything still in flight can no longer arrive.
+  for (uint8_t i = 0; i < kMaxPendingRequests; ++i) {
+    if (pending_[i].kind != RpcKind::None) {
+      dropPendingRequest(pending_[i]);
+    }
+  }
 }
 
 bool StratumClient::connectSocket(uint32_t nowMs) {
@@ -173,78 +377,112 @@ bool StratumClient::connectSocket(uint32_t nowMs) {
 
   lastConnectAttemptMs_ = nowMs;
 
-  const PoolEndpointConfig& endpoint = endpointForCoin(*config_, coin_);
-  if (endpoint.host[0] == '\0' || endpoint.port == 0) {
+  const PoolListConfig& pools = poolsForCoin(*config_, coin_);
+  const uint8_t index = selector_.select(nowMs);
+  if (index >= pools.count) {
     safeCopy(status_, sizeof(status_), "pool:bad-endpoint");
     return false;
   }
-
-  gActiveClient = endpoint.tls ? static_cast<Client*>(&gTlsClient) : static_cast<Client*>(&gTcpClient);
-  usingTls_ = endpoint.tls;
-
-  if (usingTls_) {
-    gTlsClient.setInsecure();
-    gTlsClient.setTimeout(2000);
-  } else {
-    gTcpClient.setTimeout(2000);
+  const PoolEndpointConfig& endpoint = pools.endpoints[index];
+  if (endpoint.host[0] == '\0' || endpoint.port == 0) {
+    selector_.reportConnect(index, false, 0, nowMs);
+    safeCopy(status_, sizeof(status_), "pool:bad-endpoint");
+    return false;
   }
 
-  const bool ok = gActiveClient->connect(endpoint.host, endpoint.port);
+  const bool ok = transport_->connect(endpoint, kConnectTimeoutMs);
+  const uint32_t connectMs = millis() - nowMs;
+  // Rank on the TCP part only, so TLS endpoints compare fairly with the
+  // plain-TCP probes.
+  const uint32_t handshakeMs = ok ? transport_->lastHandshakeMs() : 0;
   reconnectCount_++;
+  selector_.reportConnect(index, ok, connectMs - std::min(handshakeMs, connectMs), nowMs + connectMs);
   if (!ok) {
-    safeCopy(status_, sizeof(status_), "pool:connect-failed");
-    gActiveClient = nullptr;
+    snprintf(status_, sizeof(status_), "pool:connect-failed #%u", static_cast<unsigned>(index));
     return false;
   }
 
+  if (hasConnected_ && index != endpointIndex_) {
+    failoverCount_++;
+  }
+  endpointIndex_ = index;
+  hasConnected_ = true;
+
   subscribed_ = false;
   authorized_ = false;
   waitingAuthorizeResult_ = false;
-  lineLen_ = 0;
-  lastIoMs_ = nowMs;
-
-  snprintf(status_, sizeof(status_), "pool:connected %s:%u", endpointTag(endpoint), endpoint.port);
+  resetRx();
+  keepAlivePending_ = false;
+  lastRxMs_ = nowMs;
+  connectStartMs_ = nowMs;
+  awaitingFirstJob_ = true;
+
+  snprintf(status_, sizeof(status_), "pool:connected #%u %s:%u", static_cast<unsigned>(index),
+           endpointTag(endpoint), endpoint.port);
   return true;
 }
 
-void StratumClient::sendSubscribe() {
+void StratumClient::sendSubscribe(uint32_t nowMs) {
   if (!connected()) {
     return;
   }
 
   char payload[160];
   snprintf(payload, sizeof(payload),
-           "{\"id\":1,\"method\":\"mining.subscribe\",\"params\":[\"%s\"]}", minerName_);
+           "{\"id\":%lu,\"method\":\"mining.subscribe\",\"params\":[\"%s\"]}",
+           static_cast<unsigned long>(trackRequest(RpcKind::Subscribe, nowMs)), minerName_);
   sendJsonLine(payload);
 }
 
-void StratumClient::sendAuthorize() {
+void StratumClient::sendAuthorize(uint32_t nowMs) {
   if (!connected() || waitingAuthorizeResult_) {
     return;
   }
 
   char user[140];
-  if (worker_[0] == '\0') {
-    snprintf(user, sizeof(user), "%s", wallet_);
-  } else {
-    snprintf(user, sizeof(user), "%s.%s", wallet_, worker_);
-  }
+  formatUser(user, sizeof(user));
 
   char payload[240];
   snprintf(payload, sizeof(payload),
            "{\"id\":%lu,\"method\":\"mining.authorize\",\"params\":[\"%s\",\"%s\"]}",
-           static_cast<unsigned long>(authorizeRequestId_), user, password_);
+           static_cast<unsigned long>(trackRequest(RpcKind::Authorize, nowMs)), user, password_);
   sendJsonLine(payload);
   waitingAuthorizeResult_ = true;
 }
 
+// mining.extranonce.subscribe is cheap and widely known; pools that do not
+// support it still answer with an error, which is all the probe needs.
+void StratumClient::sendKeepAlive(uint32_t nowMs) {
+  char payload[96];
+  snprintf(payload, sizeof(payload), "{\"id\":%lu,\"method\":\"mining.extranonce.subscribe\",\"params\":[]}",
+           static_cast<unsigned long>(trackRequest(RpcKind::KeepAlive, nowMs)));
+  sendJsonLine(payload);
+  keepAlivePending_ = true;
+}
+
 void StratumClient::sendJsonLine(const char* line) {
   if (!connected() || line == nullptr) {
     return;
   }
 
-  gActiveClient->print(line);
-  gActiveClient->print("\n");
+  // One write per line so TLS sends a single record.
+  const size_t len = strlen(line);
+  if (len + 1 <= sizeof(txBuf_)) {
+    memcpy(txBuf_, line, len);
+    txBuf_[len] = '\n';
+    transport_->write(reinterpret_cast<const uint8_t*>(txBuf_), len + 1);
+  } else {
+    transport_->write(reinterpret_cast<const uint8_t*>(line), len);
+    transport_->write(reinterpret_cast<const uint8_t*>("\n"), 1);
+  }
+}
+
+void StratumClient::formatUser(char* out, size_t outSize) const {
+  if (worker_[0] == '\0') {
+    snprintf(out, outSize, "%s", wallet_);
+  } else {
+    snprintf(out, outSize, "%s.%s", wallet_, worker_);
+  }
 }
 
 void StratumClient::processInput(uint32_t nowMs) {
@@ -252,175 +490,424 @@ void StratumClient::processInput(uint32_t nowMs) {
     return;
   }
 
-  while (gActiveClient->available()) {
-    const int raw = gActiveClient->read();
-    if (raw < 0) {
+  size_t budget = kRxBytesPerLoop;
+  while (budget > 0) {
+    const int available = transport_->available();
+    if (available <= 0) {
       break;
     }
 
-    const char ch = static_cast<char>(raw);
-    if (ch == '\r') {
-      continue;
+    // Read straight into the free span up to the ring's wrap point.
+    const size_t offset = rxTail_ % kRxRingBytes;
+    size_t want = kRxRingBytes - (rxTail_ - rxHead_);
+    want = std::min(want, kRxRingBytes - offset);
+    want = std::min(want, static_cast<size_t>(available));
+    want = std::min(want, budget);
+
+    const int got = transport_->read(rxRing_ + offset, want);
+    if (got <= 0) {
+      break;
     }
-    if (ch == '\n') {
-      lineBuf_[lineLen_] = '\0';
-      if (lineLen_ > 0) {
-        processLine(lineBuf_);
-      }
-      lineLen_ = 0;
-      lastIoMs_ = nowMs;
-      continue;
+    rxTail_ += static_cast<size_t>(got);
+    rxBytes_ += static_cast<uint32_t>(got);
+    lastRxMs_ = nowMs;
+    budget -= static_cast<size_t>(got);
+
+    if (rxTail_ - rxHead_ == kRxRingBytes) {
+      drainRx();
     }
+  }
+
+  drainRx();
+}
 
-    if (lineLen_ + 1 < sizeof(lineBuf_)) {
-      lineBuf_[lineLen_++] = ch;
-    } else {
+void StratumClient::drainRx() {
+  while (rxHead_ != rxTail_) {
+    const size_t offset = rxHead_ % kRxRingBytes;
+    const size_t span = std::min(rxTail_ - rxHead_, kRxRingBytes - offset);
+    const uint8_t* start = rxRing_ + offset;
+    const uint8_t* newline = static_cast<const uint8_t*>(memchr(start, '\n', span));
+
+    const size_t take = (newline != nullptr) ? static_cast<size_t>(newline - start) : span;
+    appendLine(start, take);
+    rxHead_ += take;
+
+    if (newline != nullptr) {
+      rxHead_++;
+      finishLine();
+    }
+  }
+}
+
+void StratumClient::appendLine(const uint8_t* data, size_t len) {
+  if (discardingLine_ || len == 0) {
+    return;
+  }
+
+  // Keep room for the terminating NUL the tokenizer expects.
+  const size_t needed = lineLen_ + len + 1;
+  if (needed > lineCap_) {
+    size_t cap = (lineCap_ == 0) ? kInitialLineBytes : lineCap_;
+    while (cap < needed) {
+      cap *= 2;
+    }
+    char* grown = (cap <= kMaxLineBytes) ? static_cast<char*>(realloc(lineBuf_, cap)) : nullptr;
+    if (grown == nullptr) {
       lineLen_ = 0;
+      discardingLine_ = true;
+      rxOverflows_++;
       safeCopy(status_, sizeof(status_), "pool:rx-overflow");
+      return;
     }
+    lineBuf_ = grown;
+    lineCap_ = cap;
   }
+
+  memcpy(lineBuf_ + lineLen_, data, len);
+  lineLen_ += len;
 }
 
-void StratumClient::processLine(const char* line) {
-  JsonDocument doc;
-  const DeserializationError err = deserializeJson(doc, line);
-  if (err) {
-    safeCopy(status_, sizeof(status_), "pool:json-parse-error");
+void StratumClient::finishLine() {
+  if (discardingLine_) {
+    discardingLine_ = false;
     return;
   }
 
-  const uint32_t id = doc["id"] | 0;
-
-  JsonVariantConst errorNode = doc["error"];
-  if (!errorNode.isNull()) {
-    if (id == authorizeRequestId_) {
-      authorized_ = false;
-      waitingAuthorizeResult_ = false;
+  if (lineLen_ > 0 && lineBuf_[lineLen_ - 1] == '\r') {
+    lineLen_--;
+  }
+  if (lineLen_ > 0) {
+    lineBuf_[lineLen_] = '\0';
+    const uint32_t startUs = micros();
+    processLine(lineBuf_, lineLen_);
+    const uint32_t costUs = micros() - startUs;
+    lineCount_++;
+    lineParseTotalUs_ += costUs;
+    if (costUs > lineParseMaxUs_) {
+      lineParseMaxUs_ = costUs;
     }
+  }
+  lineLen_ = 0;
+}
 
-    if (id >= 3) {
-      rejectedShares_++;
-    }
+void StratumClient::resetRx() {
+  rxHead_ = 0;
+  rxTail_ = 0;
+  lineLen_ = 0;
+  discardingLine_ = false;
+}
 
-    int errorCode = 0;
-    const char* errorText = "rpc-error";
-    if (errorNode.is<JsonArrayConst>()) {
-      JsonArrayConst arr = errorNode.as<JsonArrayConst>();
-      errorCode = arr[0] | 0;
-      errorText = arr[1] | errorText;
-    } else if (errorNode.is<JsonObjectConst>()) {
-      JsonObjectConst obj = errorNode.as<JsonObjectConst>();
-      errorCode = obj["code"] | 0;
-      errorText = obj["message"] | errorText;
-    } else if (errorNode.is<const char*>()) {
-      errorText = errorNode.as<const char*>();
-    }
+void StratumClient::processLine(char* line, size_t len) {
+  if (!json_.parse(line, len)) {
+    safeCopy(status_, sizeof(status_), "pool:json-parse-error");
+    return;
+  }
 
-    if (errorCode != 0) {
-      snprintf(status_, sizeof(status_), "pool:rpc %d", errorCode);
-    } else {
-      snprintf(status_, sizeof(status_), "pool:%s", errorText);
+  const int16_t root = json_.root();
+  const char* method = json_.string(json_.member(root, "method"));
+  if (method != nullptr) {
+    const int16_t params = json_.member(root, "params");
+    if (strcmp(method, "mining.notify") == 0) {
+      tryParseNotify(params);
+    } else if (strcmp(method, "mining.set_extranonce") == 0) {
+      parseSetExtranonce(params);
+    } else if (strcmp(method, "mining.set_difficulty") == 0) {
+      parseSetDifficulty(params);
     }
     return;
   }
 
-  if (id == authorizeRequestId_) {
-    waitingAuthorizeResult_ = false;
-    authorized_ = doc["result"].is<bool>() ? doc["result"].as<bool>() : false;
-    safeCopy(status_, sizeof(status_), authorized_ ? "pool:authorized" : "pool:authorize-failed");
+  uint32_t id = 0;
+  if (!json_.toUint32(json_.member(root, "id"), id)) {
+    return;
   }
 
-  const char* method = doc["method"] | nullptr;
-  if (method != nullptr) {
-    if (strcmp(method, "mining.notify") == 0) {
-      tryParseNotify(doc["params"]);
-      return;
+  PendingRequest request{};
+  if (!takePendingRequest(id, request)) {
+    unmatchedResponses_++;
+    return;
+  }
+
+  const int16_t result = json_.member(root, "result");
+  const int16_t error = json_.member(root, "error");
+  const bool failed = !json_.isNull(error);
+  if (failed && request.kind != RpcKind::KeepAlive) {
+    formatRpcError(error, status_, sizeof(status_));
+  }
+
+  switch (request.kind) {
+    case RpcKind::Subscribe:
+      if (!failed) {
+        parseSubscribeResult(result);
+      }
+      break;
+
+    case RpcKind::Authorize: {
+      bool ok = false;
+      waitingAuthorizeResult_ = false;
+      authorized_ = !failed && json_.toBool(result, ok) && ok;
+      if (!failed) {
+        safeCopy(status_, sizeof(status_), authorized_ ? "pool:authorized" : "pool:authorize-failed");
+      }
+      break;
     }
 
-    if (strcmp(method, "mining.set_difficulty") == 0) {
-      safeCopy(status_, sizeof(status_), "pool:set-difficulty");
-      return;
+    case RpcKind::Submit: {
+      bool accepted = false;
+      if (!failed && json_.toBool(result, accepted) && accepted) {
+        acceptedShares_++;
+      } else {
+        rejectedShares_++;
+      }
+      recordShareLatency(millis() - request.sentMs);
+      break;
     }
+
+    case RpcKind::KeepAlive:
+      // Any answer, an error included, shows the pool is still there.
+      keepAlivePending_ = false;
+      break;
+
+    case RpcKind::None:
+      break;
   }
+}
 
-  if (id >= 3 && doc["result"].is<bool>()) {
-    if (doc["result"].as<bool>()) {
-      acceptedShares_++;
-    } else {
-      rejectedShares_++;
-    }
+void StratumClient::formatRpcError(int16_t error, char* out, size_t outSize) const {
+  double errorCode = 0.0;
+  const char* errorText = "rpc-error";
+  if (json_.type(error) == JsonType::Array) {
+    json_.toDouble(json_.element(error, 0), errorCode);
+    errorText = json_.string(json_.element(error, 1), errorText);
+  } else if (json_.type(error) == JsonType::Object) {
+    json_.toDouble(json_.member(error, "code"), errorCode);
+    errorText = json_.string(json_.member(error, "message"), errorText);
+  } else {
+    errorText = json_.string(error, errorText);
+  }
+
+  if (static_cast<int>(errorCode) != 0) {
+    snprintf(out, outSize, "pool:rpc %d", static_cast<int>(errorCode));
+  } else {
+    snprintf(out, outSize, "pool:%s", errorText);
   }
 }
 
-void StratumClient::tryParseNotify(const JsonVariantConst& params) {
-  if (params.isNull() || !params.is<JsonArrayConst>()) {
-    safeCopy(status_, sizeof(status_), "pool:notify-invalid");
+void StratumClient::parseSubscribeResult(int16_t result) {
+  // [[subscriptions...], extranonce1, extranonce2_size]
+  uint32_t extranonce2Size = 0;
+  if (json_.type(result) != JsonType::Array || !json_.toUint32(json_.element(result, 2), extranonce2Size) ||
+      !parseStratumExtranonce1(json_.string(json_.element(result, 1)), session_) || extranonce2Size == 0 ||
+      extranonce2Size > kStratumMaxExtranonceBytes) {
+    safeCopy(status_, sizeof(status_), "pool:subscribe-invalid");
     return;
   }
 
-  JsonArrayConst arr = params.as<JsonArrayConst>();
+  session_.extranonce2Size = static_cast<uint8_t>(extranonce2Size);
+  hasSession_ = true;
+  safeCopy(status_, sizeof(status_), "pool:subscribed");
+}
+
+void StratumClient::parseSetExtranonce(int16_t params) {
+  if (json_.type(params) != JsonType::Array) {
+    return;
+  }
 
-  const char* jobId = arr[0] | "job";
-  safeCopy(latestJob_.jobId, sizeof(latestJob_.jobId), jobId);
+  StratumSession next = session_;
+  uint32_t extranonce2Size = 0;
+  if (!json_.toUint32(json_.element(params, 1), extranonce2Size) ||
+      !parseStratumExtranonce1(json_.string(json_.element(params, 0)), next) || extranonce2Size == 0 ||
+      extranonce2Size > kStratumMaxExtranonceBytes) {
+    return;
+  }
+
+  // Takes effect from the next notify, as the protocol specifies.
+  next.extranonce2Size = static_cast<uint8_t>(extranonce2Size);
+  session_ = next;
+  hasSession_ = true;
+}
+
+void StratumClient::parseSetDifficulty(int16_t params) {
+  double difficulty = 0.0;
+  if (!json_.toDouble(json_.element(params, 0), difficulty) || !(difficulty > 0.0)) {
+    safeCopy(status_, sizeof(status_), "pool:difficulty-invalid");
+    return;
+  }
+
+  difficulty_ = difficulty;
+  snprintf(status_, sizeof(status_), "pool:difficulty %.6g", difficulty_);
+}
+
+void StratumClient::tryParseNotify(int16_t params) {
+  if (json_.type(params) != JsonType::Array) {
+    safeCopy(status_, sizeof(status_), "pool:notify-invalid");
+    return;
+  }
+  if (!hasSession_) {
+    safeCopy(status_, sizeof(status_), "pool:no-extranonce");
+    return;
+  }
 
-  const char* targetA = arr[6] | nullptr;
-  const char* targetB = arr[2] | nullptr;
-  const char* selectedTarget = (targetA != nullptr) ? targetA : targetB;
-  if (selectedTarget == nullptr) {
-    selectedTarget = "0000ffff";
+  // [job_id, prevhash, coinb1, coinb2, [branches], version, nbits, ntime, clean]
+  StratumNotify notify{};
+  notify.jobId = json_.string(json_.element(params, 0), "job");
+  notify.prevHash = json_.string(json_.element(params, 1));
+  notify.coinb1 = json_.string(json_.element(params, 2));
+  notify.coinb2 = json_.string(json_.element(params, 3));
+  const int16_t branches = json_.element(params, 4);
+  for (int16_t branch = json_.firstChild(branches); branch >= 0; branch = json_.nextSibling(branch)) {
+    if (notify.merkleBranchCount >= kStratumMaxMerkleBranches) {
+      safeCopy(status_, sizeof(status_), "pool:notify-branches");
+      return;
+    }
+    notify.merkleBranches[notify.merkleBranchCount++] = json_.string(branch);
+  }
+  notify.version = json_.string(json_.element(params, 5));
+  notify.nbits = json_.string(json_.element(params, 6));
+  notify.ntime = json_.string(json_.element(params, 7));
+  json_.toBool(json_.element(params, 8), notify.cleanJobs);
+  char err[48];
+  if (!buildStratumJobTemplate(notify, session_, template_, err, sizeof(err))) {
+    snprintf(status_, sizeof(status_), "pool:notify %s", err);
+    return;
   }
 
-  safeCopy(latestJob_.targetHex, sizeof(latestJob_.targetHex), selectedTarget);
-  latestJob_.target32 = parseTarget32(latestJob_.targetHex);
-  latestJob_.seed = fastHash32(jobId) ^ fastHash32(latestJob_.targetHex) ^ millis();
+  safeCopy(latestJob_.jobId, sizeof(latestJob_.jobId), template_.jobId);
+
+  jobDifficulty_ = difficulty_;
+  shareTargetFromDifficulty(jobDifficulty_, (coin_ == CoinType::LTC) ? kDiff1ShiftScrypt : kDiff1ShiftSha256d,
+                            jobTarget_);
+  latestJob_.hasTarget = true;
+  latestJob_.difficulty = jobDifficulty_;
+  latestJob_.target = jobTarget_;
+  latestJob_.target32 = shareTargetTop32(jobTarget_);
+  formatShareTarget(jobTarget_, latestJob_.targetHex, sizeof(latestJob_.targetHex));
+
+  if (template_.cleanJobs) {
+    memset(recentWork_, 0, sizeof(recentWork_));
+  }
+  extranonce2_ = 0;
+  issueWork();
 
   hasValidJob_ = true;
-  hasPendingJob_ = true;
+  if (awaitingFirstJob_) {
+    connectToJobMs_ = millis() - connectStartMs_;
+    awaitingFirstJob_ = false;
+  }
   safeCopy(status_, sizeof(status_), "pool:new-job");
 }
 
-uint32_t StratumClient::fastHash32(const char* text) {
-  if (text == nullptr) {
-    return 0;
+void StratumClient::issueWork() {
+  buildStratumHeader(template_, extranonce2_, latestJob_.header);
+  latestJob_.workId = nextWorkId_++;
+  if (nextWorkId_ == 0) {
+    nextWorkId_ = 1;
   }
 
-  uint32_t hash = 2166136261u;
-  while (*text != '\0') {
-    hash ^= static_cast<uint8_t>(*text++);
-    hash *= 16777619u;
+  WorkRecord& record = recentWork_[recentWorkNext_];
+  recentWorkNext_ = static_cast<uint8_t>((recentWorkNext_ + 1) % kRecentWork);
+  record.workId = latestJob_.workId;
+  safeCopy(record.jobId, sizeof(record.jobId), template_.jobId);
+  record.extranonce2 = extranonce2_;
+  record.ntime = template_.ntime;
+
+  hasPendingJob_ = true;
+}
+
+void StratumClient::recordShareLatency(uint32_t latencyMs) {
+  uint8_t bucket = 0;
+  while (bucket < kShareLatencyBuckets - 1 && latencyMs >= kShareLatencyBucketMs[bucket]) {
+    bucket++;
+  }
+  shareLatencyHist_[bucket]++;
+  shareLatencyTotalMs_ += latencyMs;
+  if (latencyMs > shareLatencyMaxMs_) {
+    shareLatencyMaxMs_ = latencyMs;
   }
-  return hash;
 }
 
-uint32_t StratumClient::parseTarget32(const char* targetHex) {
-  if (targetHex == nullptr || targetHex[0] == '\0') {
-    return 0;
+uint32_t StratumClient::trackRequest(RpcKind kind, uint32_t nowMs, uint32_t workId, uint32_t nonce) {
+  const uint32_t id = nextRequestId_++;
+  if (nextRequestId_ == 0) {
+    nextRequestId_ = 1;
   }
 
-  const char* start = targetHex;
-  if (start[0] == '0' && (start[1] == 'x' || start[1] == 'X')) {
-    start += 2;
+  // Reuse a free slot, or give up on the oldest request if the pool has
+  // left kMaxPendingRequests unanswered.
+  PendingRequest* slot = nullptr;
+  for (uint8_t i = 0; i < kMaxPendingRequests; ++i) {
+    PendingRequest& candidate = pending_[i];
+    if (candidate.kind == RpcKind::None) {
+      slot = &candidate;
+      break;
+    }
+    if (slot == nullptr || nowMs - candidate.sentMs > nowMs - slot->sentMs) {
+      slot = &candidate;
+    }
+  }
+  if (slot->kind != RpcKind::None) {
+    dropPendingRequest(*slot);
   }
 
-  char compact[9];
-  memset(compact, 0, sizeof(compact));
+  slot->id = id;
+  slot->kind = kind;
+  slot->sentMs = nowMs;
+  slot->workId = workId;
+  slot->nonce = nonce;
+  pendingCount_++;
+  return id;
+}
 
-  size_t n = 0;
-  while (start[n] != '\0' && n < 8) {
-    const char c = start[n];
-    const bool isHex = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
-    if (!isHex) {
-      break;
+bool StratumClient::takePendingRequest(uint32_t id, PendingRequest& out) {
+  for (uint8_t i = 0; i < kMaxPendingRequests; ++i) {
+    if (pending_[i].kind != RpcKind::None && pending_[i].id == id) {
+      out = pending_[i];
+      pending_[i].kind = RpcKind::None;
+      pendingCount_--;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool StratumClient::expirePendingRequests(uint32_t nowMs) {
+  // The keepalive probe only asks whether the pool is there at all, so it
+  // gets a retry interval rather than the full request timeout.
+  const uint32_t keepAliveTimeoutMs = std::max<uint32_t>(config_->poolRetryMs, kMinKeepAliveTimeoutMs);
+  bool expired = false;
+  bool silent = false;
+  for (uint8_t i = 0; i < kMaxPendingRequests; ++i) {
+    const RpcKind kind = pending_[i].kind;
+    if (kind == RpcKind::None) {
+      continue;
+    }
+    const uint32_t timeoutMs = kind == RpcKind::KeepAlive ? keepAliveTimeoutMs : kRequestTimeoutMs;
+    if (nowMs - pending_[i].sentMs >= timeoutMs) {
+      dropPendingRequest(pending_[i]);
+      expired = true;
+      silent = silent || kind == RpcKind::KeepAlive;
     }
-    compact[n] = c;
-    n++;
   }
 
-  if (n == 0) {
-    return 0;
+  // A pool that stops answering while the socket stays open is as dead as
+  // a closed one; drop it rather than keep hashing its last job.
+  if (expired && connected()) {
+    selector_.reportFailure(endpointIndex_, nowMs);
+    disconnect();
+    safeCopy(status_, sizeof(status_), silent ? "pool:silent" : "pool:request-timeout");
+    return true;
   }
+  return false;
+}
 
-  return static_cast<uint32_t>(strtoul(compact, nullptr, 16));
+void StratumClient::dropPendingRequest(PendingRequest& request) {
+  if (request.kind == RpcKind::Submit) {
+    timedOutShares_++;
+  } else if (request.kind == RpcKind::KeepAlive) {
+    keepAlivePending_ = false;
+  }
+  request.kind = RpcKind::None;
+  pendingCount_--;
 }
 
 }  // namespace idk
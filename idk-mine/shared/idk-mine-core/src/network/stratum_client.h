@@ -1,51 +1,171 @@
 #pragma once
 
 #include <Arduino.h>
-#include <ArduinoJson.h>
 
 #include "config/runtime_config.h"
+#include "miner/share_target.h"
+#include "network/json_pull.h"
+#include "network/pool_selector.h"
+#include "network/stratum_job.h"
+#include "network/stratum_transport.h"
 
 namespace idk {
 
+// Upper bounds (ms) of the submit-to-response latency histogram buckets; the
+// last bucket takes everything slower.
+constexpr uint8_t kShareLatencyBuckets = 8;
+constexpr uint32_t kShareLatencyBucketMs[kShareLatencyBuckets - 1] = {50, 100, 200, 500, 1000, 2000, 5000};
+
+// Work handed to the miner: a complete header (nonce zero) plus the id the
+// shares found on it are submitted against.
 struct StratumJob {
   char jobId[48];
   char targetHex[24];
   uint32_t target32;
-  uint32_t seed;
+  uint32_t workId;
+  uint8_t header[80];
+  // Pool share target from mining.set_difficulty (difficulty 1 until the
+  // pool sends one).
+  bool hasTarget;
+  double difficulty;
+  ShareTarget target;
 };
 
 class StratumClient {
  public:
-  void begin(const RuntimeConfig* config);
+  void begin(const RuntimeConfig* config, StratumTransport* transport);
   void setCoin(CoinType coin);
   void setIdentity(const char* wallet, const char* worker, const char* minerName, const char* password);
   void loop(uint32_t nowMs, bool wifiConnected);
 
   bool connected() const;
   bool authorized() const;
+  // What the network task waits on between passes: the socket, and whether
+  // bytes are already readable (left over from the per-loop read budget or
+  // buffered by TLS) so waiting on the socket would stall them.
+  int socketFd() const;
+  bool hasPendingInput() const;
   bool hasActiveJob() const;
   uint32_t reconnectCount() const;
+  // Connections that went to a different endpoint than the previous one.
+  uint32_t failoverCount() const;
+  // Index into the coin's pool list and its measured connect latency.
+  uint8_t endpointIndex() const;
+  uint8_t endpointCount() const;
+  uint32_t endpointLatencyMs() const;
+
+  // TLS handshake cost and how often a cached session was resumed, plus the
+  // time from starting a connect to the first job from that pool.
+  uint32_t tlsHandshakeMs() const;
+  uint32_t tlsFullHandshakes() const;
+  uint32_t tlsResumedHandshakes() const;
+  uint32_t tlsPinFailures() const;
+  uint32_t connectToJobMs() const;
   uint32_t acceptedShares() const;
   uint32_t rejectedShares() const;
   const char* statusText() const;
 
   bool takeLatestJob(StratumJob& out);
-  void submitPseudoShare(uint32_t nonce, uint32_t hash32);
+  // Issues fresh work for the current job (next extranonce2) once the miner
+  // has searched its whole nonce space.
+  bool rollJob();
+  // Submits a nonce found on `workId`; work from a superseded job is dropped
+  // and counted as stale.
+  void submitShare(uint32_t workId, uint32_t nonce);
+  uint32_t staleShares() const;
+  uint32_t submittedShares() const;
+  // Submits that got no reply within kRequestTimeoutMs (or were in flight
+  // when the connection dropped).
+  uint32_t timedOutShares() const;
+  // Replies whose id matched no outstanding request, e.g. after a timeout.
+  uint32_t unmatchedResponses() const;
+  uint8_t pendingRequests() const;
+  uint32_t shareLatencyCount(uint8_t bucket) const;
+  uint32_t averageShareLatencyMs() const;
+  uint32_t maxShareLatencyMs() const;
+
+  // Updates expected (from hashrate and the share target) and observed
+  // share rates; call once per telemetry interval.
+  void sampleShareRate(uint32_t nowMs, float hashrate);
+  double difficulty() const;
+  float expectedSharesPerMinute() const;
+  float observedSharesPerMinute() const;
+
+  // Receive throughput and per-line handling cost since the previous call;
+  // call once per telemetry interval.
+  void sampleRx(uint32_t nowMs);
+  float rxBytesPerSecond() const;
+  uint32_t lineParseUs() const;
+  uint32_t maxLineParseUs() const;
+  uint32_t rxOverflows() const;
 
  private:
   void disconnect();
   bool connectSocket(uint32_t nowMs);
-  void sendSubscribe();
-  void sendAuthorize();
+  void sendSubscribe(uint32_t nowMs);
+  void sendAuthorize(uint32_t nowMs);
   void sendJsonLine(const char* line);
+  void formatUser(char* out, size_t outSize) const;
   void processInput(uint32_t nowMs);
-  void processLine(const char* line);
-  void tryParseNotify(const JsonVariantConst& params);
-
-  static uint32_t fastHash32(const char* text);
-  static uint32_t parseTarget32(const char* targetHex);
+  void drainRx();
+  void appendLine(const uint8_t* data, size_t len);
+  void finishLine();
+  void resetRx();
+  // Parses `line` in place (strings are unescaped into the buffer).
+  void processLine(char* line, size_t len);
+  void parseSubscribeResult(int16_t result);
+  void parseSetExtranonce(int16_t params);
+  void parseSetDifficulty(int16_t params);
+  void tryParseNotify(int16_t params);
+  void issueWork();
+  void formatRpcError(int16_t error, char* out, size_t outSize) const;
+  void recordShareLatency(uint32_t latencyMs);
+
+  // Requests awaiting a reply, keyed by JSON-RPC id, so every response is
+  // attributed to what was actually sent.
+  enum class RpcKind : uint8_t {
+    None,
+    Subscribe,
+    Authorize,
+    Submit,
+    KeepAlive,
+  };
+  struct PendingRequest {
+    uint32_t id;
+    RpcKind kind;
+    uint32_t sentMs;
+    uint32_t workId;
+    uint32_t nonce;
+  };
+  static constexpr uint8_t kMaxPendingRequests = 16;
+  static constexpr uint32_t kRequestTimeoutMs = 30000;
+  static constexpr uint32_t kMinKeepAliveTimeoutMs = 1000;
+
+  uint32_t trackRequest(RpcKind kind, uint32_t nowMs, uint32_t workId = 0, uint32_t nonce = 0);
+  bool takePendingRequest(uint32_t id, PendingRequest& out);
+  bool expirePendingRequests(uint32_t nowMs);
+  void dropPendingRequest(PendingRequest& request);
+  void sendKeepAlive(uint32_t nowMs);
+
+  // Recent work units, so a share found just before a roll or a non-clean
+  // job switch still resolves to its job id and extranonce2.
+  struct WorkRecord {
+    uint32_t workId;
+    char jobId[48];
+    uint64_t extranonce2;
+    uint32_t ntime;
+  };
+  static constexpr uint8_t kRecentWork = 4;
+
+  // Socket bytes are read in chunks into the ring and framed from there.
+  // Lines are assembled in a heap buffer that grows on demand up to
+  // kMaxLineBytes; a longer line is dropped up to its newline.
+  static constexpr size_t kRxRingBytes = 2048;
+  static constexpr size_t kInitialLineBytes = 1024;
+  static constexpr size_t kMaxLineBytes = 8192;
 
   const RuntimeConfig* config_ = nullptr;
+  StratumTransport* transport_ = nullptr;
   CoinType coin_ = CoinType::BTC;
 
   char wallet_[96];
@@ -53,27 +173,79 @@ class StratumClient {
   char minerName_[32];
   char password_[16];
 
-  bool usingTls_ = false;
+  PoolSelector selector_;
+  uint8_t endpointIndex_ = 0;
+  bool hasConnected_ = false;
+
   bool subscribed_ = false;
   bool authorized_ = false;
   bool hasValidJob_ = false;
   bool hasPendingJob_ = false;
   bool waitingAuthorizeResult_ = false;
+  bool hasSession_ = false;
+  bool keepAlivePending_ = false;
 
   uint32_t reconnectCount_ = 0;
+  uint32_t failoverCount_ = 0;
   uint32_t acceptedShares_ = 0;
   uint32_t rejectedShares_ = 0;
+  uint32_t staleShares_ = 0;
+  uint32_t submittedShares_ = 0;
+  uint32_t timedOutShares_ = 0;
+  uint32_t unmatchedResponses_ = 0;
+
+  PendingRequest pending_[kMaxPendingRequests]{};
+  uint8_t pendingCount_ = 0;
+  uint32_t shareLatencyHist_[kShareLatencyBuckets]{};
+  uint32_t shareLatencyTotalMs_ = 0;
+  uint32_t shareLatencyMaxMs_ = 0;
+
+  // Applies from the next mining.notify, as the protocol specifies.
+  double difficulty_ = 1.0;
+  double jobDifficulty_ = 1.0;
+  ShareTarget jobTarget_{};
+  uint32_t lastShareSampleMs_ = 0;
+  uint32_t lastSubmittedSample_ = 0;
+  float expectedSharesPerMinute_ = 0.0f;
+  float observedSharesPerMinute_ = 0.0f;
   uint32_t lastConnectAttemptMs_ = 0;
-  uint32_t lastIoMs_ = 0;
-  uint32_t nextRequestId_ = 3;
+  uint32_t connectStartMs_ = 0;
+  bool awaitingFirstJob_ = false;
+  uint32_t connectToJobMs_ = 0;
+  uint32_t lastRxMs_ = 0;
+  uint32_t nextRequestId_ = 1;
 
   StratumJob latestJob_;
+  StratumSession session_{};
+  StratumJobTemplate template_{};
+  uint64_t extranonce2_ = 0;
+  uint32_t nextWorkId_ = 1;
+  WorkRecord recentWork_[kRecentWork]{};
+  uint8_t recentWorkNext_ = 0;
 
   char status_[64];
-  char lineBuf_[1536];
+  char txBuf_[384];
+  uint8_t rxRing_[kRxRingBytes];
+  // Free-running; the ring index is the counter modulo kRxRingBytes.
+  size_t rxHead_ = 0;
+  size_t rxTail_ = 0;
+  char* lineBuf_ = nullptr;
+  size_t lineCap_ = 0;
   size_t lineLen_ = 0;
-
-  uint32_t authorizeRequestId_ = 2;
+  bool discardingLine_ = false;
+  JsonPull json_;
+
+  uint32_t rxBytes_ = 0;
+  uint32_t rxOverflows_ = 0;
+  uint32_t lineCount_ = 0;
+  uint32_t lineParseTotalUs_ = 0;
+  uint32_t lineParseMaxUs_ = 0;
+  uint32_t lastRxSampleMs_ = 0;
+  uint32_t lastRxSampleBytes_ = 0;
+  uint32_t lastRxSampleLines_ = 0;
+  uint32_t lastRxSampleParseUs_ = 0;
+  float rxBytesPerSecond_ = 0.0f;
+  uint32_t lineParseUs_ = 0;
 };
 
 }  // namespace idk
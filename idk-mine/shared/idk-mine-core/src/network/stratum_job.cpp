@@ -0,0 +1,202 @@
+#include "stratum_job.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "miner/sha256.h"
+
+namespace idk {
+namespace {
+
+void safeCopy(char* dst, size_t dstSize, const char* src) {
+  if (dst == nullptr || dstSize == 0) {
+    return;
+  }
+  if (src == nullptr) {
+    dst[0] = '\0';
+    return;
+  }
+  strncpy(dst, src, dstSize - 1);
+  dst[dstSize - 1] = '\0';
+}
+
+int hexNibble(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+// Decodes a whole hex string into `out`. Fails on odd length, bad digits or
+// more than `maxLen` bytes.
+bool decodeHex(const char* hex, uint8_t* out, size_t maxLen, size_t& outLen) {
+  outLen = 0;
+  if (hex == nullptr) {
+    return false;
+  }
+
+  const size_t chars = strlen(hex);
+  if ((chars & 1u) != 0 || chars / 2 > maxLen) {
+    return false;
+  }
+
+  for (size_t i = 0; i < chars / 2; ++i) {
+    const int hi = hexNibble(hex[i * 2]);
+    const int lo = hexNibble(hex[i * 2 + 1]);
+    if (hi < 0 || lo < 0) {
+      return false;
+    }
+    out[i] = static_cast<uint8_t>((hi << 4) | lo);
+  }
+  outLen = chars / 2;
+  return true;
+}
+
+bool decodeHexExact(const char* hex, uint8_t* out, size_t len) {
+  size_t got = 0;
+  return decodeHex(hex, out, len, got) && got == len;
+}
+
+bool decodeU32(const char* hex, uint32_t& out) {
+  uint8_t bytes[4];
+  if (!decodeHexExact(hex, bytes, sizeof(bytes))) {
+    return false;
+  }
+  out = (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16) |
+        (static_cast<uint32_t>(bytes[2]) << 8) | bytes[3];
+  return true;
+}
+
+void writeLe32(uint8_t* p, uint32_t v) {
+  p[0] = static_cast<uint8_t>(v);
+  p[1] = static_cast<uint8_t>(v >> 8);
+  p[2] = static_cast<uint8_t>(v >> 16);
+  p[3] = static_cast<uint8_t>(v >> 24);
+}
+
+}  // namespace
+
+bool parseStratumExtranonce1(const char* hex, StratumSession& session) {
+  size_t len = 0;
+  if (!decodeHex(hex, session.extranonce1, sizeof(session.extranonce1), len)) {
+    return false;
+  }
+  session.extranonce1Size = static_cast<uint8_t>(len);
+  return true;
+}
+
+bool buildStratumJobTemplate(const StratumNotify& notify, const StratumSession& session, StratumJobTemplate& out,
+                             char* err, size_t errSize) {
+  memset(&out, 0, sizeof(out));
+  safeCopy(out.jobId, sizeof(out.jobId), (notify.jobId != nullptr) ? notify.jobId : "job");
+  out.cleanJobs = notify.cleanJobs;
+
+  if (!decodeU32(notify.version, out.version) || !decodeU32(notify.nbits, out.nbits) ||
+      !decodeU32(notify.ntime, out.ntime)) {
+    snprintf(err, errSize, "bad version/nbits/ntime");
+    return false;
+  }
+
+  // Stratum sends prevhash as eight 32-bit words with their bytes swapped
+  // relative to header order.
+  uint8_t prev[32];
+  if (!decodeHexExact(notify.prevHash, prev, sizeof(prev))) {
+    snprintf(err, errSize, "bad prevhash");
+    return false;
+  }
+  for (uint8_t word = 0; word < 8; ++word) {
+    for (uint8_t b = 0; b < 4; ++b) {
+      out.prevHash[word * 4 + b] = prev[word * 4 + (3 - b)];
+    }
+  }
+
+  if (session.extranonce2Size == 0 || session.extranonce2Size > kStratumMaxExtranonceBytes) {
+    snprintf(err, errSize, "bad extranonce2 size %u", static_cast<unsigned>(session.extranonce2Size));
+    return false;
+  }
+
+  // coinbase = coinb1 || extranonce1 || extranonce2 || coinb2
+  size_t coinb1Len = 0;
+  if (!decodeHex(notify.coinb1, out.coinbase, sizeof(out.coinbase), coinb1Len)) {
+    snprintf(err, errSize, "bad coinb1");
+    return false;
+  }
+  size_t pos = coinb1Len;
+  const size_t extranonceLen = session.extranonce1Size + session.extranonce2Size;
+  if (pos + extranonceLen > sizeof(out.coinbase)) {
+    snprintf(err, errSize, "coinbase too large");
+    return false;
+  }
+  memcpy(out.coinbase + pos, session.extranonce1, session.extranonce1Size);
+  pos += session.extranonce1Size;
+  out.extranonce2Offset = static_cast<uint16_t>(pos);
+  out.extranonce2Size = session.extranonce2Size;
+  pos += session.extranonce2Size;
+
+  size_t coinb2Len = 0;
+  if (!decodeHex(notify.coinb2, out.coinbase + pos, sizeof(out.coinbase) - pos, coinb2Len)) {
+    snprintf(err, errSize, "bad coinb2");
+    return false;
+  }
+  out.coinbaseLen = static_cast<uint16_t>(pos + coinb2Len);
+
+  if (notify.merkleBranchCount > kStratumMaxMerkleBranches) {
+    snprintf(err, errSize, "too many merkle branches");
+    return false;
+  }
+  for (uint8_t i = 0; i < notify.merkleBranchCount; ++i) {
+    if (!decodeHexExact(notify.merkleBranches[i], out.merkleBranches[i], 32)) {
+      snprintf(err, errSize, "bad merkle branch %u", static_cast<unsigned>(i));
+      return false;
+    }
+  }
+  out.merkleBranchCount = notify.merkleBranchCount;
+  return true;
+}
+
+void buildStratumHeader(StratumJobTemplate& tmpl, uint64_t extranonce2, uint8_t header[80]) {
+  for (uint8_t i = 0; i < tmpl.extranonce2Size; ++i) {
+    tmpl.coinbase[tmpl.extranonce2Offset + i] =
+        static_cast<uint8_t>(extranonce2 >> (8 * (tmpl.extranonce2Size - 1 - i)));
+  }
+
+  // Merkle root: the coinbase txid folded with each branch, all in internal
+  // (hash output) byte order, which is also header order.
+  uint8_t node[64];
+  sha256d(tmpl.coinbase, tmpl.coinbaseLen, node);
+  for (uint8_t i = 0; i < tmpl.merkleBranchCount; ++i) {
+    memcpy(node + 32, tmpl.merkleBranches[i], 32);
+    sha256d(node, sizeof(node), node);
+  }
+
+  writeLe32(header, tmpl.version);
+  memcpy(header + 4, tmpl.prevHash, 32);
+  memcpy(header + 36, node, 32);
+  writeLe32(header + 68, tmpl.ntime);
+  writeLe32(header + 72, tmpl.nbits);
+  writeLe32(header + 76, 0);
+}
+
+void formatStratumExtranonce2(uint64_t extranonce2, uint8_t size, char* out, size_t outSize) {
+  static const char kHex[] = "0123456789abcdef";
+  if (out == nullptr || outSize == 0) {
+    return;
+  }
+
+  size_t pos = 0;
+  for (uint8_t i = 0; i < size && pos + 2 < outSize; ++i) {
+    const uint8_t b = static_cast<uint8_t>(extranonce2 >> (8 * (size - 1 - i)));
+    out[pos++] = kHex[b >> 4];
+    out[pos++] = kHex[b & 0x0F];
+  }
+  out[pos] = '\0';
+}
+
+}  // namespace idk
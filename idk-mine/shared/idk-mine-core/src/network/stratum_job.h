@@ -0,0 +1,64 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace idk {
+
+constexpr size_t kStratumMaxCoinbaseBytes = 512;
+constexpr uint8_t kStratumMaxMerkleBranches = 16;
+constexpr uint8_t kStratumMaxExtranonceBytes = 8;
+
+// Raw mining.notify fields as hex strings (not owned; only read while the
+// template is built).
+struct StratumNotify {
+  const char* jobId;
+  const char* prevHash;
+  const char* coinb1;
+  const char* coinb2;
+  const char* merkleBranches[kStratumMaxMerkleBranches];
+  uint8_t merkleBranchCount;
+  const char* version;
+  const char* nbits;
+  const char* ntime;
+  bool cleanJobs;
+};
+
+// Session values from the mining.subscribe result.
+struct StratumSession {
+  uint8_t extranonce1[kStratumMaxExtranonceBytes];
+  uint8_t extranonce1Size;
+  uint8_t extranonce2Size;
+};
+
+// One notify decoded into binary form. The coinbase already contains
+// extranonce1 and a zeroed extranonce2 slot at extranonce2Offset.
+struct StratumJobTemplate {
+  char jobId[48];
+  uint32_t version;
+  uint32_t nbits;
+  uint32_t ntime;
+  uint8_t prevHash[32];  // header byte order
+  uint8_t coinbase[kStratumMaxCoinbaseBytes];
+  uint16_t coinbaseLen;
+  uint16_t extranonce2Offset;
+  uint8_t extranonce2Size;
+  uint8_t merkleBranches[kStratumMaxMerkleBranches][32];
+  uint8_t merkleBranchCount;
+  bool cleanJobs;
+};
+
+bool parseStratumExtranonce1(const char* hex, StratumSession& session);
+
+bool buildStratumJobTemplate(const StratumNotify& notify, const StratumSession& session, StratumJobTemplate& out,
+                             char* err, size_t errSize);
+
+// Writes `extranonce2` into the coinbase (big-endian, extranonce2Size bytes,
+// so it matches formatStratumExtranonce2) and assembles the 80-byte header
+// with the resulting merkle root and a zero nonce.
+void buildStratumHeader(StratumJobTemplate& tmpl, uint64_t extranonce2, uint8_t header[80]);
+
+// Hex form of `extranonce2` as mining.submit expects it.
+void formatStratumExtranonce2(uint64_t extranonce2, uint8_t size, char* out, size_t outSize);
+
+}  // namespace idk
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "config/runtime_config.h"
+
+namespace idk {
+
+// TLS handshake counters; all zero for transports without TLS.
+struct StratumTransportStats {
+  uint32_t handshakeMs;
+  uint32_t fullHandshakes;
+  uint32_t resumedHandshakes;
+  uint32_t pinFailures;
+};
+
+// Byte stream to one pool plus connect-time probing of others. The stratum
+// client only talks to the network through this, so it runs unchanged over
+// Wi-Fi on the device and over POSIX sockets on the host.
+class StratumTransport {
+ public:
+  virtual ~StratumTransport() {}
+
+  // Blocking connect (and TLS handshake when the endpoint asks for it).
+  virtual bool connect(const PoolEndpointConfig& endpoint, uint32_t timeoutMs) = 0;
+  virtual void close() = 0;
+  virtual bool connected() = 0;
+  // Non-blocking: bytes ready now, and a read of at most that many.
+  virtual int available() = 0;
+  virtual int read(uint8_t* buf, size_t len) = 0;
+  virtual size_t write(const uint8_t* buf, size_t len) = 0;
+
+  // Whether the network link is up at all (Wi-Fi associated on device).
+  virtual bool linkUp() = 0;
+  // Times a throwaway plain TCP connect to `endpoint`. Called from the
+  // probe task, concurrently with the connection above.
+  virtual bool probe(const PoolEndpointConfig& endpoint, uint32_t timeoutMs, uint32_t& connectMs) = 0;
+  // Descriptor that turns readable when data arrives, for select(); -1 when
+  // not connected or not known. Bytes already buffered above the socket (a
+  // decrypted TLS record) only show in available().
+  virtual int socketFd() const {
+    return -1;
+  }
+
+  // Time spent on the TLS handshake in the last connect().
+  virtual uint32_t lastHandshakeMs() const {
+    return 0;
+  }
+  virtual StratumTransportStats stats() const {
+    return StratumTransportStats{};
+  }
+};
+
+}  // namespace idk
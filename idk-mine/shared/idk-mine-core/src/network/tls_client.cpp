@@ -0,0 +1,326 @@
+// Device only; native builds use PosixStratumTransport and have no mbedtls.
+#if !IDK_NATIVE
+
+#include "tls_client.h"
+
+#include <esp_system.h>
+#include <mbedtls/net_sockets.h>
+
+#include "miner/sha256.h"
+
+namespace idk {
+namespace {
+
+int randomBytes(void*, unsigned char* out, size_t len) {
+  esp_fill_random(out, len);
+  return 0;
+}
+
+bool wouldBlock(int ret) {
+  return ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE;
+}
+
+}  // namespace
+
+TlsClient::TlsClient() {
+  mbedtls_ssl_init(&ssl_);
+  mbedtls_ssl_session_init(&session_);
+}
+
+TlsClient::~TlsClient() {
+  stop();
+  dropSession();
+  if (configReady_) {
+    mbedtls_ssl_config_free(&conf_);
+  }
+}
+
+void TlsClient::setPin(const uint8_t* fingerprint) {
+  const bool pinned = fingerprint != nullptr;
+  if (pinned != pinned_ || (pinned && memcmp(pin_, fingerprint, sizeof(pin_)) != 0)) {
+    // A cached session was authenticated against the old pin.
+    dropSession();
+  }
+  pinned_ = pinned;
+  if (pinned) {
+    memcpy(pin_, fingerprint, sizeof(pin_));
+  }
+}
+
+void TlsClient::setHandshakeTimeout(uint32_t timeoutMs) {
+  handshakeTimeoutMs_ = (timeoutMs == 0) ? 1 : timeoutMs;
+}
+
+int TlsClient::connect(IPAddress ip, uint16_t port) {
+  return connect(ip.toString().c_str(), port, static_cast<int32_t>(handshakeTimeoutMs_));
+}
+
+int TlsClient::connect(const char* host, uint16_t port) {
+  return connect(host, port, static_cast<int32_t>(handshakeTimeoutMs_));
+}
+
+int TlsClient::connect(IPAddress ip, uint16_t port, int32_t timeoutMs) {
+  return connect(ip.toString().c_str(), port, timeoutMs);
+}
+
+int TlsClient::connect(const char* host, uint16_t port, int32_t timeoutMs) {
+  stop();
+  if (host == nullptr || !setupConfig()) {
+    return 0;
+  }
+
+  if (!tcp_.connect(host, port, timeoutMs)) {
+    return 0;
+  }
+  tcp_.setNoDelay(true);
+
+  if (!handshake(host, port)) {
+    closeSsl();
+    tcp_.stop();
+    return 0;
+  }
+  return 1;
+}
+
+size_t TlsClient::write(uint8_t b) {
+  return write(&b, 1);
+}
+
+size_t TlsClient::write(const uint8_t* buf, size_t size) {
+  if (!sslActive_) {
+    return 0;
+  }
+
+  size_t written = 0;
+  const uint32_t startMs = millis();
+  while (written < size) {
+    const int ret = mbedtls_ssl_write(&ssl_, buf + written, size - written);
+    if (ret > 0) {
+      written += static_cast<size_t>(ret);
+      continue;
+    }
+    if (!wouldBlock(ret)) {
+      stop();
+      break;
+    }
+    if (millis() - startMs > handshakeTimeoutMs_) {
+      break;
+    }
+    delay(1);
+  }
+  return written;
+}
+
+int TlsClient::available() {
+  if (!sslActive_) {
+    return 0;
+  }
+
+  // A zero-length read processes any pending record so its plaintext shows
+  // up in the available count.
+  const int ret = mbedtls_ssl_read(&ssl_, nullptr, 0);
+  if (ret < 0 && !wouldBlock(ret)) {
+    stop();
+    return 0;
+  }
+  return static_cast<int>(mbedtls_ssl_get_bytes_avail(&ssl_));
+}
+
+int TlsClient::read() {
+  uint8_t b = 0;
+  return (read(&b, 1) == 1) ? b : -1;
+}
+
+int TlsClient::read(uint8_t* buf, size_t size) {
+  if (!sslActive_ || size == 0) {
+    return -1;
+  }
+
+  const int ret = mbedtls_ssl_read(&ssl_, buf, size);
+  if (ret > 0) {
+    return ret;
+  }
+  if (!wouldBlock(ret)) {
+    // 0 is the peer's close_notify; anything else is fatal.
+    stop();
+  }
+  return -1;
+}
+
+int TlsClient::peek() {
+  // Not needed by the stratum client, and mbedtls has no peek.
+  return -1;
+}
+
+void TlsClient::flush() {}
+
+void TlsClient::stop() {
+  if (sslActive_) {
+    mbedtls_ssl_close_notify(&ssl_);
+    closeSsl();
+  }
+  tcp_.stop();
+}
+
+uint8_t TlsClient::connected() {
+  return sslActive_ && (tcp_.connected() || mbedtls_ssl_get_bytes_avail(&ssl_) > 0);
+}
+
+TlsClient::operator bool() {
+  return connected() != 0;
+}
+
+int TlsClient::fd() const {
+  return tcp_.fd();
+}
+
+uint32_t TlsClient::lastHandshakeMs() const {
+  return lastHandshakeMs_;
+}
+
+bool TlsClient::lastHandshakeResumed() const {
+  return lastHandshakeResumed_;
+}
+
+uint32_t TlsClient::fullHandshakes() const {
+  return fullHandshakes_;
+}
+
+uint32_t TlsClient::resumedHandshakes() const {
+  return resumedHandshakes_;
+}
+
+uint32_t TlsClient::pinFailures() const {
+  return pinFailures_;
+}
+
+int TlsClient::sendCallback(void* ctx, const unsigned char* buf, size_t len) {
+  TlsClient* self = static_cast<TlsClient*>(ctx);
+  if (!self->tcp_.connected()) {
+    return MBEDTLS_ERR_NET_CONN_RESET;
+  }
+  const size_t sent = self->tcp_.write(buf, len);
+  return (sent == 0) ? MBEDTLS_ERR_SSL_WANT_WRITE : static_cast<int>(sent);
+}
+
+int TlsClient::recvCallback(void* ctx, unsigned char* buf, size_t len) {
+  TlsClient* self = static_cast<TlsClient*>(ctx);
+  const int available = self->tcp_.available();
+  if (available <= 0) {
+    return self->tcp_.connected() ? MBEDTLS_ERR_SSL_WANT_READ : MBEDTLS_ERR_NET_CONN_RESET;
+  }
+  const size_t want = (len < static_cast<size_t>(available)) ? len : static_cast<size_t>(available);
+  const int got = self->tcp_.read(buf, want);
+  return (got > 0) ? got : MBEDTLS_ERR_SSL_WANT_READ;
+}
+
+int TlsClient::verifyCallback(void* ctx, mbedtls_x509_crt* crt, int depth, uint32_t* flags) {
+  TlsClient* self = static_cast<TlsClient*>(ctx);
+  self->certSeen_ = true;
+  if (depth == 0 && self->pinned_) {
+    uint8_t digest[32];
+    sha256(crt->raw.p, crt->raw.len, digest);
+    self->pinMatched_ = memcmp(digest, self->pin_, sizeof(digest)) == 0;
+  }
+
+  // There is no CA store; trust comes from the pin (checked once the
+  // handshake completes) or is waived entirely when unpinned.
+  *flags = 0;
+  return 0;
+}
+
+bool TlsClient::setupConfig() {
+  if (configReady_) {
+    return true;
+  }
+
+  mbedtls_ssl_config_init(&conf_);
+  if (mbedtls_ssl_config_defaults(&conf_, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_STREAM,
+                                  MBEDTLS_SSL_PRESET_DEFAULT) != 0) {
+    mbedtls_ssl_config_free(&conf_);
+    return false;
+  }
+  mbedtls_ssl_conf_authmode(&conf_, MBEDTLS_SSL_VERIFY_OPTIONAL);
+  mbedtls_ssl_conf_verify(&conf_, verifyCallback, this);
+  mbedtls_ssl_conf_rng(&conf_, randomBytes, nullptr);
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+  mbedtls_ssl_conf_session_tickets(&conf_, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+#endif
+
+  configReady_ = true;
+  return true;
+}
+
+bool TlsClient::handshake(const char* host, uint16_t port) {
+  mbedtls_ssl_init(&ssl_);
+  if (mbedtls_ssl_setup(&ssl_, &conf_) != 0) {
+    mbedtls_ssl_free(&ssl_);
+    return false;
+  }
+  sslActive_ = true;
+  mbedtls_ssl_set_hostname(&ssl_, host);
+  mbedtls_ssl_set_bio(&ssl_, this, sendCallback, recvCallback, nullptr);
+
+  bool offered = hasSession_ && sessionPort_ == port && strcmp(sessionHost_, host) == 0;
+  if (offered && mbedtls_ssl_set_session(&ssl_, &session_) != 0) {
+    dropSession();
+    offered = false;
+  }
+
+  certSeen_ = false;
+  pinMatched_ = false;
+  const uint32_t startMs = millis();
+  int ret = 0;
+  while ((ret = mbedtls_ssl_handshake(&ssl_)) != 0) {
+    if (!wouldBlock(ret) || millis() - startMs > handshakeTimeoutMs_) {
+      // A rejected session would fail the same way next time.
+      if (offered) {
+        dropSession();
+      }
+      return false;
+    }
+    delay(1);
+  }
+  lastHandshakeMs_ = millis() - startMs;
+
+  // The server skips its certificate only when it accepts the session.
+  const bool resumed = offered && !certSeen_;
+  if (pinned_ && !resumed && !pinMatched_) {
+    pinFailures_++;
+    dropSession();
+    return false;
+  }
+
+  lastHandshakeResumed_ = resumed;
+  if (resumed) {
+    resumedHandshakes_++;
+  } else {
+    fullHandshakes_++;
+  }
+
+  // Keep the current session (a server may rotate its ticket) for the next
+  // connect.
+  mbedtls_ssl_session_free(&session_);
+  mbedtls_ssl_session_init(&session_);
+  hasSession_ = mbedtls_ssl_get_session(&ssl_, &session_) == 0;
+  if (hasSession_) {
+    strlcpy(sessionHost_, host, sizeof(sessionHost_));
+    sessionPort_ = port;
+  }
+  return true;
+}
+
+void TlsClient::dropSession() {
+  mbedtls_ssl_session_free(&session_);
+  mbedtls_ssl_session_init(&session_);
+  hasSession_ = false;
+}
+
+void TlsClient::closeSsl() {
+  mbedtls_ssl_free(&ssl_);
+  sslActive_ = false;
+}
+
+}  // namespace idk
+
+#endif  // !IDK_NATIVE
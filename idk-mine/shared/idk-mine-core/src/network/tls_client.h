@@ -0,0 +1,90 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Client.h>
+#include <WiFi.h>
+#include <mbedtls/ssl.h>
+
+namespace idk {
+
+// TLS over a WiFiClient with session resumption. WiFiClientSecure runs a
+// full handshake on every connect; this client keeps the last session
+// (session ID or ticket, whichever the server issues) and offers it on the
+// next connect to the same host and port, which skips the key exchange and
+// certificate processing.
+//
+// Without a pin the server certificate is not verified, like
+// WiFiClientSecure::setInsecure(). With a pin the leaf certificate's SHA-256
+// must match or the connection is refused.
+class TlsClient : public Client {
+ public:
+  TlsClient();
+  ~TlsClient() override;
+
+  // SHA-256 of the expected leaf certificate (DER), or nullptr to accept
+  // any certificate. Applies from the next connect.
+  void setPin(const uint8_t* fingerprint);
+  void setHandshakeTimeout(uint32_t timeoutMs);
+
+  int connect(IPAddress ip, uint16_t port) override;
+  int connect(const char* host, uint16_t port) override;
+  // Not marked override: only some core versions declare these in Client.
+  int connect(IPAddress ip, uint16_t port, int32_t timeoutMs);
+  int connect(const char* host, uint16_t port, int32_t timeoutMs);
+  size_t write(uint8_t b) override;
+  size_t write(const uint8_t* buf, size_t size) override;
+  int available() override;
+  int read() override;
+  int read(uint8_t* buf, size_t size) override;
+  int peek() override;
+  void flush() override;
+  void stop() override;
+  uint8_t connected() override;
+  operator bool() override;
+  // The underlying socket, or -1.
+  int fd() const;
+
+  // Last handshake and running totals, split by whether the offered session
+  // was accepted.
+  uint32_t lastHandshakeMs() const;
+  bool lastHandshakeResumed() const;
+  uint32_t fullHandshakes() const;
+  uint32_t resumedHandshakes() const;
+  uint32_t pinFailures() const;
+
+ private:
+  static int sendCallback(void* ctx, const unsigned char* buf, size_t len);
+  static int recvCallback(void* ctx, unsigned char* buf, size_t len);
+  static int verifyCallback(void* ctx, mbedtls_x509_crt* crt, int depth, uint32_t* flags);
+
+  bool setupConfig();
+  bool handshake(const char* host, uint16_t port);
+  void dropSession();
+  void closeSsl();
+
+  WiFiClient tcp_;
+  mbedtls_ssl_config conf_;
+  mbedtls_ssl_context ssl_;
+  bool configReady_ = false;
+  bool sslActive_ = false;
+
+  mbedtls_ssl_session session_;
+  bool hasSession_ = false;
+  char sessionHost_[64] = {0};
+  uint16_t sessionPort_ = 0;
+
+  uint8_t pin_[32] = {0};
+  bool pinned_ = false;
+  // Set by the verify callback; a resumed handshake sends no certificate.
+  bool certSeen_ = false;
+  bool pinMatched_ = false;
+
+  uint32_t handshakeTimeoutMs_ = 5000;
+  uint32_t lastHandshakeMs_ = 0;
+  bool lastHandshakeResumed_ = false;
+  uint32_t fullHandshakes_ = 0;
+  uint32_t resumedHandshakes_ = 0;
+  uint32_t pinFailures_ = 0;
+};
+
+}  // namespace idk
@@ -60,6 +60,10 @@ uint32_t WifiManager::reconnectCount() const {
   return reconnectCount_;
 }
 
+int8_t WifiManager::rssi() const {
+  return connected() ? static_cast<int8_t>(WiFi.RSSI()) : 0;
+}
+
 void WifiManager::startConnect(uint32_t nowMs) {
   lastAttemptMs_ = nowMs;
   reconnectCount_++;
@@ -14,6 +14,8 @@ class WifiManager {
   const char* statusText() const;
   const char* ipText();
   uint32_t reconnectCount() const;
+  // Signal strength in dBm, 0 while disconnected.
+  int8_t rssi() const;
 
  private:
   void startConnect(uint32_t nowMs);
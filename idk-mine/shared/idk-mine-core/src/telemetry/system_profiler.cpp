@@ -0,0 +1,134 @@
+#include "system_profiler.h"
+
+#include <esp_heap_caps.h>
+
+namespace idk {
+namespace {
+
+void safeCopy(char* dst, size_t dstSize, const char* src) {
+  if (dst == nullptr || dstSize == 0) {
+    return;
+  }
+  if (src == nullptr) {
+    dst[0] = '\0';
+    return;
+  }
+  strlcpy(dst, src, dstSize);
+}
+
+float percentOf(uint32_t part, uint32_t whole) {
+  if (whole == 0) {
+    return 0.0f;
+  }
+  const float pct = 100.0f * static_cast<float>(part) / static_cast<float>(whole);
+  return (pct > 100.0f) ? 100.0f : pct;
+}
+
+}  // namespace
+
+void SystemProfiler::begin(uint32_t stackAlertBytes, uint32_t heapAlertBytes) {
+  stackAlertBytes_ = stackAlertBytes;
+  heapAlertBytes_ = heapAlertBytes;
+  lastSampleUs_ = micros();
+}
+
+uint8_t SystemProfiler::track(const char* name, TaskHandle_t task, uint32_t stackBytes) {
+  if (taskCount_ >= kProfiledTasks || task == nullptr) {
+    return kProfiledTasks;
+  }
+  TrackedTask& t = tasks_[taskCount_];
+  safeCopy(t.name, sizeof(t.name), name);
+  t.handle = task;
+  t.stackBytes = stackBytes;
+  return taskCount_++;
+}
+
+void SystemProfiler::reportBusyUs(uint8_t slot, uint32_t totalUs) {
+  if (slot < taskCount_) {
+    tasks_[slot].busyUs = totalUs;
+  }
+}
+
+void SystemProfiler::sample() {
+#if configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS
+  const uint32_t totalRunTime = static_cast<uint32_t>(portGET_RUN_TIME_COUNTER_VALUE());
+  const uint32_t elapsedRunTime = totalRunTime - lastTotalRunTime_;
+  lastTotalRunTime_ = totalRunTime;
+#else
+  const uint32_t nowUs = micros();
+  const uint32_t elapsedUs = nowUs - lastSampleUs_;
+  lastSampleUs_ = nowUs;
+#endif
+
+  alert_ = false;
+  alertText_[0] = '\0';
+  uint32_t worstStack = 0xFFFFFFFFu;
+
+  for (uint8_t i = 0; i < taskCount_; ++i) {
+    TrackedTask& t = tasks_[i];
+
+#if configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS
+    TaskStatus_t status;
+    vTaskGetInfo(t.handle, &status, pdFALSE, eInvalid);
+    t.cpuPercent = percentOf(status.ulRunTimeCounter - t.lastRunTime, elapsedRunTime);
+    t.lastRunTime = status.ulRunTimeCounter;
+#else
+    t.cpuPercent = percentOf(t.busyUs - t.lastBusyUs, elapsedUs);
+    t.lastBusyUs = t.busyUs;
+#endif
+
+    // ESP-IDF stacks are sized and measured in bytes.
+    t.stackFree = uxTaskGetStackHighWaterMark(t.handle);
+    if (t.stackFree < stackAlertBytes_ && t.stackFree < worstStack) {
+      worstStack = t.stackFree;
+      alert_ = true;
+      snprintf(alertText_, sizeof(alertText_), "stack:%s:%luB", t.name, static_cast<unsigned long>(t.stackFree));
+    }
+  }
+
+  minFreeHeap_ = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+  largestFreeBlock_ = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+  // A stack about to overflow is the more urgent of the two.
+  if (!alert_ && minFreeHeap_ < heapAlertBytes_) {
+    alert_ = true;
+    snprintf(alertText_, sizeof(alertText_), "heap:%luB", static_cast<unsigned long>(minFreeHeap_));
+  }
+}
+
+uint8_t SystemProfiler::taskCount() const {
+  return taskCount_;
+}
+
+const char* SystemProfiler::taskName(uint8_t slot) const {
+  return (slot < taskCount_) ? tasks_[slot].name : "";
+}
+
+float SystemProfiler::cpuPercent(uint8_t slot) const {
+  return (slot < taskCount_) ? tasks_[slot].cpuPercent : 0.0f;
+}
+
+uint32_t SystemProfiler::stackFreeBytes(uint8_t slot) const {
+  return (slot < taskCount_) ? tasks_[slot].stackFree : 0;
+}
+
+uint32_t SystemProfiler::stackBytes(uint8_t slot) const {
+  return (slot < taskCount_) ? tasks_[slot].stackBytes : 0;
+}
+
+uint32_t SystemProfiler::minFreeHeap() const {
+  return minFreeHeap_;
+}
+
+uint32_t SystemProfiler::largestFreeBlock() const {
+  return largestFreeBlock_;
+}
+
+bool SystemProfiler::alert() const {
+  return alert_;
+}
+
+const char* SystemProfiler::alertText() const {
+  return alertText_;
+}
+
+}  // namespace idk
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+namespace idk {
+
+constexpr uint8_t kProfiledTasks = 4;
+
+// Per-task CPU and stack use plus heap headroom, sampled by the network task
+// once per telemetry interval.
+//
+// CPU comes from the FreeRTOS run-time counters when the core is built with
+// them (configGENERATE_RUN_TIME_STATS). Otherwise each task reports its own
+// busy time through reportBusyUs(): the wall time it spends outside its
+// waits, which counts preemption by higher-priority tasks against it. Either
+// way it is a percentage of one core.
+class SystemProfiler {
+ public:
+  // alert() trips when a task's free stack or the heap low-water mark drops
+  // below these limits (bytes).
+  void begin(uint32_t stackAlertBytes, uint32_t heapAlertBytes);
+
+  // Returns the slot, or kProfiledTasks when every slot is taken.
+  uint8_t track(const char* name, TaskHandle_t task, uint32_t stackBytes);
+  // Running total (wrapping) of the slot's self-timed busy microseconds.
+  // Network task, before sample().
+  void reportBusyUs(uint8_t slot, uint32_t totalUs);
+
+  void sample();
+
+  uint8_t taskCount() const;
+  const char* taskName(uint8_t slot) const;
+  float cpuPercent(uint8_t slot) const;
+  uint32_t stackFreeBytes(uint8_t slot) const;
+  uint32_t stackBytes(uint8_t slot) const;
+  uint32_t minFreeHeap() const;
+  uint32_t largestFreeBlock() const;
+
+  // Whether any stack or the heap low-water mark is under its limit, and
+  // which one is closest ("stack:idk-net:380B" or "heap:14200B").
+  bool alert() const;
+  const char* alertText() const;
+
+ private:
+  struct TrackedTask {
+    char name[16];
+    TaskHandle_t handle;
+    uint32_t stackBytes;
+    uint32_t stackFree;
+    uint32_t busyUs;
+    uint32_t lastBusyUs;
+    uint32_t lastRunTime;
+    float cpuPercent;
+  };
+
+  TrackedTask tasks_[kProfiledTasks]{};
+  uint8_t taskCount_ = 0;
+  uint32_t lastSampleUs_ = 0;
+  uint32_t lastTotalRunTime_ = 0;
+  uint32_t minFreeHeap_ = 0;
+  uint32_t largestFreeBlock_ = 0;
+  uint32_t stackAlertBytes_ = 512;
+  uint32_t heapAlertBytes_ = 16 * 1024;
+  bool alert_ = false;
+  char alertText_[40] = "";
+};
+
+}  // namespace idk
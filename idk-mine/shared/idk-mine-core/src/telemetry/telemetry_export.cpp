@@ -0,0 +1,218 @@
+#include "telemetry_export.h"
+
+namespace idk {
+namespace {
+
+constexpr uint8_t kSync0 = 0xA5;
+constexpr uint8_t kSync1 = 0x5A;
+// Sync, type, length before the payload; CRC after it.
+constexpr size_t kFrameHeaderBytes = 4;
+constexpr size_t kFrameCrcBytes = 2;
+// Samples copied out of the history per lock.
+constexpr size_t kCopyChunk = 16;
+
+uint16_t crc16Ccitt(const uint8_t* data, size_t len) {
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < len; ++i) {
+    crc ^= static_cast<uint16_t>(data[i]) << 8;
+    for (uint8_t bit = 0; bit < 8; ++bit) {
+      crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+    }
+  }
+  return crc;
+}
+
+// Little-endian writer over a frame buffer.
+class FrameWriter {
+ public:
+  FrameWriter(uint8_t* out, size_t outSize, uint8_t type) : out_(out), size_(outSize) {
+    put8(kSync0);
+    put8(kSync1);
+    put8(type);
+    put8(0);
+  }
+
+  void put8(uint8_t value) {
+    if (len_ < size_) {
+      out_[len_] = value;
+    }
+    ++len_;
+  }
+  void put16(uint16_t value) {
+    put8(static_cast<uint8_t>(value));
+    put8(static_cast<uint8_t>(value >> 8));
+  }
+  void put32(uint32_t value) {
+    put16(static_cast<uint16_t>(value));
+    put16(static_cast<uint16_t>(value >> 16));
+  }
+  void putFloat(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    put32(bits);
+  }
+
+  // Fills in the length and appends the CRC; 0 if the buffer was too small.
+  size_t finish() {
+    const size_t payload = len_ - kFrameHeaderBytes;
+    if (len_ + kFrameCrcBytes > size_ || payload > 0xFF) {
+      return 0;
+    }
+    out_[3] = static_cast<uint8_t>(payload);
+    put16(crc16Ccitt(out_ + 2, len_ - 2));
+    return len_;
+  }
+
+ private:
+  uint8_t* out_;
+  size_t size_;
+  size_t len_ = 0;
+};
+
+void writeFrame(const uint8_t* frame, size_t len) {
+  if (len > 0) {
+    Serial.write(frame, len);
+  }
+}
+
+}  // namespace
+
+size_t encodeSampleFrame(uint32_t seq, const TelemetrySample& sample, uint8_t* out, size_t outSize) {
+  FrameWriter w(out, outSize, kTelemetryFrameSample);
+  w.put32(seq);
+  w.put32(sample.uptimeMs);
+  w.putFloat(sample.hashrate);
+  w.put32(sample.accepted);
+  w.put32(sample.rejected);
+  w.put32(sample.freeHeap);
+  w.put8(static_cast<uint8_t>(sample.rssi));
+  w.put32(sample.jobAgeMs);
+  return w.finish();
+}
+
+void TelemetryExporter::begin(const TelemetryHistory* history) {
+  history_ = history;
+  stream_ = Format::Off;
+  commandLen_ = 0;
+  discardingCommand_ = false;
+}
+
+void TelemetryExporter::poll() {
+  if (history_ == nullptr) {
+    return;
+  }
+
+  while (Serial.available() > 0) {
+    const int c = Serial.read();
+    if (c < 0) {
+      break;
+    }
+    if (c == '\n' || c == '\r') {
+      if (!discardingCommand_ && commandLen_ > 0) {
+        command_[commandLen_] = '\0';
+        handleCommand(command_);
+      }
+      commandLen_ = 0;
+      discardingCommand_ = false;
+      continue;
+    }
+    if (commandLen_ + 1 >= sizeof(command_)) {
+      discardingCommand_ = true;
+      continue;
+    }
+    command_[commandLen_++] = static_cast<char>(c);
+  }
+
+  if (stream_ == Format::Off) {
+    return;
+  }
+
+  TelemetrySample samples[kCopyChunk];
+  uint32_t firstSeq = 0;
+  size_t count;
+  while ((count = history_->copySince(streamSeq_, samples, kCopyChunk, firstSeq)) > 0) {
+    for (size_t i = 0; i < count; ++i) {
+      emit(stream_, firstSeq + i, samples[i]);
+    }
+    streamSeq_ = firstSeq + count;
+  }
+}
+
+void TelemetryExporter::handleCommand(const char* line) {
+  if (strcmp(line, "history") == 0 || strcmp(line, "history text") == 0) {
+    dump(Format::Text);
+  } else if (strcmp(line, "history bin") == 0) {
+    dump(Format::Binary);
+  } else if (strcmp(line, "stream text") == 0 || strcmp(line, "stream bin") == 0) {
+    stream_ = (line[7] == 'b') ? Format::Binary : Format::Text;
+    // Only samples recorded from now on.
+    streamSeq_ = history_->nextSequence();
+  } else if (strcmp(line, "stream off") == 0) {
+    stream_ = Format::Off;
+  } else {
+    Serial.printf("[telemetry] unknown command '%s' (history [text|bin], stream text|bin|off)\n", line);
+  }
+}
+
+void TelemetryExporter::dump(Format format) {
+  // Size first: a sample recorded in between only moves `first` later, still
+  // inside the held range.
+  const uint16_t count = history_->size();
+  const uint32_t next = history_->nextSequence();
+  const uint32_t first = next - count;
+
+  if (format == Format::Binary) {
+    uint8_t frame[kTelemetryFrameMaxBytes];
+    FrameWriter w(frame, sizeof(frame), kTelemetryFrameDumpBegin);
+    w.put32(first);
+    w.put16(count);
+    w.put32(history_->intervalMs());
+    writeFrame(frame, w.finish());
+  } else {
+    Serial.printf("[telemetry] history first=%lu count=%u interval=%lums\n", static_cast<unsigned long>(first),
+                  static_cast<unsigned>(count), static_cast<unsigned long>(history_->intervalMs()));
+  }
+
+  // Samples recorded while dumping are left for the next dump or the stream.
+  TelemetrySample samples[kCopyChunk];
+  uint32_t seq = first;
+  while (seq < next) {
+    uint32_t firstSeq = 0;
+    size_t got = history_->copySince(seq, samples, kCopyChunk, firstSeq);
+    if (got == 0) {
+      break;
+    }
+    if (firstSeq + got > next) {
+      got = next - firstSeq;
+    }
+    for (size_t i = 0; i < got; ++i) {
+      emit(format, firstSeq + i, samples[i]);
+    }
+    seq = firstSeq + got;
+  }
+
+  if (format == Format::Binary) {
+    uint8_t frame[kTelemetryFrameMaxBytes];
+    FrameWriter w(frame, sizeof(frame), kTelemetryFrameDumpEnd);
+    w.put32(seq);
+    writeFrame(frame, w.finish());
+  } else {
+    Serial.printf("[telemetry] history end next=%lu\n", static_cast<unsigned long>(seq));
+  }
+}
+
+void TelemetryExporter::emit(Format format, uint32_t seq, const TelemetrySample& sample) {
+  if (format == Format::Binary) {
+    uint8_t frame[kTelemetryFrameMaxBytes];
+    writeFrame(frame, encodeSampleFrame(seq, sample, frame, sizeof(frame)));
+    return;
+  }
+  Serial.printf("sample seq=%lu uptime=%lums hashrate=%.2fH/s accepted=%lu rejected=%lu heap=%lu rssi=%d "
+                "job_age=%lums\n",
+                static_cast<unsigned long>(seq), static_cast<unsigned long>(sample.uptimeMs), sample.hashrate,
+                static_cast<unsigned long>(sample.accepted), static_cast<unsigned long>(sample.rejected),
+                static_cast<unsigned long>(sample.freeHeap), static_cast<int>(sample.rssi),
+                static_cast<unsigned long>(sample.jobAgeMs));
+}
+
+}  // namespace idk
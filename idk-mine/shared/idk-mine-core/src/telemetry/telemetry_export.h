@@ -0,0 +1,60 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "telemetry/telemetry_history.h"
+
+namespace idk {
+
+// Binary frames, integers little-endian:
+//   0xA5 0x5A   sync
+//   u8          type
+//   u8          payload length
+//   payload
+//   u16         CRC-16/CCITT-FALSE over type, length and payload
+// Types:
+//   1 sample      u32 seq, u32 uptime_ms, f32 hashrate, u32 accepted, u32 rejected,
+//                 u32 free_heap, i8 rssi, u32 job_age_ms
+//   2 dump begin  u32 first seq, u16 count, u32 interval_ms
+//   3 dump end    u32 next seq
+// Frames share the port with the text logs; a decoder scans for the sync
+// bytes and drops anything whose CRC fails (scripts/telemetry_decode.py).
+constexpr uint8_t kTelemetryFrameSample = 1;
+constexpr uint8_t kTelemetryFrameDumpBegin = 2;
+constexpr uint8_t kTelemetryFrameDumpEnd = 3;
+constexpr size_t kTelemetryFrameMaxBytes = 64;
+
+size_t encodeSampleFrame(uint32_t seq, const TelemetrySample& sample, uint8_t* out, size_t outSize);
+
+// Serves TelemetryHistory over Serial. Commands, one per line:
+//   history [text|bin]    dump the ring once
+//   stream text|bin|off   send each new sample as it is recorded
+// The regular telemetry line keeps printing either way.
+class TelemetryExporter {
+ public:
+  void begin(const TelemetryHistory* history);
+  // UI task: reads pending command input and sends any new streamed samples.
+  void poll();
+
+ private:
+  enum class Format : uint8_t {
+    Off,
+    Text,
+    Binary,
+  };
+
+  void handleCommand(const char* line);
+  void dump(Format format);
+  void emit(Format format, uint32_t seq, const TelemetrySample& sample);
+
+  static constexpr size_t kMaxCommandBytes = 32;
+
+  const TelemetryHistory* history_ = nullptr;
+  Format stream_ = Format::Off;
+  uint32_t streamSeq_ = 0;
+  char command_[kMaxCommandBytes];
+  size_t commandLen_ = 0;
+  bool discardingCommand_ = false;
+};
+
+}  // namespace idk
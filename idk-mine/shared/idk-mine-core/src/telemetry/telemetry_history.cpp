@@ -0,0 +1,56 @@
+#include "telemetry_history.h"
+
+namespace idk {
+
+void TelemetryHistory::begin(uint32_t intervalMs) {
+  if (mutex_ == nullptr) {
+    mutex_ = xSemaphoreCreateMutex();
+  }
+  intervalMs_ = (intervalMs == 0) ? 5000 : intervalMs;
+}
+
+bool TelemetryHistory::offer(const TelemetrySample& sample) {
+  xSemaphoreTake(mutex_, portMAX_DELAY);
+  const bool keep = (next_ == 0) || (sample.uptimeMs - lastKeptMs_ >= intervalMs_);
+  if (keep) {
+    samples_[next_ % kCapacity] = sample;
+    ++next_;
+    lastKeptMs_ = sample.uptimeMs;
+  }
+  xSemaphoreGive(mutex_);
+  return keep;
+}
+
+uint32_t TelemetryHistory::nextSequence() const {
+  xSemaphoreTake(mutex_, portMAX_DELAY);
+  const uint32_t next = next_;
+  xSemaphoreGive(mutex_);
+  return next;
+}
+
+uint16_t TelemetryHistory::size() const {
+  const uint32_t next = nextSequence();
+  return static_cast<uint16_t>((next < kCapacity) ? next : kCapacity);
+}
+
+uint32_t TelemetryHistory::intervalMs() const {
+  return intervalMs_;
+}
+
+size_t TelemetryHistory::copySince(uint32_t fromSeq, TelemetrySample* out, size_t maxCount,
+                                   uint32_t& firstSeq) const {
+  xSemaphoreTake(mutex_, portMAX_DELAY);
+  const uint32_t oldest = (next_ > kCapacity) ? next_ - kCapacity : 0;
+  if (fromSeq < oldest) {
+    fromSeq = oldest;
+  }
+  size_t count = 0;
+  for (uint32_t seq = fromSeq; seq < next_ && count < maxCount; ++seq) {
+    out[count++] = samples_[seq % kCapacity];
+  }
+  xSemaphoreGive(mutex_);
+  firstSeq = fromSeq;
+  return count;
+}
+
+}  // namespace idk
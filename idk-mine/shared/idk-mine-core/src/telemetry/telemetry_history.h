@@ -0,0 +1,57 @@
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+namespace idk {
+
+// One point of the on-device time series.
+struct TelemetrySample {
+  uint32_t uptimeMs;
+  // 10 s average.
+  float hashrate;
+  uint32_t accepted;
+  uint32_t rejected;
+  uint32_t freeHeap;
+  // dBm; 0 while Wi-Fi is down.
+  int8_t rssi;
+  // Time since the miner last got new work; 0 before the first job.
+  uint32_t jobAgeMs;
+};
+
+// Fixed ring of the most recent samples, one per history interval
+// (timing.history_ms, never finer than telemetry_ms since samples are taken
+// at telemetry time). Every sample gets a sequence number so a reader can ask
+// for what it has not seen yet. The network task records, the serial
+// exporter copies out from the UI task; a mutex covers the short copies.
+class TelemetryHistory {
+ public:
+  // 20 minutes at the default 5 s resolution.
+  static constexpr uint16_t kCapacity = 240;
+
+  void begin(uint32_t intervalMs);
+
+  // Keeps `sample` if a whole interval has passed since the last kept one.
+  bool offer(const TelemetrySample& sample);
+
+  // Sequence number the next sample will get; samples [next - size, next)
+  // are held.
+  uint32_t nextSequence() const;
+  uint16_t size() const;
+  uint32_t intervalMs() const;
+
+  // Copies up to `maxCount` held samples starting at sequence `fromSeq`
+  // (moved up to the oldest held one), oldest first. `firstSeq` is the
+  // sequence of out[0].
+  size_t copySince(uint32_t fromSeq, TelemetrySample* out, size_t maxCount, uint32_t& firstSeq) const;
+
+ private:
+  SemaphoreHandle_t mutex_ = nullptr;
+  TelemetrySample samples_[kCapacity]{};
+  uint32_t next_ = 0;
+  uint32_t intervalMs_ = 5000;
+  uint32_t lastKeptMs_ = 0;
+};
+
+}  // namespace idk
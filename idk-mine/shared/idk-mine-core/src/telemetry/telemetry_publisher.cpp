@@ -0,0 +1,26 @@
+#include "telemetry_publisher.h"
+
+#include <string.h>
+
+namespace idk {
+
+void TelemetryPublisher::publish(const TelemetryState& state) {
+  const uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+  // The idle slot may still be mid-copy by a reader that loaded the previous
+  // sequence; order the last bump before these writes so that reader sees it
+  // moved and retries.
+  std::atomic_thread_fence(std::memory_order_release);
+  memcpy(&slots_[(sequence + 1) & 1u], &state, sizeof(state));
+  sequence_.store(sequence + 1, std::memory_order_release);
+}
+
+void TelemetryPublisher::read(TelemetryState& out) const {
+  uint32_t sequence = 0;
+  do {
+    sequence = sequence_.load(std::memory_order_acquire);
+    memcpy(&out, &slots_[sequence & 1u], sizeof(out));
+    std::atomic_thread_fence(std::memory_order_acquire);
+  } while (sequence_.load(std::memory_order_relaxed) != sequence);
+}
+
+}  // namespace idk
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <atomic>
+
+#include "telemetry/telemetry_state.h"
+
+namespace idk {
+
+// Hands TelemetryState from its single writer (the network task) to any
+// number of readers without a lock. Two slots, published seqlock-style: the
+// writer fills the slot readers are not pointed at and bumps the sequence; a
+// reader copies the current slot and retries if the sequence moved during the
+// copy. The writer never waits, and every publish replaces the whole state,
+// so nothing is dropped the way a timed-out mutex take used to drop it.
+class TelemetryPublisher {
+ public:
+  // Single writer only.
+  void publish(const TelemetryState& state);
+  // Any task; never blocks.
+  void read(TelemetryState& out) const;
+
+ private:
+  TelemetryState slots_[2]{};
+  std::atomic<uint32_t> sequence_{0};
+};
+
+}  // namespace idk
@@ -2,24 +2,97 @@
 
 #include <Arduino.h>
 
+#include "network/stratum_client.h"
+#include "telemetry/system_profiler.h"
+
 namespace idk {
 
+struct TaskTelemetry {
+  char name[16];
+  float cpuPercent;
+  uint32_t stackFreeBytes;
+  uint32_t stackBytes;
+};
+
 struct TelemetryState {
   uint64_t totalHash = 0;
   float bestDiff = 0.0f;
   char poolJob[48] = "-";
   char poolTarget[24] = "-";
   uint32_t target32 = 0;
+  float poolDifficulty = 0.0f;
   uint32_t blockFound = 0;
+  float nonceCoverage = 0.0f;
+  uint32_t nonceRollovers = 0;
   float currentHashrate = 0.0f;
+  float hashrate10s = 0.0f;
+  float hashrate60s = 0.0f;
+  float hashrate15m = 0.0f;
+  uint8_t workerCount = 0;
+  float workerHashrate[2] = {0.0f, 0.0f};
+  uint64_t workerTotalHash[2] = {0, 0};
+  uint32_t jobSwitchUs = 0;
+  uint32_t jobSwitchMaxUs = 0;
+  uint16_t batchSize = 0;
+  uint8_t yieldEvery = 0;
+  bool tuningSettled = false;
 
   bool wifiConnected = false;
   bool poolConnected = false;
   char coin[4] = "BTC";
 
   uint32_t reconnectCount = 0;
+  uint8_t poolEndpoint = 0;
+  uint8_t poolEndpointCount = 0;
+  uint32_t poolLatencyMs = 0;
+  uint32_t poolFailovers = 0;
+  uint32_t tlsHandshakeMs = 0;
+  uint32_t tlsFullHandshakes = 0;
+  uint32_t tlsResumedHandshakes = 0;
+  uint32_t tlsPinFailures = 0;
+  uint32_t connectToJobMs = 0;
   uint32_t acceptedShares = 0;
   uint32_t rejectedShares = 0;
+  uint32_t submittedShares = 0;
+  uint32_t staleShares = 0;
+  uint32_t timedOutShares = 0;
+  uint32_t unmatchedResponses = 0;
+  uint8_t pendingRequests = 0;
+  uint32_t shareLatencyAvgMs = 0;
+  uint32_t shareLatencyMaxMs = 0;
+  uint32_t shareLatencyHist[kShareLatencyBuckets] = {};
+  float expectedSharesPerMin = 0.0f;
+  float observedSharesPerMin = 0.0f;
+  uint32_t droppedShares = 0;
+  uint8_t shareQueueHighWater = 0;
+  float rxBytesPerSec = 0.0f;
+  uint32_t lineParseUs = 0;
+  uint32_t lineParseMaxUs = 0;
+  uint32_t rxOverflows = 0;
+  // Network task passes per second, and how long found shares waited in the
+  // queue before being submitted (average over the interval, worst since boot).
+  float netWakeupsPerSec = 0.0f;
+  uint32_t shareQueueUs = 0;
+  uint32_t shareQueueMaxUs = 0;
+  uint32_t freeHeap = 0;
+  int8_t rssi = 0;
+  // Time since the miner last got new work; 0 before the first job.
+  uint32_t jobAgeMs = 0;
+
+  TaskTelemetry tasks[kProfiledTasks] = {};
+  uint8_t taskCount = 0;
+  uint32_t minFreeHeap = 0;
+  uint32_t largestFreeBlock = 0;
+  bool resourceAlert = false;
+  char resourceAlertText[40] = "";
+  // Time the UI backend spent on its last frame and the worst so far.
+  uint32_t uiDrawUs = 0;
+  uint32_t uiDrawMaxUs = 0;
+  // Boot cost: mounting LittleFS and assembling RuntimeConfig (cached blob or
+  // JSON), and the time from reset until the first hash batch finished.
+  uint32_t configLoadUs = 0;
+  bool configCached = false;
+  uint32_t bootToHashMs = 0;
 
   char status[64] = "boot";
 };
@@ -5,6 +5,8 @@
 #include <SPI.h>
 #include <TFT_eSPI.h>
 
+#include <algorithm>
+
 namespace idk {
 namespace {
 
@@ -15,6 +17,21 @@ constexpr uint16_t kFg = TFT_WHITE;
 constexpr uint16_t kAccent = TFT_GREENYELLOW;
 constexpr uint16_t kWarn = TFT_ORANGE;
 
+// Field rows below the header; 11 rows fill the 240 px panel. Values start
+// at kValueX and are redrawn as one band-height rectangle.
+constexpr int kRowTop = 32;
+constexpr int kRowPitch = 18;
+constexpr int kBandHeight = kRowPitch - 2;
+constexpr int kValueX = 132;
+
+// Hashrate sparkline in the right of the header.
+constexpr int kSparkWidth = 96;
+constexpr int kSparkHeight = 24;
+constexpr int kSparkY = 2;
+
+// Font 1 at text size 1.
+constexpr int kCharWidth = 6;
+
 void safeCopy(char* dst, size_t dstSize, const char* src) {
   if (dst == nullptr || dstSize == 0) {
     return;
@@ -26,11 +43,22 @@ void safeCopy(char* dst, size_t dstSize, const char* src) {
   strlcpy(dst, src, dstSize);
 }
 
+// Header text shares its rows with the sparkline, so it is cut short of it.
+void printHeaderLine(int y, const char* text) {
+  const size_t maxChars = static_cast<size_t>(gTft.width() - kSparkWidth - 8 - 4) / kCharWidth;
+  char line[64];
+  safeCopy(line, std::min(sizeof(line), maxChars + 1), text);
+  gTft.setCursor(4, y);
+  gTft.print(line);
+}
+
 }  // namespace
 
 void CydDisplayUI::begin(const RuntimeConfig& config) {
   intervalMs_ = (intervalMs_ == 0) ? config.uiUpdateMs : intervalMs_;
   memset(cachedValues_, 0, sizeof(cachedValues_));
+  memset(cachedColors_, 0, sizeof(cachedColors_));
+  labelsDrawn_ = 0;
 
   gTft.init();
   gTft.setRotation(1);
@@ -46,6 +74,37 @@ void CydDisplayUI::begin(const RuntimeConfig& config) {
   gTft.setTextFont(1);
   gTft.setTextSize(1);
 
+  // Needs both bands: one is composed while the other may still be in flight.
+  dma_ = gTft.initDMA();
+  if (bands_[0] == nullptr) {
+    for (uint8_t i = 0; i < 2; ++i) {
+      bands_[i] = new TFT_eSprite(&gTft);
+      bands_[i]->setColorDepth(16);
+      if (bands_[i]->createSprite(gTft.width() - kValueX, kBandHeight) == nullptr) {
+        for (uint8_t j = 0; j <= i; ++j) {
+          delete bands_[j];
+          bands_[j] = nullptr;
+        }
+        break;
+      }
+      bands_[i]->setTextFont(1);
+      bands_[i]->setTextSize(1);
+    }
+  }
+  if (spark_ == nullptr) {
+    spark_ = new TFT_eSprite(&gTft);
+    spark_->setColorDepth(16);
+    if (spark_->createSprite(kSparkWidth, kSparkHeight) == nullptr) {
+      delete spark_;
+      spark_ = nullptr;
+    } else {
+      spark_->setTextFont(1);
+      spark_->setTextSize(1);
+    }
+  }
+  Serial.printf("[ui] band sprites %s, sparkline %s, dma %s\n", (bands_[0] != nullptr) ? "on" : "off (low heap)",
+                (spark_ != nullptr) ? "on" : "off (low heap)", dma_ ? "on" : "off");
+
   drawLayout(config);
 }
 
@@ -55,6 +114,10 @@ void CydDisplayUI::update(const TelemetryState& state) {
     return;
   }
   lastDrawMs_ = now;
+  const uint32_t startUs = micros();
+  if (dma_) {
+    gTft.startWrite();
+  }
 
   char value[64];
 
@@ -77,30 +140,81 @@ void CydDisplayUI::update(const TelemetryState& state) {
   snprintf(value, sizeof(value), "%lu", static_cast<unsigned long>(state.blockFound));
   drawField(6, "block found", value);
 
-  snprintf(value, sizeof(value), "%.2f H/s", state.currentHashrate);
+  if (state.workerCount > 1) {
+    snprintf(value, sizeof(value), "%.0f H/s w0:%.0f w1:%.0f", state.currentHashrate, state.workerHashrate[0],
+             state.workerHashrate[1]);
+  } else {
+    snprintf(value, sizeof(value), "%.2f H/s", state.currentHashrate);
+  }
   drawField(7, "current hashrate", value);
 
   snprintf(value, sizeof(value), "A:%lu R:%lu %s", static_cast<unsigned long>(state.acceptedShares),
            static_cast<unsigned long>(state.rejectedShares), state.status);
   drawField(8, "pool", value, kWarn);
+
+  // Task order is idk-net, idk-ui, mine-w0, mine-w1.
+  size_t pos = 0;
+  value[0] = '\0';
+  uint32_t minStack = 0xFFFFFFFFu;
+  for (uint8_t i = 0; i < state.taskCount && pos < sizeof(value); ++i) {
+    pos += snprintf(value + pos, sizeof(value) - pos, (i == 0) ? "%.0f" : " %.0f", state.tasks[i].cpuPercent);
+    if (state.tasks[i].stackFreeBytes < minStack) {
+      minStack = state.tasks[i].stackFreeBytes;
+    }
+  }
+  drawField(9, "cpu% net ui w0 w1", value);
+  if (state.taskCount == 0) {
+    minStack = 0;
+  }
+
+  if (state.resourceAlert) {
+    snprintf(value, sizeof(value), "LOW %s", state.resourceAlertText);
+  } else {
+    snprintf(value, sizeof(value), "stk %lu heap %luk/%luk", static_cast<unsigned long>(minStack),
+             static_cast<unsigned long>(state.minFreeHeap / 1024),
+             static_cast<unsigned long>(state.largestFreeBlock / 1024));
+  }
+  drawField(10, "headroom", value, state.resourceAlert ? kWarn : kFg);
+
+  recordHashrate(now, state.hashrate10s);
+  if (sparkDirty_) {
+    drawSparkline();
+  }
+
+  if (dma_) {
+    gTft.dmaWait();
+    gTft.endWrite();
+  }
+  lastDrawUs_ = micros() - startUs;
+  if (lastDrawUs_ > maxDrawUs_) {
+    maxDrawUs_ = lastDrawUs_;
+  }
+}
+
+uint32_t CydDisplayUI::lastDrawUs() const {
+  return lastDrawUs_;
+}
+
+uint32_t CydDisplayUI::maxDrawUs() const {
+  return maxDrawUs_;
 }
 
 void CydDisplayUI::drawLayout(const RuntimeConfig& config) {
   gTft.fillScreen(kBg);
 
   gTft.setTextColor(kAccent, kBg);
-  gTft.setCursor(4, 4);
-  gTft.printf("%s", config.projectName);
+  printHeaderLine(4, config.projectName);
 
   gTft.setTextColor(kFg, kBg);
-  gTft.setCursor(4, 16);
-  gTft.printf("miner: %s  worker: %s", config.minerName, config.workerName);
+  char line[96];
+  snprintf(line, sizeof(line), "miner: %s  worker: %s", config.minerName, config.workerName);
+  printHeaderLine(16, line);
 
   gTft.drawFastHLine(0, 28, gTft.width(), TFT_DARKGREY);
 
   for (uint8_t i = 0; i < kFieldCount; ++i) {
-    const int y = 32 + (i * 22);
-    gTft.drawFastHLine(0, y + 20, gTft.width(), TFT_DARKGREY);
+    const int y = kRowTop + (i * kRowPitch);
+    gTft.drawFastHLine(0, y + kRowPitch - 2, gTft.width(), TFT_DARKGREY);
   }
 }
 
@@ -110,22 +224,112 @@ void CydDisplayUI::drawField(uint8_t row, const char* label, const char* value,
   }
 
   const char* safeValue = (value == nullptr) ? "-" : value;
-  if (strncmp(cachedValues_[row], safeValue, kValueMax) == 0) {
+  if (strncmp(cachedValues_[row], safeValue, kValueMax) == 0 && cachedColors_[row] == color) {
     return;
   }
 
   safeCopy(cachedValues_[row], sizeof(cachedValues_[row]), safeValue);
+  cachedColors_[row] = color;
+
+  const int y = kRowTop + (row * kRowPitch);
+  // Labels never change; they go straight to the panel once. Direct draws
+  // share the bus with the previous band's push, and only endWrite() waits
+  // for DMA on its own.
+  if ((labelsDrawn_ & (1u << row)) == 0) {
+    if (dma_) {
+      gTft.dmaWait();
+    }
+    gTft.setTextColor(TFT_CYAN, kBg);
+    gTft.setCursor(4, y + 4);
+    gTft.printf("%s", label);
+    labelsDrawn_ |= static_cast<uint16_t>(1u << row);
+  }
 
-  const int y = 32 + (row * 22);
-  gTft.fillRect(0, y, gTft.width(), 20, kBg);
+  TFT_eSprite* band = bands_[nextBand_];
+  if (band == nullptr) {
+    if (dma_) {
+      gTft.dmaWait();
+    }
+    gTft.fillRect(kValueX, y, gTft.width() - kValueX, kBandHeight, kBg);
+    gTft.setTextColor(color, kBg);
+    gTft.setCursor(kValueX, y + 4);
+    gTft.printf("%s", safeValue);
+    return;
+  }
+  // pushImageDMA waits for the transfer before it, so by the time a band comes
+  // round again its last push has finished.
+  nextBand_ ^= 1;
+
+  band->fillSprite(kBg);
+  band->setTextColor(color, kBg);
+  band->setCursor(0, 4);
+  band->print(safeValue);
+  if (dma_) {
+    gTft.pushImageDMA(kValueX, y, band->width(), kBandHeight, static_cast<uint16_t*>(band->getPointer()));
+  } else {
+    band->pushSprite(kValueX, y);
+  }
+}
 
-  gTft.setTextColor(TFT_CYAN, kBg);
-  gTft.setCursor(4, y + 2);
-  gTft.printf("%s", label);
+void CydDisplayUI::recordHashrate(uint32_t nowMs, float hashrate) {
+  if (lastSparkMs_ != 0 && nowMs - lastSparkMs_ < kSparkIntervalMs) {
+    return;
+  }
+  lastSparkMs_ = nowMs;
+  sparkValues_[sparkHead_] = hashrate;
+  sparkHead_ = static_cast<uint8_t>((sparkHead_ + 1) % kSparkPoints);
+  if (sparkCount_ < kSparkPoints) {
+    ++sparkCount_;
+  }
+  sparkDirty_ = true;
+}
+
+void CydDisplayUI::drawSparkline() {
+  sparkDirty_ = false;
+  if (spark_ == nullptr) {
+    return;
+  }
+
+  spark_->fillSprite(kBg);
+  spark_->drawRect(0, 0, kSparkWidth, kSparkHeight, TFT_DARKGREY);
 
-  gTft.setTextColor(color, kBg);
-  gTft.setCursor(132, y + 2);
-  gTft.printf("%s", safeValue);
+  float peak = 0.0f;
+  for (uint8_t i = 0; i < sparkCount_; ++i) {
+    if (sparkValues_[i] > peak) {
+      peak = sparkValues_[i];
+    }
+  }
+
+  // Oldest point at the left edge, scaled to the window's peak.
+  if (sparkCount_ >= 2 && peak > 0.0f) {
+    const uint8_t oldest = static_cast<uint8_t>((sparkHead_ + kSparkPoints - sparkCount_) % kSparkPoints);
+    int prevX = 0;
+    int prevY = 0;
+    for (uint8_t i = 0; i < sparkCount_; ++i) {
+      const float v = sparkValues_[(oldest + i) % kSparkPoints];
+      const int x = 1 + (i * (kSparkWidth - 3)) / (kSparkPoints - 1);
+      const int y = kSparkHeight - 2 - static_cast<int>(v / peak * static_cast<float>(kSparkHeight - 4));
+      if (i > 0) {
+        spark_->drawLine(prevX, prevY, x, y, kAccent);
+      }
+      prevX = x;
+      prevY = y;
+    }
+  }
+
+  // Last frame's draw time over the graph (foreground only: transparent).
+  char text[16];
+  snprintf(text, sizeof(text), "%.1fms", static_cast<float>(lastDrawUs_) / 1000.0f);
+  spark_->setTextColor(kFg);
+  spark_->setCursor(3, 3);
+  spark_->print(text);
+
+  const int x = gTft.width() - kSparkWidth - 4;
+  if (dma_) {
+    gTft.pushImageDMA(x, kSparkY, kSparkWidth, kSparkHeight, static_cast<uint16_t*>(spark_->getPointer()));
+  } else {
+    spark_->pushSprite(x, kSparkY);
+  }
 }
 
 }  // namespace idk
@@ -2,25 +2,58 @@
 
 #include "ui_backend.h"
 
+class TFT_eSprite;
+
 namespace idk {
 
+// Dense ILI9341 dashboard. Each changed field value is composed off screen in
+// a band sprite and pushed as one rectangle (over DMA when the SPI driver
+// allows it), so nothing is cleared on the panel and the UI task is not held
+// on SPI while it composes the next band. Two band sprites alternate so one
+// can be filled while the other is still going out. A sparkline of the
+// hashrate sits in the header. When the heap cannot spare the sprites
+// (scrypt scratchpads take most of it) fields are drawn straight to the
+// panel as before.
 class CydDisplayUI : public UIBackend {
  public:
   explicit CydDisplayUI(uint32_t intervalMs) : intervalMs_(intervalMs) {}
 
   void begin(const RuntimeConfig& config) override;
   void update(const TelemetryState& state) override;
+  uint32_t lastDrawUs() const override;
+  uint32_t maxDrawUs() const override;
 
  private:
   void drawLayout(const RuntimeConfig& config);
   void drawField(uint8_t row, const char* label, const char* value, uint16_t color = 0xFFFF);
+  void recordHashrate(uint32_t nowMs, float hashrate);
+  void drawSparkline();
 
-  static constexpr uint8_t kFieldCount = 9;
+  static constexpr uint8_t kFieldCount = 11;
   static constexpr uint8_t kValueMax = 48;
+  static constexpr uint8_t kSparkPoints = 48;
+  static constexpr uint32_t kSparkIntervalMs = 2000;
 
   uint32_t intervalMs_ = 200;
   uint32_t lastDrawMs_ = 0;
   char cachedValues_[kFieldCount][kValueMax]{};
+  uint16_t cachedColors_[kFieldCount]{};
+  uint16_t labelsDrawn_ = 0;
+
+  TFT_eSprite* bands_[2] = {nullptr, nullptr};
+  uint8_t nextBand_ = 0;
+  TFT_eSprite* spark_ = nullptr;
+  bool dma_ = false;
+
+  // Ring of hashrate points, one per kSparkIntervalMs.
+  float sparkValues_[kSparkPoints]{};
+  uint8_t sparkCount_ = 0;
+  uint8_t sparkHead_ = 0;
+  uint32_t lastSparkMs_ = 0;
+  bool sparkDirty_ = false;
+
+  uint32_t lastDrawUs_ = 0;
+  uint32_t maxDrawUs_ = 0;
 };
 
 }  // namespace idk
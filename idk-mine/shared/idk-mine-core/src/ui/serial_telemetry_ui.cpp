@@ -18,14 +18,68 @@ void SerialTelemetryUI::update(const TelemetryState& state) {
   }
   lastPrintMs_ = now;
 
+  char latencyHist[96];
+  size_t pos = 0;
+  latencyHist[0] = '\0';
+  for (uint8_t i = 0; i < kShareLatencyBuckets && pos < sizeof(latencyHist); ++i) {
+    pos += snprintf(latencyHist + pos, sizeof(latencyHist) - pos, (i == 0) ? "%lu" : "/%lu",
+                    static_cast<unsigned long>(state.shareLatencyHist[i]));
+  }
+
+  // name:cpu%/free stack of stack, per profiled task.
+  char tasks[160];
+  pos = 0;
+  tasks[0] = '\0';
+  for (uint8_t i = 0; i < state.taskCount && pos < sizeof(tasks); ++i) {
+    const TaskTelemetry& task = state.tasks[i];
+    pos += snprintf(tasks + pos, sizeof(tasks) - pos, (i == 0) ? "%s:%.1f%%/%lu/%lu" : ",%s:%.1f%%/%lu/%lu",
+                    task.name, task.cpuPercent, static_cast<unsigned long>(task.stackFreeBytes),
+                    static_cast<unsigned long>(task.stackBytes));
+  }
+
   Serial.printf(
-      "coin=%s wifi=%d pool=%d hash_total=%llu best_diff=%.6f pool_job=%s pool_target=%s target32=%lu "
-      "blocks=%lu hashrate=%.2fH/s accepted=%lu rejected=%lu status=%s\n",
+      "coin=%s wifi=%d pool=%d pool_ep=%u/%u pool_rtt=%lums failovers=%lu tls_hs=%lums "
+      "tls_full=%lu tls_resumed=%lu tls_pin_fail=%lu connect_to_job=%lums hash_total=%llu best_diff=%.6f "
+      "pool_job=%s pool_target=%s target32=%lu pool_diff=%.6g "
+      "blocks=%lu coverage=%.6f%% rollovers=%lu hashrate=%.2fH/s avg10s=%.2fH/s avg60s=%.2fH/s "
+      "avg15m=%.2fH/s w0=%.2fH/s/%llu w1=%.2fH/s/%llu batch=%u yield_every=%u tuned=%d "
+      "job_switch=%luus job_switch_max=%luus accepted=%lu "
+      "rejected=%lu submitted=%lu stale=%lu timed_out=%lu unmatched=%lu pending=%u share_lat=%lums "
+      "share_lat_max=%lums share_lat_hist=%s shares_exp=%.4f/min shares_obs=%.4f/min dropped=%lu queue_hw=%u "
+      "rx=%.0fB/s line_parse=%luus line_parse_max=%luus rx_overflows=%lu net_wakeups=%.1f/s share_queue=%luus "
+      "share_queue_max=%luus heap=%lu rssi=%d job_age=%lums tasks=%s heap_min=%lu heap_block=%lu alert=%s "
+      "ui_draw=%luus ui_draw_max=%luus config_load=%luus/%s boot_to_hash=%lums status=%s\n",
       state.coin, static_cast<int>(state.wifiConnected), static_cast<int>(state.poolConnected),
+      static_cast<unsigned>(state.poolEndpoint), static_cast<unsigned>(state.poolEndpointCount),
+      static_cast<unsigned long>(state.poolLatencyMs), static_cast<unsigned long>(state.poolFailovers),
+      static_cast<unsigned long>(state.tlsHandshakeMs), static_cast<unsigned long>(state.tlsFullHandshakes),
+      static_cast<unsigned long>(state.tlsResumedHandshakes), static_cast<unsigned long>(state.tlsPinFailures),
+      static_cast<unsigned long>(state.connectToJobMs),
       static_cast<unsigned long long>(state.totalHash), state.bestDiff, state.poolJob, state.poolTarget,
-      static_cast<unsigned long>(state.target32), static_cast<unsigned long>(state.blockFound),
-      state.currentHashrate, static_cast<unsigned long>(state.acceptedShares),
-      static_cast<unsigned long>(state.rejectedShares), state.status);
+      static_cast<unsigned long>(state.target32), state.poolDifficulty, static_cast<unsigned long>(state.blockFound),
+      state.nonceCoverage * 100.0f, static_cast<unsigned long>(state.nonceRollovers),
+      state.currentHashrate, state.hashrate10s, state.hashrate60s, state.hashrate15m,
+      state.workerHashrate[0], static_cast<unsigned long long>(state.workerTotalHash[0]),
+      state.workerHashrate[1], static_cast<unsigned long long>(state.workerTotalHash[1]),
+      static_cast<unsigned>(state.batchSize), static_cast<unsigned>(state.yieldEvery),
+      static_cast<int>(state.tuningSettled), static_cast<unsigned long>(state.jobSwitchUs),
+      static_cast<unsigned long>(state.jobSwitchMaxUs),
+      static_cast<unsigned long>(state.acceptedShares),
+      static_cast<unsigned long>(state.rejectedShares), static_cast<unsigned long>(state.submittedShares),
+      static_cast<unsigned long>(state.staleShares), static_cast<unsigned long>(state.timedOutShares),
+      static_cast<unsigned long>(state.unmatchedResponses), static_cast<unsigned>(state.pendingRequests),
+      static_cast<unsigned long>(state.shareLatencyAvgMs), static_cast<unsigned long>(state.shareLatencyMaxMs),
+      latencyHist, state.expectedSharesPerMin, state.observedSharesPerMin,
+      static_cast<unsigned long>(state.droppedShares),
+      static_cast<unsigned>(state.shareQueueHighWater), state.rxBytesPerSec,
+      static_cast<unsigned long>(state.lineParseUs), static_cast<unsigned long>(state.lineParseMaxUs),
+      static_cast<unsigned long>(state.rxOverflows), state.netWakeupsPerSec,
+      static_cast<unsigned long>(state.shareQueueUs), static_cast<unsigned long>(state.shareQueueMaxUs),
+      static_cast<unsigned long>(state.freeHeap), static_cast<int>(state.rssi), static_cast<unsigned long>(state.jobAgeMs),
+      tasks, static_cast<unsigned long>(state.minFreeHeap), static_cast<unsigned long>(state.largestFreeBlock),
+      state.resourceAlert ? state.resourceAlertText : "-", static_cast<unsigned long>(state.uiDrawUs),
+      static_cast<unsigned long>(state.uiDrawMaxUs), static_cast<unsigned long>(state.configLoadUs),
+      state.configCached ? "blob" : "json", static_cast<unsigned long>(state.bootToHashMs), state.status);
 }
 
 }  // namespace idk
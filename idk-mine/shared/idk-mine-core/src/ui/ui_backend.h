@@ -10,6 +10,14 @@ class UIBackend {
   virtual ~UIBackend() = default;
   virtual void begin(const RuntimeConfig& config) = 0;
   virtual void update(const TelemetryState& state) = 0;
+  // Time the last update() spent drawing, and the worst since begin(); 0 for
+  // backends that do not measure it.
+  virtual uint32_t lastDrawUs() const {
+    return 0;
+  }
+  virtual uint32_t maxDrawUs() const {
+    return 0;
+  }
 };
 
 }  // namespace idk
@@ -16,7 +16,9 @@ struct BTCData {
 
 class ApiClient {
  public:
-  ApiClient(uint32_t timeoutMs, bool insecureTls, size_t responseBufferSize);
+  // Each client reads responses into its own buffer, so clients on
+  // different tasks can fetch at the same time.
+  ApiClient(uint32_t timeoutMs, bool insecureTls, char* responseBuffer, size_t responseBufferSize);
 
   bool fetchLTC(const char* address, LTCData& out, char* errMsg, size_t errMsgSize);
   bool fetchBTC(const char* address, BTCData& out, char* errMsg, size_t errMsgSize);
@@ -24,6 +26,7 @@ class ApiClient {
  private:
   uint32_t timeoutMs_;
   bool insecureTls_;
+  char* responseBuffer_;
   size_t responseBufferSize_;
 
   bool httpGet(const char* url, char* outBuf, size_t outBufSize, int& httpCode, char* errMsg,
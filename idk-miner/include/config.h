@@ -34,6 +34,11 @@ static constexpr uint32_t kWifiReconnectIntervalMs = 5000;
 static constexpr uint32_t kUiRenderIntervalMs = 100;
 static constexpr uint32_t kHttpTimeoutMs = 6000;
 
+// Fetch tasks (one per coin). The stack covers an mbedTLS handshake, the
+// same budget as the Arduino loop task the fetches used to run on.
+static constexpr uint32_t kFetchTaskStackBytes = 8192;
+static constexpr UBaseType_t kFetchTaskPriority = 1;
+
 // Security
 static constexpr bool kAllowInsecureTls = true;
 
@@ -0,0 +1,54 @@
+#ifndef FETCH_TASK_H
+#define FETCH_TASK_H
+
+#include <Arduino.h>
+
+#include <atomic>
+
+#include "config.h"
+
+// Runs one blocking API fetch at a time on its own FreeRTOS task so the
+// render loop keeps drawing during network I/O.
+//
+// The job's result storage changes hands through state_ without a lock:
+// request() (loop) moves Idle -> Running and wakes the task, the task fills
+// the result and stores Done with release, and poll() (loop) sees Done with
+// acquire, reads the result and error(), then moves back to Idle. Only one
+// side touches the result in each state.
+class FetchTask {
+ public:
+  // Runs on the fetch task. Fills the owner's result storage and returns
+  // false with a message in errMsg on failure.
+  using Job = bool (*)(char* errMsg, size_t errMsgSize);
+
+  FetchTask(const char* name, Job job);
+
+  bool begin(uint32_t stackBytes, UBaseType_t priority);
+  // Loop only. Starts a fetch unless one is running or waiting for poll().
+  bool request();
+  // Loop only. True once per finished fetch; `ok` is the job's result. The
+  // result storage and error() stay valid until the next request().
+  bool poll(bool& ok);
+  // Running, or finished but not yet polled.
+  bool busy() const;
+  const char* error() const;
+
+ private:
+  enum State : uint8_t {
+    kIdle = 0,
+    kRunning = 1,
+    kDone = 2,
+  };
+
+  static void taskEntry(void* ctx);
+  void run();
+
+  const char* name_;
+  Job job_;
+  TaskHandle_t task_ = nullptr;
+  std::atomic<uint8_t> state_{kIdle};
+  bool ok_ = false;
+  char err_[Config::kStatusBufferSize] = "";
+};
+
+#endif  // FETCH_TASK_H
@@ -39,12 +39,13 @@ float variantToFloat(const JsonVariantConst& v, float fallback = 0.0f) {
   return fallback;
 }
 
-static char gResponseA[Config::kHttpBufferSize];
-
 }  // namespace
 
-ApiClient::ApiClient(uint32_t timeoutMs, bool insecureTls, size_t responseBufferSize)
-    : timeoutMs_(timeoutMs), insecureTls_(insecureTls), responseBufferSize_(responseBufferSize) {}
+ApiClient::ApiClient(uint32_t timeoutMs, bool insecureTls, char* responseBuffer, size_t responseBufferSize)
+    : timeoutMs_(timeoutMs),
+      insecureTls_(insecureTls),
+      responseBuffer_(responseBuffer),
+      responseBufferSize_(responseBufferSize) {}
 
 bool ApiClient::fetchLTC(const char* address, LTCData& out, char* errMsg, size_t errMsgSize) {
   char urlV5[220];
@@ -58,8 +59,8 @@ bool ApiClient::fetchLTC(const char* address, LTCData& out, char* errMsg, size_t
 
   for (size_t u = 0; u < 2; ++u) {
     for (int attempt = 0; attempt < 2; ++attempt) {
-      if (httpGet(urls[u], gResponseA, responseBufferSize_, httpCode, errMsg, errMsgSize)) {
-        if (parseLtcJson(gResponseA, out, errMsg, errMsgSize)) {
+      if (httpGet(urls[u], responseBuffer_, responseBufferSize_, httpCode, errMsg, errMsgSize)) {
+        if (parseLtcJson(responseBuffer_, out, errMsg, errMsgSize)) {
           return true;
         }
         snprintf(lastErr, sizeof(lastErr), "%s", errMsg);
@@ -79,10 +80,10 @@ bool ApiClient::fetchBTC(const char* address, BTCData& out, char* errMsg, size_t
   snprintf(clientUrl, sizeof(clientUrl), Config::kBtcClientApiUrlFmt, address);
 
   int clientCode = -1;
-  if (!httpGet(clientUrl, gResponseA, responseBufferSize_, clientCode, errMsg, errMsgSize)) {
+  if (!httpGet(clientUrl, responseBuffer_, responseBufferSize_, clientCode, errMsg, errMsgSize)) {
     return false;
   }
-  if (!parseBtcClientJson(gResponseA, out, errMsg, errMsgSize)) {
+  if (!parseBtcClientJson(responseBuffer_, out, errMsg, errMsgSize)) {
     return false;
   }
 
@@ -0,0 +1,55 @@
+#include "fetch_task.h"
+
+FetchTask::FetchTask(const char* name, Job job) : name_(name), job_(job) {}
+
+bool FetchTask::begin(uint32_t stackBytes, UBaseType_t priority) {
+  if (task_ != nullptr) {
+    return true;
+  }
+  return xTaskCreate(&FetchTask::taskEntry, name_, stackBytes, this, priority, &task_) == pdPASS;
+}
+
+bool FetchTask::request() {
+  if (task_ == nullptr || state_.load(std::memory_order_acquire) != kIdle) {
+    return false;
+  }
+  state_.store(kRunning, std::memory_order_relaxed);
+  xTaskNotifyGive(task_);
+  return true;
+}
+
+bool FetchTask::poll(bool& ok) {
+  if (state_.load(std::memory_order_acquire) != kDone) {
+    return false;
+  }
+  ok = ok_;
+  // The caller reads the result before the next request(); the task cannot
+  // touch it again until then.
+  state_.store(kIdle, std::memory_order_release);
+  return true;
+}
+
+bool FetchTask::busy() const {
+  return state_.load(std::memory_order_relaxed) != kIdle;
+}
+
+const char* FetchTask::error() const {
+  return err_;
+}
+
+void FetchTask::taskEntry(void* ctx) {
+  static_cast<FetchTask*>(ctx)->run();
+}
+
+void FetchTask::run() {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    if (state_.load(std::memory_order_acquire) != kRunning) {
+      continue;
+    }
+
+    err_[0] = '\0';
+    ok_ = job_(err_, sizeof(err_));
+    state_.store(kDone, std::memory_order_release);
+  }
+}
@@ -2,16 +2,25 @@
 
 #include "api_client.h"
 #include "config.h"
+#include "fetch_task.h"
 #include "ui.h"
 #include "wifi_manager.h"
 
 namespace {
 
 WifiManager gWifi;
-ApiClient gApi(Config::kHttpTimeoutMs, Config::kAllowInsecureTls, Config::kHttpBufferSize);
 UI gUi;
 UIModel gModel;
 
+// One client, response buffer and result per coin. Each result belongs to
+// its fetch task while that task is busy and to the loop otherwise.
+char gLtcResponse[Config::kHttpBufferSize];
+char gBtcResponse[Config::kHttpBufferSize];
+ApiClient gLtcApi(Config::kHttpTimeoutMs, Config::kAllowInsecureTls, gLtcResponse, sizeof(gLtcResponse));
+ApiClient gBtcApi(Config::kHttpTimeoutMs, Config::kAllowInsecureTls, gBtcResponse, sizeof(gBtcResponse));
+LTCData gLtcResult;
+BTCData gBtcResult;
+
 uint32_t gLastRefreshMs = 0;
 uint32_t gLastRenderMs = 0;
 bool gHasFetchedAtLeastOnce = false;
@@ -19,8 +28,6 @@ bool gHasPrevLtcBalance = false;
 float gPrevLtcBalance = 0.0f;
 
 char gStatusBuf[Config::kStatusBufferSize] = "Connecting...";
-char gErrBufA[Config::kStatusBufferSize];
-char gErrBufB[Config::kStatusBufferSize];
 char gLtcStatus[Config::kStatusBufferSize] = "Waiting LTC...";
 char gBtcStatus[Config::kStatusBufferSize] = "Waiting BTC...";
 
@@ -29,30 +36,40 @@ void setStatus(const char* text) {
   gModel.status = gStatusBuf;
 }
 
+bool fetchLtcJob(char* errMsg, size_t errMsgSize) {
+  return gLtcApi.fetchLTC(Config::kLtcAddress, gLtcResult, errMsg, errMsgSize);
+}
+
+bool fetchBtcJob(char* errMsg, size_t errMsgSize) {
+  return gBtcApi.fetchBTC(Config::kBtcAddress, gBtcResult, errMsg, errMsgSize);
+}
+
+FetchTask gLtcFetch("ltc-fetch", fetchLtcJob);
+FetchTask gBtcFetch("btc-fetch", fetchBtcJob);
+
 void refreshActiveStatus() {
   if (!gModel.wifiConnected) {
     setStatus("Connecting...");
     return;
   }
   if (gModel.screen == SCREEN_LTC) {
-    setStatus(gLtcStatus);
+    setStatus(gLtcFetch.busy() ? "Fetching..." : gLtcStatus);
   } else {
-    setStatus(gBtcStatus);
+    setStatus(gBtcFetch.busy() ? "Fetching..." : gBtcStatus);
   }
 }
 
-void fetchData() {
-  gModel.fetching = true;
-  setStatus("Fetching...");
-  gUi.render(gModel, true);
-
-  const bool hadLtc = gModel.ltcValid;
-  const bool hadBtc = gModel.btcValid;
-
-  bool ltcOk = gApi.fetchLTC(Config::kLtcAddress, gModel.ltc, gErrBufA, sizeof(gErrBufA));
-  bool btcOk = gApi.fetchBTC(Config::kBtcAddress, gModel.btc, gErrBufB, sizeof(gErrBufB));
+void startFetches() {
+  const bool ltcStarted = gLtcFetch.request();
+  const bool btcStarted = gBtcFetch.request();
+  if (ltcStarted || btcStarted) {
+    gModel.fetching = true;
+  }
+}
 
-  if (ltcOk) {
+void applyLtcResult(bool ok) {
+  if (ok) {
+    gModel.ltc = gLtcResult;
     if (gHasPrevLtcBalance) {
       const float delta = gModel.ltc.balance - gPrevLtcBalance;
       gModel.ltc.lastMined = (delta > 0.0f) ? delta : 0.0f;
@@ -63,26 +80,42 @@ void fetchData() {
     gHasPrevLtcBalance = true;
     gModel.ltcValid = true;
     snprintf(gLtcStatus, sizeof(gLtcStatus), "LTC Connected");
-  } else if (hadLtc) {
+  } else if (gModel.ltcValid) {
     snprintf(gLtcStatus, sizeof(gLtcStatus), "LTC cached");
   } else {
     snprintf(gLtcStatus, sizeof(gLtcStatus), "LTC retry...");
   }
+}
 
-  if (btcOk) {
+void applyBtcResult(bool ok) {
+  if (ok) {
+    gModel.btc = gBtcResult;
     gModel.btcValid = true;
     snprintf(gBtcStatus, sizeof(gBtcStatus), "BTC Connected");
-  } else if (hadBtc) {
+  } else if (gModel.btcValid) {
     snprintf(gBtcStatus, sizeof(gBtcStatus), "BTC cached");
   } else {
     snprintf(gBtcStatus, sizeof(gBtcStatus), "BTC retry...");
   }
-  gModel.fetching = false;
+}
 
-  refreshActiveStatus();
+// Picks up whatever the fetch tasks finished since the last pass. A refresh
+// cycle ends when both coins are back; the interval counts from there.
+void collectFetches() {
+  bool ok = false;
+  if (gLtcFetch.poll(ok)) {
+    applyLtcResult(ok);
+  }
+  if (gBtcFetch.poll(ok)) {
+    applyBtcResult(ok);
+  }
 
-  gHasFetchedAtLeastOnce = true;
-  gLastRefreshMs = millis();
+  const bool fetching = gLtcFetch.busy() || gBtcFetch.busy();
+  if (gModel.fetching && !fetching) {
+    gHasFetchedAtLeastOnce = true;
+    gLastRefreshMs = millis();
+  }
+  gModel.fetching = fetching;
 }
 
 void setupModelDefaults() {
@@ -105,6 +138,13 @@ void setup() {
   setupModelDefaults();
   gUi.begin();
 
+  if (!gLtcFetch.begin(Config::kFetchTaskStackBytes, Config::kFetchTaskPriority)) {
+    snprintf(gLtcStatus, sizeof(gLtcStatus), "LTC task failed");
+  }
+  if (!gBtcFetch.begin(Config::kFetchTaskStackBytes, Config::kFetchTaskPriority)) {
+    snprintf(gBtcStatus, sizeof(gBtcStatus), "BTC task failed");
+  }
+
   gWifi.begin(Config::kWifiCredentials, Config::kWifiCredentialCount, Config::kWifiReconnectIntervalMs);
   setStatus("Connecting...");
   gUi.render(gModel, true);
@@ -124,17 +164,17 @@ void loop() {
     gUi.prevScreen();
   }
   gModel.screen = gUi.screen();
-  refreshActiveStatus();
 
-  if (!gModel.wifiConnected) {
-    gModel.fetching = false;
-    setStatus("Connecting...");
-  } else {
+  // Fetches in flight when Wi-Fi drops still finish (and fail) on their own
+  // tasks; only new ones wait for the connection.
+  collectFetches();
+  if (gModel.wifiConnected && !gModel.fetching) {
     const bool refreshDue = (!gHasFetchedAtLeastOnce) || (now - gLastRefreshMs >= Config::kRefreshIntervalMs);
     if (refreshDue) {
-      fetchData();
+      startFetches();
     }
   }
+  refreshActiveStatus();
 
   if (now - gLastRenderMs >= Config::kUiRenderIntervalMs) {
     gUi.render(gModel, false);